@@ -98,6 +98,12 @@ SECTIONS
 		/* Put these first, they need to be 4-aligned */
 		*(.rodata.4)
 
+		/* Descriptors of compressed data sections (see <gint/lz.h>) */
+		. = ALIGN(4);
+		_blzdata = . ;
+		KEEP(*(.gint.lzdata))
+		_elzdata = . ;
+
 		*(.rodata .rodata.*)
 	} > ram AT> bin
 
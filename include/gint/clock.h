@@ -155,6 +155,207 @@ void cpg_get_overclock_setting(struct cpg_overclock_setting *s);
 /* Applies the specified overclock setting. */
 void cpg_set_overclock_setting(struct cpg_overclock_setting const *s);
 
+//---
+//	Clock governor
+//---
+
+/* The clock governor is an optional service that adjusts the clock speed to
+   the workload. It samples the CPU at regular intervals to measure the ratio
+   of time spent idle (in sleep() or in sections marked with
+   clock_governor_idle()), and moves between a list of speed levels with
+   hysteresis: quickly up when the CPU is busy, slowly down when it idles.
+
+   Because changing the clock speed waits for asynchronous tasks to complete,
+   decisions are taken in the sampling interrupt but only applied when the
+   program calls clock_governor_update(), typically once per iteration of its
+   main loop. Timers are rescaled during the change (see clock_set_speed()). */
+
+/* Maximum number of speed levels in a governor policy */
+#define CLOCK_GOVERNOR_LEVELS 5
+
+/* clock_governor_policy_t: Parameters of the governor's decisions */
+typedef struct
+{
+	/* Speed levels (CLOCK_SPEED_*) by increasing CPU frequency */
+	int8_t levels[CLOCK_GOVERNOR_LEVELS];
+	/* Number of levels in use */
+	uint8_t level_count;
+	/* Jump to the fastest level instead of the next one when busy */
+	bool jump_up;
+	/* Number of consecutive idle windows required to move down */
+	uint8_t down_delay;
+
+	/* Move up when the idle ratio (per mille) is at most up_threshold, and
+	   down when it is at least down_threshold (which should be higher) */
+	uint16_t up_threshold;
+	uint16_t down_threshold;
+
+	/* Sampling period (µs) and number of samples in a decision window */
+	uint32_t sample_us;
+	uint16_t window;
+
+} clock_governor_policy_t;
+
+/* clock_governor_state_t: Decision state, evolved by clock_governor_decide()
+   and initialized to zero except for (level), the index of the level in the
+   policy's list. */
+typedef struct
+{
+	/* Index of the current level in the policy */
+	int8_t level;
+	/* Number of consecutive windows above the down threshold */
+	uint8_t down_streak;
+
+} clock_governor_state_t;
+
+/* clock_governor_stats_t: Statistics on the governor's decisions */
+typedef struct
+{
+	/* Number of decision windows elapsed */
+	uint32_t windows;
+	/* Number of level changes decided, and applied */
+	uint32_t decisions;
+	uint32_t switches;
+	/* Idle ratio of the last window, per mille */
+	uint16_t last_idle;
+	/* Current speed level (CLOCK_SPEED_*) */
+	int8_t speed;
+	/* Number of windows spent at each speed (index CLOCK_SPEED_F1-1 to
+	   CLOCK_SPEED_F5-1) */
+	uint32_t windows_at[5];
+
+} clock_governor_stats_t;
+
+/* clock_governor_default_policy(): Get the default policy for this model
+   The default levels are the following, from slowest to fastest CPU:
+
+     SH3 fx-9860G-like:     F1 (29 MHz), F2 (58 MHz), F4 (118 MHz)
+     SH4 fx-9860G-like:     F1 (29 MHz), F2 (58 MHz), F4 (118 MHz),
+                            F5 (236 MHz)
+     G-III / Graph 35+E II: F3 (29 MHz), F1 (58 MHz), F4 (118 MHz),
+                            F5 (235 MHz)
+     fx-CG 10/20:           F1 (58 MHz), F3 (118 MHz), F5 (191 MHz)
+     fx-CG 50:              F2 (58 MHz), F1 (116 MHz), F4 (232 MHz)
+
+   On other models, the only level is CLOCK_SPEED_DEFAULT. Returns the policy
+   in *policy. */
+void clock_governor_default_policy(clock_governor_policy_t *policy);
+
+/* clock_governor_decide(): Decide the next level after a window
+
+   This is the governor's decision logic; it does not access the hardware and
+   can be used on its own (including on a computer to test policies). Given
+   the idle ratio of the latest window, returns the index of the next level in
+   the policy's list and updates the state.
+
+   @policy  Governor policy
+   @state   Decision state
+   @idle    Idle ratio of the window, per mille (0..1000) */
+int clock_governor_decide(clock_governor_policy_t const *policy,
+	clock_governor_state_t *state, int idle);
+
+/* clock_governor_start(): Start the governor with a given policy
+
+   Reserves a timer to sample the CPU state. If policy is NULL, the default
+   policy is used. The policy is copied. Returns 0 on success, or a negative
+   value if no timer is available or the policy is invalid. */
+int clock_governor_start(clock_governor_policy_t const *policy);
+
+/* clock_governor_stop(): Stop the governor
+   The clock speed is left at its current level. */
+void clock_governor_stop(void);
+
+/* clock_governor_update(): Apply the governor's latest decision
+   Changes the clock speed if the governor decided to since the last call.
+   This should not be called from an interrupt. Returns true if the clock
+   speed was changed. */
+bool clock_governor_update(void);
+
+/* clock_governor_idle(): Mark the current section as idle or busy
+
+   Programs that wait by polling instead of calling sleep() can use this to
+   report their waiting sections to the governor. Sections are not nested. */
+void clock_governor_idle(bool idle);
+
+/* clock_governor_stats(): Get a copy of the governor's statistics */
+void clock_governor_stats(clock_governor_stats_t *stats);
+
+//---
+//	Clock speed benchmarks
+//---
+
+/* The benchmark functions measure what each speed level delivers for typical
+   workloads, so that programs can pick levels based on actual numbers. Each
+   benchmark is calibrated: it repeats its operation until it has run for at
+   least a quarter of a second (measured with the RTC, which is independent of
+   the clock settings) and reports a throughput. */
+
+enum {
+	/* Integer ALU loop, in thousands of iterations per second */
+	CLOCK_BENCH_ALU = 0,
+	/* memcpy() on 8 kB in RAM, in kB/s */
+	CLOCK_BENCH_MEMCPY,
+	/* dma_memcpy() on 8 kB in RAM, in kB/s (0 on SH3) */
+	CLOCK_BENCH_DMA_MEMCPY,
+	/* dclear() of the full VRAM, in fills per second */
+	CLOCK_BENCH_VRAM_FILL,
+	/* Full-screen dupdate(), in frames per second */
+	CLOCK_BENCH_DUPDATE,
+	/* fread() from a file in the filesystem, in kB/s (0 if no file) */
+	CLOCK_BENCH_FILE_READ,
+	/* dimage() of a 128x64 RGB565 image in RAM, in kpixels/s (fx-CG) */
+	CLOCK_BENCH_IMAGE_RGB16,
+	/* dimage() of a 128x64 P8 image in RAM, in kpixels/s (fx-CG) */
+	CLOCK_BENCH_IMAGE_P8,
+
+	CLOCK_BENCH_COUNT,
+};
+
+/* clock_bench_t: Results of the benchmarks at a given speed level */
+typedef struct
+{
+	/* Speed level (CLOCK_SPEED_*) */
+	int speed;
+	/* Iϕ and Bϕ frequencies during the run, in Hz */
+	int Iphi_f;
+	int Bphi_f;
+	/* Result of each benchmark, with the units described above */
+	uint32_t results[CLOCK_BENCH_COUNT];
+
+} clock_bench_t;
+
+/* clock_bench_run(): Run all benchmarks at the current speed level
+
+   The benchmarks draw to the VRAM and send it to the display. The file read
+   benchmark opens the specified file (eg. "/file.bin" or a file in the
+   storage memory); if file is NULL it is skipped.
+
+   @file  Path of the file to read, or NULL
+   @res   Result structure (filled in by the function) */
+void clock_bench_run(char const *file, clock_bench_t *res);
+
+/* clock_bench_all(): Run all benchmarks at every speed level
+
+   Switches to each of the levels CLOCK_SPEED_F1 to CLOCK_SPEED_F5 in turn,
+   runs the benchmarks, then restores the original clock settings. Returns the
+   number of levels that were benchmarked (0 if the model's levels are not
+   known).
+
+   @file  Path of the file to read, or NULL
+   @res   Array of 5 result structures */
+int clock_bench_all(char const *file, clock_bench_t res[5]);
+
+/* clock_bench_table(): Format benchmark results as a text table
+   Writes a NUL-terminated table with one row per result, one column per
+   benchmark, and speedups relative to the first row. Returns the length of
+   the full table (which is truncated if larger than size - 1). */
+int clock_bench_table(clock_bench_t const *res, int count, char *buf,
+	size_t size);
+
+/* clock_bench_send(): Send benchmark results to fxlink as text
+   This requires the USB link to be open with the fxlink interface. */
+void clock_bench_send(clock_bench_t const *res, int count);
+
 //---
 //	Sleep functions
 //---
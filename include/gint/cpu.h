@@ -141,6 +141,192 @@ void cpu_csleep(cpu_csleep_t *ics);
 /* cpu_csleep_cancel(): Cancel the sleep function from within an interrupt */
 void cpu_csleep_cancel(cpu_csleep_t *ics);
 
+//---
+// Idle states
+//
+// Every sleep() goes through the idle subsystem, which picks the deepest
+// state allowed by the policy, the hardware activity and the time until the
+// next timer interrupt:
+//
+// * CPU_IDLE_SLEEP is the [sleep] instruction in sleep mode. The CPU clock is
+//   stopped but all peripheral modules keep running. This is always allowed.
+// * CPU_IDLE_STANDBY is software standby (SH4 only). The CPG stops all clocks
+//   except TCLK, so the TMU, DMA and USB modules are halted; only the ETMU and
+//   the RTC can wake the CPU up. It is only entered if enabled by the policy,
+//   no TMU interrupt is pending, no DMA channel is running, the USB module is
+//   stopped, and the next ETMU interrupt is at least standby_min_us away.
+//
+// When accounting is enabled with cpu_idle_accounting(), an ETMU is reserved
+// as a 32768 Hz reference clock and the subsystem records how long the CPU
+// stays in each state, as well as the wake latency: how far past the next
+// timer deadline the CPU resumed execution, when it was woken by that timer.
+// Applications can compare the residency with the elapsed time to check that
+// they really idle instead of polling.
+//---
+
+typedef enum {
+	CPU_IDLE_SLEEP   = 0,
+	CPU_IDLE_STANDBY = 1,
+	CPU_IDLE_STATES,
+} cpu_idle_state_t;
+
+typedef struct {
+	/* Allow software standby */
+	bool standby;
+	/* Minimum time until the next timer interrupt to enter standby (µs) */
+	uint32_t standby_min_us;
+
+} cpu_idle_policy_t;
+
+typedef struct {
+	/* Number of times the state was entered */
+	uint32_t entries;
+	/* Total time spent in the state (µs) */
+	uint64_t residency_us;
+	/* Number of wake-ups that came after the timer deadline, and total and
+	   maximum delay past the deadline (µs) */
+	uint32_t late_wakes;
+	uint64_t total_latency_us;
+	uint32_t max_latency_us;
+
+} cpu_idle_state_stats_t;
+
+typedef struct {
+	/* Statistics for each state, indexed by cpu_idle_state_t */
+	cpu_idle_state_stats_t states[CPU_IDLE_STATES];
+	/* Calls to sleep() that returned without sleeping, because sleep was
+	   blocked or because deferred work was run */
+	uint32_t skipped;
+	/* Time elapsed since accounting was started or reset (µs) */
+	uint64_t elapsed_us;
+
+} cpu_idle_stats_t;
+
+/* cpu_idle_policy(): Set the idle policy
+   If NULL is passed, the default policy is restored: standby is disabled and
+   the threshold is set to 20 ms. */
+void cpu_idle_policy(cpu_idle_policy_t const *policy);
+
+/* cpu_idle_accounting(): Enable or disable time accounting
+   Enabling requires a free ETMU; returns false if there is none. Statistics
+   are reset when accounting is enabled. Entries and skipped sleeps are
+   counted even when accounting is disabled. */
+bool cpu_idle_accounting(bool enable);
+
+/* cpu_idle_stats(): Get the current statistics */
+void cpu_idle_stats(cpu_idle_stats_t *stats);
+
+/* cpu_idle_reset(): Reset the statistics */
+void cpu_idle_reset(void);
+
+//---
+// Contexts and lazy DSP switching
+//
+// A suspended execution context is described by a cpu_context_t, which has
+// the register order used by GDB (and thus by the GDB stub, which can inspect
+// and modify a context in place) and by the UBC break handler frame.
+//
+// The DSP registers of the SH4AL-DSP are not part of this frame, because
+// saving them on every switch would be expensive while few contexts ever use
+// the DSP. Instead, each context that may use the DSP has a cpu_dsp_state_t,
+// and the switching code calls cpu_dsp_switch() with the state of the context
+// that is about to run. If that context doesn't own the DSP registers, the
+// DSP is disabled in SR; its first DSP instruction then raises an illegal
+// instruction exception, in which the kernel saves the registers of the
+// previous owner, loads those of the current context, and re-enables the DSP
+// before re-executing the instruction. Contexts that never use the DSP never
+// pay for it.
+//
+// The SR of a suspended context is restored by the switching code, so it
+// should have its DSP bit cleared unless the context owns the DSP. The lazy
+// mechanism is inactive until the first call to cpu_dsp_switch(), in which
+// case the DSP stays enabled for everyone as in previous versions of gint.
+//---
+
+/* cpu_context_t: General-purpose registers of a suspended context
+   The order follows GDB's register numbering for SuperH. */
+typedef struct {
+	union {
+		struct {
+			uint32_t r0;
+			uint32_t r1;
+			uint32_t r2;
+			uint32_t r3;
+			uint32_t r4;
+			uint32_t r5;
+			uint32_t r6;
+			uint32_t r7;
+			uint32_t r8;
+			uint32_t r9;
+			uint32_t r10;
+			uint32_t r11;
+			uint32_t r12;
+			uint32_t r13;
+			uint32_t r14;
+			uint32_t r15;
+			uint32_t pc;
+			uint32_t pr;
+			uint32_t gbr;
+			uint32_t vbr;
+			uint32_t mach;
+			uint32_t macl;
+			uint32_t sr;
+		} reg;
+		uint32_t regs[23];
+	};
+} cpu_context_t;
+
+/* cpu_dsp_state_t: DSP registers of a context
+   The first 11 registers follow GDB's numbering for SH-DSP, starting at
+   register 24 (dsr); the repeat registers are at the end. The layout is used
+   by assembler code in src/cpu/dsp.s. */
+typedef struct {
+	uint32_t dsr;
+	uint32_t a0g;
+	uint32_t a0;
+	uint32_t a1g;
+	uint32_t a1;
+	uint32_t m0;
+	uint32_t m1;
+	uint32_t x0;
+	uint32_t x1;
+	uint32_t y0;
+	uint32_t y1;
+	uint32_t mod;
+	uint32_t rs;
+	uint32_t re;
+
+} cpu_dsp_state_t;
+
+/* cpu_dsp_switch(): Select the context that will run next
+   Declares that the context with the provided DSP state is about to run, and
+   enables or disables the DSP in SR depending on whether that context owns the
+   DSP registers. Passing NULL stops lazy switching and leaves the DSP enabled.
+   This function does nothing on SH3. */
+void cpu_dsp_switch(cpu_dsp_state_t *state);
+
+/* cpu_dsp_owner(): Context whose values are in the DSP registers
+   Returns NULL if lazy switching is inactive or if the registers have been
+   saved and not reloaded since (eg. after a world switch). */
+cpu_dsp_state_t *cpu_dsp_owner(void);
+
+/* cpu_dsp_read(): Get the DSP registers of the running context
+   This reads either the hardware registers or the saved state, depending on
+   ownership. Used by the GDB stub. */
+void cpu_dsp_read(cpu_dsp_state_t *state);
+
+/* cpu_dsp_write(): Set the DSP registers of the running context */
+void cpu_dsp_write(cpu_dsp_state_t const *state);
+
+/* cpu_dsp_flush(): Save the DSP registers to their owner
+   After this call no context owns the DSP registers, and the next DSP
+   instruction traps and reloads the current context. This is done when
+   leaving gint's world, since the OS may use the DSP. */
+void cpu_dsp_flush(void);
+
+/* cpu_dsp_stats(): Number of DSP traps and actual register switches */
+void cpu_dsp_stats(uint32_t *traps, uint32_t *switches);
+
 //---
 // Configuration
 //---
@@ -0,0 +1,128 @@
+//---
+//	gint:defer - Deferred interrupt work
+//---
+
+#ifndef GINT_DEFER
+#define GINT_DEFER
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <gint/defs/types.h>
+#include <gint/defs/attributes.h>
+#include <gint/defs/call.h>
+#include <gint/ring.h>
+
+/* Deferred work queue
+
+   Completion callbacks for DMA transfers and USB pipe operations used to run
+   directly in interrupt context, where they delay every interrupt of equal or
+   lower priority for as long as they execute. Interrupt handlers now only post
+   the callback into a fixed-size ring and return; the queue is drained from
+   the main program, by sleep() and pollevent(), or explicitly with
+   gint_defer_run().
+
+   Only callbacks supplied by the application are deferred. The drivers' own
+   continuations (starting the next round of a USB write, setting the flag of
+   a synchronous call) still run in the interrupt handler, so synchronous
+   transfers make progress even when called from an interrupt handler or when
+   the program is not draining the queue.
+
+   The usual [while(!flag) sleep();] loops keep working unchanged, because
+   sleep() runs the pending callbacks and returns without sleeping if there was
+   any. However, a busy loop that never calls sleep(), pollevent() or
+   gint_defer_run() will never see deferred callbacks run.
+
+   The queue is a multi-producer ring from <gint/ring.h>, which does not
+   depend on the hardware, so the same code can be compiled and exercised on
+   a PC. On the calculator, reserving a slot is the only step that masks
+   interrupts (for a handful of instructions); filling the slot, publishing it
+   and running it are done with interrupts enabled. */
+
+/* Number of slots in the queue; must be a power of 2 */
+#define GINT_DEFER_SIZE 32
+
+typedef struct {
+	/* Queued calls, and whether each slot has been published */
+	gint_call_t calls[GINT_DEFER_SIZE];
+	uint8_t volatile ready[GINT_DEFER_SIZE];
+	/* Next slot to run (consumer) and next slot to reserve (producers) */
+	gint_ring_t ring;
+
+	/* Statistics: calls posted, calls executed immediately because the
+	   queue was full, and maximum number of pending calls */
+	uint32_t posted;
+	uint32_t overflows;
+	uint16_t max_depth;
+
+} gint_defer_queue_t;
+
+//---
+// Queue primitives
+//---
+
+/* gint_defer_queue_reserve(): Reserve the next slot
+   Returns the slot index, or -1 if the queue is full. Concurrent producers
+   must be serialized by the caller for the duration of this call. */
+static GINLINE int gint_defer_queue_reserve(gint_defer_queue_t *q)
+{
+	int slot = gint_ring_mp_reserve(&q->ring, GINT_DEFER_SIZE);
+	if(slot < 0) return -1;
+
+	int depth = gint_ring_count(&q->ring);
+	if(depth > q->max_depth)
+		q->max_depth = depth;
+	return slot;
+}
+
+/* gint_defer_queue_publish(): Fill a reserved slot and make it visible */
+static GINLINE void gint_defer_queue_publish(gint_defer_queue_t *q, int slot,
+	gint_call_t call)
+{
+	q->calls[slot] = call;
+	gint_ring_mp_publish(q->ready, slot);
+	q->posted++;
+}
+
+/* gint_defer_queue_pop(): Take the oldest published call
+   Returns false if the queue is empty, or if the oldest slot is reserved but
+   not yet published (which only happens when called from an interrupt). */
+static GINLINE bool gint_defer_queue_pop(gint_defer_queue_t *q,
+	gint_call_t *call)
+{
+	int slot = gint_ring_mp_pop_slot(&q->ring, q->ready, GINT_DEFER_SIZE);
+	if(slot < 0) return false;
+
+	*call = q->calls[slot];
+	gint_ring_mp_pop_commit(&q->ring, q->ready, GINT_DEFER_SIZE);
+	return true;
+}
+
+//---
+// Kernel queue
+//---
+
+/* gint_defer(): Post a call to be executed outside of interrupt context
+
+   This function can be called from interrupt handlers at any level, as well
+   as from the main program. GINT_CALL_NULL is ignored. If the queue is full,
+   the call is executed immediately so that no completion is ever lost. */
+void gint_defer(gint_call_t call);
+
+/* gint_defer_run(): Execute all pending calls
+   Calls posted while this function runs are executed too. Returns the number
+   of calls executed. This is called automatically by sleep(). */
+int gint_defer_run(void);
+
+/* gint_defer_pending(): Number of calls waiting in the queue */
+int gint_defer_pending(void);
+
+/* gint_defer_queue(): Kernel queue, for inspecting statistics */
+gint_defer_queue_t const *gint_defer_queue(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GINT_DEFER */
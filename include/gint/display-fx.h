@@ -25,9 +25,23 @@ extern "C" {
    size 1024. Any function can use it freely to:
    - Use another video ram area (triple buffering or more, gray engine);
    - Implement additional drawing functions;
-   - Store data when not drawing. */
+   - Store data when not drawing.
+   Functions that write to the VRAM directly should call dupdate_invalidate()
+   on the rows that they modify, otherwise dupdate() might not send them. */
 extern uint32_t *gint_vram;
 
+/* dupdate_invalidate(): Force rows to be sent at the next dupdate()
+
+   To save time on the slow LCD bus, dupdate() only sends the rows that were
+   drawn to by gint's rendering functions since the previous frame. Code that
+   modifies the VRAM directly (through gint_vram or the pointers returned by
+   dgray_getvram()) must call this function to report the rows that it
+   modified. Changing the value of gint_vram or switching to the OS sends the
+   whole VRAM at the next dupdate().
+
+   @y1 @y2  Range of modified rows (both included) */
+void dupdate_invalidate(int y1, int y2);
+
 /* color_t - colors available for drawing
    The following colors are defined by the library:
 
@@ -40,9 +40,11 @@ extern "C" {
    On fx-9860G, this function also manages the gray engine settings. When the
    gray engine is stopped, it pushes the contents of the VRAM to screen, and
    when it is on, it swaps buffer and lets the engine's timer push the VRAMs to
-   screen when suitable. To make the transition between the two modes smooth,
-   dgray() does not enable the gray engine immediately; instead the first call
-   to update() after dgray() switches the gray engine on and off.
+   screen when suitable. In both cases, only the rows that were modified since
+   the previous frame are sent (see dupdate_invalidate()). To make the
+   transition between the two modes smooth, dgray() does not enable the gray
+   engine immediately; instead the first call to update() after dgray()
+   switches the gray engine on and off.
 
    On fx-CG 50, because rendering is slow and sending data to screen is also
    slow, a special mechanism known as triple buffering is implemented. Two
@@ -50,6 +50,10 @@ typedef enum
    call dma_transfer_wait() to wait until the transfer completes. You can
    create a callback with GINT_CALL() or pass GINT_CALL_NULL.
 
+   The callback does not run in the interrupt handler: it is posted with
+   gint_defer() and executed by the main program the next time it calls
+   sleep(), pollevent() or gint_defer_run() (see <gint/defer.h>).
+
    @channel   DMA channel (0..5)
    @size      Transfer size
    @blocks    Number of blocks (transferred memory = size * blocks)
@@ -63,6 +67,16 @@ bool dma_transfer_async(int channel, dma_size_t size, uint blocks,
 	void const *src, dma_address_t src_mode, void *dst,
 	dma_address_t dst_mode, gint_call_t callback);
 
+/* dma_transfer_async_direct(): Asynchronous transfer with an immediate callback
+
+   Same as dma_transfer_async(), except that the callback is invoked directly
+   by the interrupt handler. This is meant for drivers that chain transfers or
+   set completion flags, which cannot wait for the main program; the callback
+   must be short and must not block. */
+bool dma_transfer_async_direct(int channel, dma_size_t size, uint blocks,
+	void const *src, dma_address_t src_mode, void *dst,
+	dma_address_t dst_mode, gint_call_t callback);
+
 /* dma_transfer_wait(): Wait for an asynchronous transfer to finish
    @channel   DMA channel (0..5) */
 void dma_transfer_wait(int channel);
@@ -165,7 +165,12 @@ extern "C" {
    * GINT_DRV_SHARED: Makes the driver shared, meaning that its hardware state
      is not saved and restored during world switches. Note that the CPU and
      INTC drivers are not shared so interrupts will not be available in a
-     foreign world. */
+     foreign world.
+   * GINT_DRV_LAZY: Makes the driver inactive at startup. It is skipped by
+     world switches (it is not even configured) until gint_driver_activate()
+     is called, which usually happens the first time the driver's API is used.
+     This is meant for drivers with an expensive initialization or power
+     sequence that many add-ins don't need. */
 typedef struct {
 	/* Driver name */
 	char const *name;
@@ -225,9 +230,11 @@ enum {
 
 	/* Driver does not require hardware state saves during world switches */
 	GINT_DRV_SHARED = 0x10,
+	/* Driver is inactive until gint_driver_activate() is called */
+	GINT_DRV_LAZY = 0x20,
 
 	/* Flags that can be set in the (flags) attribute of the driver struct */
-	GINT_DRV_INIT_ = 0x10,
+	GINT_DRV_INIT_ = 0x30,
 };
 
 /* gint_world_t: World state capture
@@ -269,6 +276,24 @@ typedef void **gint_world_t;
 #define GINT_DECLARE_DRIVER(level, name) \
 	GSECTION(".gint.drivers." #level) GVISIBLE extern gint_driver_t name;
 
+/* gint_driver_activate(): Activate a lazy driver
+
+   If the driver was declared with GINT_DRV_LAZY and is not active yet, this
+   function performs the part of the world switch that was skipped for it:
+   foreign unbind, power on, save of the OS state, bind and configure. From
+   then on the driver takes part in world switches normally. Does nothing if
+   the driver is already active. Drivers of lower levels are not activated
+   automatically, so lazy drivers should only depend on non-lazy drivers or
+   activate their dependencies themselves.
+
+   This function must be called from the gint world, with interrupts enabled.
+   It is safe to call it at the start of every API function of the driver. */
+void gint_driver_activate(gint_driver_t *driver);
+
+/* gint_driver_is_active(): Whether a driver is active
+   Returns false for lazy drivers that have not been activated yet. */
+bool gint_driver_is_active(gint_driver_t const *driver);
+
 //---
 // Internal driver control
 //
@@ -285,6 +310,26 @@ extern gint_driver_t gint_drivers_end[];
 /* Current flags for all drivers */
 extern uint8_t *gint_driver_flags;
 
+/* Time spent initializing each driver during the first switch to the gint
+   world, in µs. This includes hpoweron(), hsave(), bind() and configure().
+   The measurement uses the TMU, so drivers of lower levels than the TMU are
+   not timed, and neither are lazy drivers; their entry is -1. */
+extern int32_t *gint_driver_boot_time;
+
+/* gint_driver_boot_time_ms(): Boot time of driver (i) in milliseconds
+   Returns the whole milliseconds and sets *frac to the remaining µs (if not
+   NULL), or returns -1 if the driver was not timed. */
+int gint_driver_boot_time_ms(int i, int *frac);
+
+/* gint_driver_boot_table(): Format the boot time of all drivers
+   Writes a text table with one line per driver to [buf], in the style of
+   snprintf(). Returns the length of the full table. */
+int gint_driver_boot_table(char *buf, size_t size);
+
+/* gint_driver_boot_send(): Send the boot time table over fxlink
+   Does nothing if the USB link is not open. */
+void gint_driver_boot_send(void);
+
 /* Number of drivers in the (gint_drivers) array */
 #define gint_driver_count() \
 	((gint_driver_t *)&gint_drivers_end - (gint_driver_t *)&gint_drivers)
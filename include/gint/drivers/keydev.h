@@ -10,9 +10,10 @@ extern "C" {
 #endif
 
 #include <gint/keyboard.h>
+#include <gint/ring.h>
 #include <stdbool.h>
 
-/* Size of the buffer event queue */
+/* Size of the buffer event queue; must be a power of 2 */
 #define KEYBOARD_QUEUE_SIZE 32
 
 /* Event transforms
@@ -154,9 +155,8 @@ typedef struct {
 	/* Last time when repeats were considered */
 	uint time_repeats;
 
-	/* Next event in queue, position after last event in queue */
-	int8_t queue_next;
-	int8_t queue_end;
+	/* Indices of the event queue (see <gint/ring.h>) */
+	gint_ring_t queue_ring;
 	/* Number of events lost because of missing queue space */
 	uint16_t events_lost;
 
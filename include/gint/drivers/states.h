@@ -58,6 +58,7 @@ typedef struct {
 /* Real-time Clock (see rtc/rtc.c) */
 typedef struct {
 	uint8_t RCR1, RCR2;
+	uint8_t RSECAR, RMINAR, RHRAR, RWKAR, RDAYAR, RMONAR;
 } rtc_state_t;
 
 /* Sound Processing Unit (see spu/spu.c) */
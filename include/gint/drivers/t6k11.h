@@ -25,6 +25,27 @@ extern "C" {
    @stride  Number of bytes between each row */
 void t6k11_display(const void *vram, int y1, int y2, size_t stride);
 
+/* t6k11_display_rows() - send selected rows of vram data to the LCD device
+
+   Sends only the rows y for which rows[y] is non-zero. Each row is addressed
+   separately on the LCD bus, so this costs the same as t6k11_display() for
+   the selected rows and nothing for the others.
+
+   @vram    Video RAM address (of row 0)
+   @rows    Array of 64 bytes, non-zero for the rows to send
+   @stride  Number of bytes between each row */
+void t6k11_display_rows(const void *vram, uint8_t const *rows, size_t stride);
+
+/* t6k11_contents_lost() - check whether the LCD contents were overwritten
+
+   Returns true if the OS might have drawn to the screen since the last call,
+   which happens after every world switch (and before the first frame). Code
+   that only sends modified rows must then send a full frame. The indicator is
+   cleared by the call.
+
+   Returns true if the screen contents are unknown. */
+bool t6k11_contents_lost(void);
+
 /* t6k11_contrast() - change the contrast setting
 
    Adjusts the screen contrast. The parameter takes value in range 0 .. 32 and
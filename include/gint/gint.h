@@ -108,10 +108,12 @@ void gint_poweroff(bool show_logo);
      and leave the rest corrupted. This is useful if on-chip memory is used
      only for temporaries (e.g. frames in Azur), for which we don't care if
      they're corrupted, or code (e.g gint interrupt handling code), which will
-     be reloaded and is otherwise a constant.
+     be reloaded and is otherwise a constant. The on-chip kmalloc arenas
+     ("_ilram", "_xyram" and "_pram0") are reset, freeing all of their blocks.
 
    * [Backup mode]
      Save on-chip memory to a user-provided buffer of size GINT_ONCHIP_BUFSIZE.
+     The SPU's PRAM0 is not saved; its "_pram0" arena is reset.
 
    * [Nothing mode]
      Don't do anything, and let the world switch function choose its preferred
@@ -774,16 +774,27 @@ void gint_image_rgb16_swapcolor(void);
 void gint_image_rgb16_dye(void);
 
 void gint_image_p8_normal(void);
+void gint_image_p8_normal_pairs(void);
 void gint_image_p8_clearbg(void);
 void gint_image_p8_swapcolor(void);
 void gint_image_p8_dye(void);
 
 void gint_image_p4_normal(void);
+void gint_image_p4_normal_pairs(void);
 void gint_image_p4_clearbg(void);
 void gint_image_p4_clearbg_alt(void);
 void gint_image_p4_swapcolor(void);
 void gint_image_p4_dye(void);
 
+/* gint_image_p4_pairs(): Get the pair table for a P4 palette
+
+   gint_image_p4_normal_pairs expects [cmd.palette] to point to a table where
+   each of the 256 possible input bytes is mapped to its two pixels, packed in
+   a longword. This function returns such a table for the provided palette.
+   The table is cached, so that it is only rebuilt when the palette changes;
+   it remains valid until the next call with a different palette. */
+uint32_t const *gint_image_p4_pairs(uint16_t const *palette);
+
 //---
 // Image library utilities
 //
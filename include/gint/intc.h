@@ -142,6 +142,79 @@ void *intc_handler(int event_code, void const *handler, size_t size);
    Returns true on success, false if the event code is invalid. */
 bool intc_handler_function(int event_code, gint_call_t function);
 
+//---
+//	Interrupt instrumentation
+//---
+
+/* When several interrupt sources are active (display, USB, DMA, timers for
+   the gray engine or the keyboard...), one handler running for too long can
+   delay the others. The instrumentation mode measures every handler to find
+   out which one is delaying which.
+
+   In this mode, the interrupt entry gate is replaced with an instrumented one
+   which timestamps the entry and exit of each handler using TMU2 as a free-
+   running counter (so TMU2 is reserved while instrumentation is enabled).
+   Handlers that interrupt another handler (which happens when a handler calls
+   back into C code with gint_inth_callback(), which re-enables interrupts of
+   higher priority) are detected as nested, and their duration is accounted
+   as delay in the handler that they preempted.
+
+   The request-to-entry latency of interrupts cannot be measured in software.
+   What can be measured is the latency that nested handlers add to the one
+   they preempt, and how long each handler blocks sources of lower or equal
+   priority (its duration). Together these show which handler delays which.
+
+   Instrumentation is only available on SH4. All times are in microseconds,
+   derived from the timer's frequency at the time of the query. */
+
+/* intc_trace_stat_t: Statistics for a single interrupt source */
+typedef struct {
+	/* Event code of the source */
+	uint16_t event;
+	/* Event code of the last handler that preempted this one, or 0 */
+	uint16_t last_preemptor;
+	/* Number of times the handler ran */
+	uint32_t count;
+	/* Total and longest duration, including nested handlers */
+	uint32_t total_time;
+	uint32_t max_time;
+	/* Total duration excluding nested handlers */
+	uint32_t self_time;
+	/* Total and longest delay added by nested handlers */
+	uint32_t delay_time;
+	uint32_t max_delay;
+	/* Number of times the handler ran while another one was running */
+	uint32_t nested;
+	/* Number of times the handler was preempted by another one */
+	uint32_t preempted;
+
+} intc_trace_stat_t;
+
+/* intc_trace_start(): Enable interrupt instrumentation
+   Resets the statistics and installs the instrumented entry gate. Returns
+   false if not supported (SH3) or if TMU2 is currently in use. */
+bool intc_trace_start(void);
+
+/* intc_trace_stop(): Disable interrupt instrumentation
+   Restores the standard entry gate and frees TMU2. Statistics are kept. */
+void intc_trace_stop(void);
+
+/* intc_trace_reset(): Clear all statistics */
+void intc_trace_reset(void);
+
+/* intc_trace_get(): Get the statistics for an interrupt source
+   Returns false if the event code is invalid or the source never ran. */
+bool intc_trace_get(int event_code, intc_trace_stat_t *stat);
+
+/* intc_trace_table(): Format statistics for all sources that ran
+   Writes a text table with one line per interrupt source to [buf], in the
+   style of snprintf(). Returns the length of the full table. */
+int intc_trace_table(char *buf, size_t size);
+
+/* intc_trace_send(): Send the statistics table over fxlink
+   Does nothing if the USB link is not open. */
+void intc_trace_send(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -81,6 +81,8 @@ typedef struct {
 	/* Whether to consider this arena when performing default allocations
 	   (kmalloc() with arena_name == NULL) */
 	int is_default;
+	/* Properties of the memory, a combination of KMALLOC_* flags */
+	int flags;
 
 	/* Statistics maintained by kmalloc() */
 	struct kmalloc_stats {
@@ -93,6 +95,43 @@ typedef struct {
 
 } kmalloc_arena_t;
 
+/* Memory properties for the (flags) attribute of arenas */
+enum {
+	/* Memory only supports 32-bit accesses (like SPU memory). Data must be
+	   read and written in longwords, so memcpy() and memset() can't be
+	   used; dma_memcpy() and dma_memset() handle it correctly. */
+	KMALLOC_WORD_ACCESS = 0x01,
+	/* On-chip memory with single-cycle access, suitable for hot buffers
+	   such as rendering strips, FIFOs or glyph caches */
+	KMALLOC_FAST = 0x02,
+	/* The arena is in on-chip memory, whose contents follow the policy of
+	   gint_set_onchip_save_mode() during world switches */
+	KMALLOC_ONCHIP = 0x04,
+};
+
+/* On-chip arenas
+
+   On SH4, gint creates arenas over the parts of on-chip memory that are not
+   used by the linked .ilram and .xyram sections. They are not default arenas
+   and must be requested by name:
+
+   * "_ilram": ILRAM (4 kB total), KMALLOC_FAST | KMALLOC_ONCHIP
+   * "_xyram": XRAM and YRAM (16 kB total), KMALLOC_FAST | KMALLOC_ONCHIP
+   * "_pram0": PRAM0 of the SPU (160 kB), KMALLOC_WORD_ACCESS |
+     KMALLOC_ONCHIP; it is created when the SPU driver is activated (see
+     spu_zero())
+
+   On-chip memory is not preserved by world switches in the default
+   reinitialization mode of gint_set_onchip_save_mode(). In that mode, the
+   on-chip arenas are reset after each world switch, which frees all of their
+   blocks; they should then only be used for temporary buffers that are
+   reallocated after a switch (getkey() may switch to the main menu!). In
+   backup mode, the "_ilram" and "_xyram" arenas and their contents are
+   preserved, but "_pram0" is still reset as it doesn't fit in the buffer.
+
+   These arenas are created with statistics enabled, see
+   kmalloc_get_gint_stats(). */
+
 /* kmalloc_init_arena(): Initialize an arena with gint's allocator
 
    This function initializes an arena on the region located between (a->start)
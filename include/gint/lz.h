@@ -0,0 +1,79 @@
+//---
+//	gint:lz - Compressed data sections
+//---
+
+#ifndef GINT_LZ
+#define GINT_LZ
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <gint/defs/types.h>
+#include <gint/defs/attributes.h>
+
+/* Compressed data sections
+
+   Large initialized tables and assets make up a good part of many add-ins,
+   and since they are stored uncompressed they make the file larger and slow
+   down the initial read from the storage memory. As an option, such data can
+   be compressed in the LZ4 block format at build time, stored in ROM, and
+   decoded into a RAM buffer during startup, right after the BSS section is
+   cleared and before constructors run.
+
+   The host tool tools/gint-lzpack compresses a file and generates a C source
+   that defines the RAM buffer (in the BSS section, so it doesn't take space in
+   the add-in file), the compressed stream, and a descriptor of type
+   gint_lz_section_t in the .gint.lzdata section. The linker script collects
+   all descriptors, and the runtime decompresses them in link order. Only the
+   generated file needs to be added to the build.
+
+   Descriptors with the GINT_LZ_LAZY flag are not decoded at startup. The
+   add-in can decode them with gint_lz_load() the first time the data is
+   needed, which is useful for assets that are only used in some modes. */
+
+typedef struct {
+	/* Compressed stream (usually in ROM) and its size in bytes */
+	void const *src;
+	uint32_t src_size;
+	/* Destination buffer and size of the decompressed data */
+	void *dst;
+	uint32_t dst_size;
+	/* GINT_LZ_* flags */
+	uint32_t flags;
+
+} gint_lz_section_t;
+
+enum {
+	/* Don't decompress at startup; see gint_lz_load() */
+	GINT_LZ_LAZY = 0x01,
+};
+
+/* GINT_LZ_SECTION: Attribute for compressed data descriptors */
+#define GINT_LZ_SECTION \
+	GSECTION(".gint.lzdata") GVISIBLE GALIGNED(4)
+
+/* gint_lz_decompress(): Decode an LZ4 block
+
+   Decodes a single block in the LZ4 block format (without the frame header).
+   The input is fully validated; a malformed or truncated stream, or one that
+   would overflow the output buffer, results in an error.
+
+   @src       Compressed stream
+   @src_size  Size of the compressed stream, in bytes
+   @dst       Output buffer
+   @dst_size  Size of the output buffer, in bytes
+   Returns the number of bytes decoded, or -1 if the stream is invalid. */
+int gint_lz_decompress(void const *src, size_t src_size, void *dst,
+	size_t dst_size);
+
+/* gint_lz_load(): Decompress a compressed data section into its buffer
+   Returns true on success, false if the data is corrupted or has a size
+   different from the one recorded by the host tool. */
+bool gint_lz_load(gint_lz_section_t const *section);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GINT_LZ */
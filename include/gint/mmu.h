@@ -82,6 +82,47 @@ void tlb_mapped_memory(uint32_t *p_rom, uint32_t *p_ram);
 /* tlb_translate(): Get the physical address for a virtual page */
 uint32_t tlb_translate(uint32_t page, uint32_t *size);
 
+/* Software TLB cache
+
+   On SH3, every TLB miss in the add-in's ROM used to go through the OS'
+   mapping lookup. gint's TLB miss handler now remembers the 4k mappings that
+   the OS loads in a table indexed by page, and reloads them directly with
+   [ldtlb] when the page is evicted and accessed again. After each miss, the
+   next page is also loaded if its mapping is known, it's not already in the
+   TLB, and its set has a free way (live entries are never evicted for it).
+   The table is cleared whenever the OS has run, since it may have remapped
+   the add-in.
+
+   The tool tools/gint-tlbsim simulates this logic on recorded page traces to
+   estimate hit rates for different add-ins. */
+
+/* Number of 4k pages covered by the cache (512k of ROM) */
+#define TLB_CACHE_SIZE 128
+
+typedef struct {
+	/* Total ROM misses handled on SH3 */
+	uint32_t misses;
+	/* Misses resolved from the cache, without calling the OS */
+	uint32_t cache_hits;
+	/* Misses resolved by the OS */
+	uint32_t os_lookups;
+	/* Entries loaded in advance for the next page */
+	uint32_t prefetches;
+
+} tlb_cache_stats_t;
+
+/* tlb_cache_stats(): Get the TLB cache statistics
+   Only SH3 calculators use the cache; on SH4 the statistics remain zero. */
+void tlb_cache_stats(tlb_cache_stats_t *stats);
+
+/* tlb_cache_flush(): Forget all cached mappings
+   This is done automatically when returning from the OS. The statistics are
+   kept, so they cover the whole run of the add-in. */
+void tlb_cache_flush(void);
+
+/* tlb_cache_stats_reset(): Reset the TLB cache statistics to zero */
+void tlb_cache_stats_reset(void);
+
 //---
 //	SH7305 Unified TLB
 //---
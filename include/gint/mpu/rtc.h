@@ -52,7 +52,21 @@ typedef volatile struct
 		uint TENS	:4;
 		uint ONES	:4;
 	);
-	pad(12);			/* Alarm registers... */
+
+	/* Alarm registers; bit 7 (ENB) enables the comparison, the other bits
+	   hold the BCD value to compare with the counter */
+	uint8_t RSECAR;			/* Second alarm */
+	pad(1);
+	uint8_t RMINAR;			/* Minute alarm */
+	pad(1);
+	uint8_t RHRAR;			/* Hour alarm */
+	pad(1);
+	uint8_t RWKAR;			/* Day of week alarm */
+	pad(1);
+	uint8_t RDAYAR;			/* Day alarm */
+	pad(1);
+	uint8_t RMONAR;			/* Month alarm */
+	pad(1);
 
 	byte_union(RCR1,
 		uint8_t CF	:1;	/* Carry flag */
@@ -0,0 +1,197 @@
+//---
+//	gint:ring - Lock-free ring buffer indices
+//---
+
+#ifndef GINT_RING
+#define GINT_RING
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <gint/defs/types.h>
+#include <gint/defs/attributes.h>
+
+/* Ring buffers
+
+   This header provides the index arithmetic of a ring buffer with a power of
+   2 capacity; the caller owns the element array and copies elements in and
+   out of the slots returned by the functions. This way a single set of
+   functions works for every element type, and the capacity, which is always
+   a compile-time constant, folds into a mask when the functions are inlined.
+
+   [head] and [tail] are free-running 16-bit counters, so a ring can hold up to
+   [capacity] elements without a wasted slot, and capacity can be up to 32768.
+
+   Single producer, single consumer (SPSC):
+   Typically an interrupt handler producing and the main program consuming. No
+   synchronization is needed: the producer only writes [tail], the consumer
+   only writes [head], and each side commits its index after accessing the
+   element.
+
+     // Producer                          // Consumer
+     int s = gint_ring_push_slot(&r, N);   int s = gint_ring_pop_slot(&r, N);
+     if(s >= 0) {                          if(s >= 0) {
+         elements[s] = x;                      x = elements[s];
+         gint_ring_push_commit(&r);            gint_ring_pop_commit(&r);
+     }                                     }
+
+   Multiple producers, single consumer (MPSC):
+   The producers claim slots by incrementing [tail], then fill them and mark
+   them ready in a separate flag array. The consumer stops at the first slot
+   that is claimed but not ready yet. Only the reservation needs to be
+   serialized among producers, and it is a handful of instructions:
+
+   - Producers at different interrupt levels (eg. several interrupt handlers
+     and the main program) must mask interrupts with cpu_atomic_start() and
+     cpu_atomic_end() around gint_ring_mp_reserve(). A lock would not do,
+     because an interrupt spinning on it would never let the holder resume.
+   - Producers that cannot preempt each other (code at the same interrupt
+     level, or threads on a PC) can use gint_ring_trylock(), which is based
+     on the atomic [tas.b] instruction.
+
+   The functions only use compiler barriers on the calculator, which has a
+   single core, and full memory barriers elsewhere, so the same code can be
+   stress-tested with threads on a PC (see tools/ring-stress.c). */
+
+#ifdef __sh__
+# define GINT_RING_BARRIER() __asm__ volatile("" ::: "memory")
+#else
+# define GINT_RING_BARRIER() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+
+typedef struct {
+	/* Next element to consume, next element to produce */
+	uint16_t volatile head;
+	uint16_t volatile tail;
+
+} gint_ring_t;
+
+#define GINT_RING_INIT { 0, 0 }
+
+/* gint_ring_count(): Number of elements in the ring (including, for MPSC
+   rings, those that are reserved but not yet published) */
+static GINLINE int gint_ring_count(gint_ring_t const *r)
+{
+	return (uint16_t)(r->tail - r->head);
+}
+
+/* gint_ring_empty(): Whether the ring has no elements */
+static GINLINE bool gint_ring_empty(gint_ring_t const *r)
+{
+	return r->head == r->tail;
+}
+
+//---
+// Single producer, single consumer
+//---
+
+/* gint_ring_push_slot(): Get the slot for the next element
+   Returns the slot index, or -1 if the ring is full. */
+static GINLINE int gint_ring_push_slot(gint_ring_t const *r, uint capacity)
+{
+	uint16_t t = r->tail;
+	if((uint16_t)(t - r->head) >= capacity) return -1;
+	return t & (capacity - 1);
+}
+
+/* gint_ring_push_commit(): Make the element written in the slot visible */
+static GINLINE void gint_ring_push_commit(gint_ring_t *r)
+{
+	GINT_RING_BARRIER();
+	r->tail = r->tail + 1;
+}
+
+/* gint_ring_pop_slot(): Get the slot of the oldest element
+   Returns the slot index, or -1 if the ring is empty. */
+static GINLINE int gint_ring_pop_slot(gint_ring_t const *r, uint capacity)
+{
+	uint16_t h = r->head;
+	if(h == r->tail) return -1;
+	GINT_RING_BARRIER();
+	return h & (capacity - 1);
+}
+
+/* gint_ring_pop_commit(): Release the slot after reading the element */
+static GINLINE void gint_ring_pop_commit(gint_ring_t *r)
+{
+	GINT_RING_BARRIER();
+	r->head = r->head + 1;
+}
+
+//---
+// Multiple producers, single consumer
+//---
+
+/* gint_ring_mp_reserve(): Claim the next slot
+   Returns the slot index, or -1 if the ring is full. Producers must be
+   serialized by the caller for the duration of this call. */
+static GINLINE int gint_ring_mp_reserve(gint_ring_t *r, uint capacity)
+{
+	uint16_t t = r->tail;
+	if((uint16_t)(t - r->head) >= capacity) return -1;
+	r->tail = t + 1;
+	return t & (capacity - 1);
+}
+
+/* gint_ring_mp_publish(): Mark a claimed slot as filled */
+static GINLINE void gint_ring_mp_publish(uint8_t volatile *ready, int slot)
+{
+	GINT_RING_BARRIER();
+	ready[slot] = 1;
+}
+
+/* gint_ring_mp_pop_slot(): Get the slot of the oldest element
+   Returns -1 if the ring is empty, or if the oldest slot is claimed but not
+   published yet (which only happens when the consumer has preempted, or runs
+   in parallel with, the producer). */
+static GINLINE int gint_ring_mp_pop_slot(gint_ring_t const *r,
+	uint8_t volatile const *ready, uint capacity)
+{
+	uint16_t h = r->head;
+	int slot = h & (capacity - 1);
+	if(h == r->tail || !ready[slot]) return -1;
+	GINT_RING_BARRIER();
+	return slot;
+}
+
+/* gint_ring_mp_pop_commit(): Release the slot after reading the element */
+static GINLINE void gint_ring_mp_pop_commit(gint_ring_t *r,
+	uint8_t volatile *ready, uint capacity)
+{
+	ready[r->head & (capacity - 1)] = 0;
+	GINT_RING_BARRIER();
+	r->head = r->head + 1;
+}
+
+//---
+// Test-and-set lock
+//---
+
+/* gint_ring_trylock(): Try to take a byte lock
+   Returns true if the lock was free and is now taken. This never waits; see
+   above for when spinning on it is safe. */
+static GINLINE bool gint_ring_trylock(uint8_t volatile *lock)
+{
+#ifdef __sh__
+	int taken;
+	__asm__ volatile("tas.b @%1; movt %0"
+		: "=r"(taken) : "r"(lock) : "t", "memory");
+	return taken;
+#else
+	return !__atomic_test_and_set((void *)lock, __ATOMIC_ACQUIRE);
+#endif
+}
+
+/* gint_ring_unlock(): Release a lock taken with gint_ring_trylock() */
+static GINLINE void gint_ring_unlock(uint8_t volatile *lock)
+{
+	GINT_RING_BARRIER();
+	*lock = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GINT_RING */
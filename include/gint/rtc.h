@@ -51,6 +51,38 @@ void rtc_set_time(rtc_time_t const *time);
    be used as a 128-Hz counter, but it wraps around at midnight. */
 uint32_t rtc_ticks(void);
 
+//---
+//	Wall clock
+//	The RTC only counts time in 1/128 s. The ETMU are clocked by the same
+//	32768-Hz crystal, so an ETMU that is aligned on the RTC's sub-second
+//	counter can extend its resolution to a single crystal cycle (~30 µs).
+//	This gives absolute, high-resolution timestamps for logs and profiles
+//	without using a TMU.
+//---
+
+/* rtc_time_to_us(): Convert a point in time to microseconds since 1970
+   The RTC has no notion of time zone, so the epoch is 1970-01-01 00:00:00 in
+   whatever time the calculator is set to. [time->ticks] is included. */
+uint64_t rtc_time_to_us(rtc_time_t const *time);
+
+/* rtc_clock_start(): Use an ETMU to refine rtc_clock_us()
+
+   Reserves an ETMU and aligns it with the RTC, which takes up to 8 ms because
+   it waits for the sub-second counter to change. The alignment is redone
+   automatically the first time the clock is read after a world switch.
+   Returns false if no ETMU is available; rtc_clock_us() then keeps the
+   resolution of the RTC. */
+bool rtc_clock_start(void);
+
+/* rtc_clock_stop(): Free the ETMU used by the clock */
+void rtc_clock_stop(void);
+
+/* rtc_clock_us(): Current time in microseconds since 1970
+   This combines the RTC's date and time with the ETMU's sub-second counter if
+   rtc_clock_start() succeeded, and with R64CNT otherwise. The value follows
+   changes made with rtc_set_time(). */
+uint64_t rtc_clock_us(void);
+
 //---
 //	RTC periodic interrupt
 //	The real-time clock produces a regular interrupt which may be used as a
@@ -88,7 +120,8 @@ enum
 
    @frequency  Periodic interrupt frequency
    @callback   Function to call back at the specified frequency
-   Returns true on success, false if the interrupt is already in use. */
+   Returns true on success, false if another periodic callback is already set.
+   The periodic interrupt itself is shared with the alarms below. */
 bool rtc_periodic_enable(int frequency, gint_call_t callback);
 
 /* rtc_periodic_disable(): Stop the periodic interrupt
@@ -104,6 +137,46 @@ int rtc_start_timer(int frequency, timer_callback_t callback, ...);
 __attribute__((deprecated("Use rtc_periodic_disable() instead")))
 void rtc_stop_timer(void);
 
+//---
+//	RTC alarms
+//	Several alarms can be scheduled at once; they are multiplexed over the
+//	RTC's periodic and alarm interrupts (with rtc_periodic_enable() sharing
+//	the periodic interrupt). While the next alarm is more than a few seconds
+//	away, only the alarm interrupt is used, since it compares the time with
+//	a one-second resolution without waking up the CPU in-between. Closer to
+//	the deadline, the periodic interrupt is set to the slowest frequency
+//	that doesn't overshoot it, down to 256 Hz. Alarms fire within about 8 ms
+//	of their deadline.
+//
+//	Like timer callbacks, alarm callbacks are run in interrupt context.
+//---
+
+/* Maximum number of simultaneous alarms */
+#define RTC_ALARM_COUNT 8
+
+/* rtc_alarm_set(): Schedule a callback at a point in time
+
+   If [period_us] is 0, the alarm fires once and is then freed. Otherwise it
+   fires again every [period_us] microseconds as long as the callback returns
+   TIMER_CONTINUE; deadlines missed while interrupts were masked are skipped.
+
+   @time_us    Time of the first call, in the same unit as rtc_clock_us()
+   @period_us  Interval between calls, or 0 for a one-shot alarm
+   @callback   Function to call when the alarm fires
+   Returns the alarm ID, or -1 if all alarms are in use. */
+int rtc_alarm_set(uint64_t time_us, uint32_t period_us, gint_call_t callback);
+
+/* rtc_alarm_delay(): Schedule a callback after a delay
+   This is rtc_alarm_set() relative to the current time. */
+int rtc_alarm_delay(uint32_t delay_us, uint32_t period_us,
+	gint_call_t callback);
+
+/* rtc_alarm_cancel(): Cancel an alarm before it fires */
+void rtc_alarm_cancel(int id);
+
+/* rtc_alarm_pending(): Whether an alarm is still scheduled */
+bool rtc_alarm_pending(int id);
+
 #ifdef __cplusplus
 }
 #endif
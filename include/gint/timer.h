@@ -169,6 +169,14 @@ void timer_wait(int timer);
    called. */
 void timer_spinwait(int timer);
 
+/* timer_next_deadline(): Time until the next timer interrupt
+
+   Returns the time in microseconds until the earliest underflow among running
+   timers that have their interrupt enabled and match the specification
+   (TIMER_ANY, TIMER_TMU or TIMER_ETMU). Returns UINT32_MAX if no such timer is
+   running. This is used by the idle subsystem to pick a sleep state. */
+uint32_t timer_next_deadline(int spec);
+
 //---
 //	Low-level functions
 //---
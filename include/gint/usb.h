@@ -244,6 +244,11 @@ int usb_write_sync_timeout(int pipe, void const *data, int size,
    determine whether the write has finished, since it will return 0 if the pipe
    is idle and USB_WRITE_BUSY otherwise.
 
+   The callback is not invoked from the interrupt that finishes the write: it
+   is posted with gint_defer() and runs the next time the program calls
+   sleep(), pollevent() or gint_defer_run(). The synchronous functions do not
+   depend on this and can be used from interrupt handlers.
+
    @pipe       Pipe to write into
    @data       Source data
    @size       Size of source
@@ -273,7 +278,8 @@ int usb_commit_sync_timeout(int pipe, timeout_t const *timeout);
    callback of the previous asynchronous call is invoked.
 
    This function returns immediately and invokes (callback) when the transfer
-   of the remaining data completes. */
+   of the remaining data completes. Like for usb_write_async(), the callback
+   is deferred to the main program. */
 int usb_commit_async(int pipe, gint_call_t callback);
 
 /* usb_read_sync(): Synchronously read from a USB pipe
@@ -348,6 +354,7 @@ enum {
    This function returns a preliminary error code. If it is zero, then the
    callback will be invoked later with *rc set to the final return value of the
    read, which is itself either an error (< 0) or the number of bytes read.
+   As for usb_write_async(), the callback is deferred to the main program.
 
    Due to its low-level nature, raw usb_read_async() is a bit impractical to
    use and almost always requires repeated calls and callback waits. The
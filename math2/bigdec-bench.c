@@ -0,0 +1,78 @@
+/*
+ * bigdec-bench.c - Throughput benchmark for bigdec
+ *
+ * The add-in runs it from the mode selection screen (F6). On the host,
+ * build and run it with:
+ *
+ *   cc -O2 -DBIGDEC_BENCH_HOST -o bigdec-bench bigdec-bench.c bigdec.c -lm
+ */
+
+#include "bigdec-bench.h"
+#include "bigdec.h"
+
+const char *const bigdec_bench_names[BIGDEC_BENCH_OPS] = {
+    "add", "mul", "div", "sqrt", "cbrt", "pi",
+};
+
+static bigdec_t x, y, r;
+
+void bigdec_bench_setup(int digits)
+{
+    bigdec_t three;
+    bigdec_set_digits(digits);
+    bigdec_from_int(&three, 3);
+
+    /* Operands with all their digits used: sqrt(2) and 1/3 */
+    bigdec_from_int(&x, 2);
+    bigdec_sqrt(&x, &x);
+    bigdec_from_int(&y, 1);
+    bigdec_div(&y, &y, &three);
+}
+
+void bigdec_bench_run(int op, int count)
+{
+    for(int i = 0; i < count; i++) {
+        switch(op) {
+            case 0: bigdec_add(&r, &x, &y); break;
+            case 1: bigdec_mul(&r, &x, &y); break;
+            case 2: bigdec_div(&r, &x, &y); break;
+            case 3: bigdec_sqrt(&r, &x); break;
+            case 4: bigdec_root(&r, &x, 3); break;
+            case 5: bigdec_pi(&r); break;
+        }
+    }
+}
+
+#ifdef BIGDEC_BENCH_HOST
+
+#include <stdio.h>
+#include <time.h>
+
+int main(void)
+{
+    static const int digits[] = { 20, 50, 200 };
+
+    printf("%-6s", "op/s");
+    for(int d = 0; d < 3; d++) printf("%12d", digits[d]);
+    printf("\n");
+
+    for(int op = 0; op < BIGDEC_BENCH_OPS; op++) {
+        printf("%-6s", bigdec_bench_names[op]);
+        for(int d = 0; d < 3; d++) {
+            bigdec_bench_setup(digits[d]);
+            long count = 0;
+            clock_t start = clock(), elapsed;
+            int batch = 1;
+            while((elapsed = clock() - start) < CLOCKS_PER_SEC / 2) {
+                bigdec_bench_run(op, batch);
+                count += batch;
+                if(batch < 4096) batch *= 2;
+            }
+            printf("%12.0f", count * (double)CLOCKS_PER_SEC / elapsed);
+        }
+        printf("\n");
+    }
+    return 0;
+}
+
+#endif /* BIGDEC_BENCH_HOST */
@@ -0,0 +1,22 @@
+/*
+ * bigdec-bench.h - Throughput benchmark for bigdec
+ *
+ * The operations are shared by the host build of bigdec-bench.c and by the
+ * benchmark screen of the add-in, which time them with their own clocks.
+ */
+
+#ifndef BIGDEC_BENCH_H
+#define BIGDEC_BENCH_H
+
+#define BIGDEC_BENCH_OPS 6
+
+/* Operation names: add, mul, div, sqrt, cbrt, pi */
+extern const char *const bigdec_bench_names[BIGDEC_BENCH_OPS];
+
+/* Set the precision and prepare operands with that many digits */
+void bigdec_bench_setup(int digits);
+
+/* Run an operation count times */
+void bigdec_bench_run(int op, int count);
+
+#endif /* BIGDEC_BENCH_H */
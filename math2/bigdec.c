@@ -0,0 +1,743 @@
+/*
+ * bigdec.c - Fixed-size big decimal arithmetic
+ */
+
+#include "bigdec.h"
+#include <math.h>
+#include <string.h>
+
+#define BASE BIGDEC_BASE
+
+/* Working precision in limbs, guard limb included */
+static int g_prec = 7;
+static int g_digits = 20;
+
+/* ===== Arena ===== */
+
+/* Temporary limbs, allocated and released in stack order */
+static uint16_t g_arena[BIGDEC_ARENA_LIMBS];
+static int g_arena_used = 0;
+
+static uint16_t *arena_alloc(int limbs)
+{
+    uint16_t *p = g_arena + g_arena_used;
+    g_arena_used += limbs;
+    return p;
+}
+
+/* ===== Limb Arrays ===== */
+
+/* Store sign × limbs[0..n) × BASE^exp into r, rounded to the precision. The
+   limbs may be r->limb itself. */
+static void set_limbs(bigdec_t *r, int sign, const uint16_t *limbs, int n,
+                      int exp)
+{
+    while(n > 0 && limbs[n-1] == 0) n--;
+    if(n == 0) {
+        bigdec_zero(r);
+        return;
+    }
+
+    int drop = 0;
+    bool round_up = false;
+    if(n > g_prec) {
+        drop = n - g_prec;
+        round_up = limbs[drop-1] >= BASE / 2;
+    }
+
+    int len = n - drop;
+    for(int i = 0; i < len; i++) r->limb[i] = limbs[drop + i];
+    exp += drop;
+
+    if(round_up) {
+        int i = 0;
+        while(i < len && r->limb[i] == BASE - 1) r->limb[i++] = 0;
+        if(i < len) {
+            r->limb[i]++;
+        }
+        else {
+            /* 9999...9999 rounded up to a single 1 */
+            exp += len;
+            len = 1;
+            r->limb[0] = 1;
+        }
+    }
+
+    int low = 0;
+    while(r->limb[low] == 0) low++;
+    if(low) {
+        for(int i = 0; i < len - low; i++) r->limb[i] = r->limb[i + low];
+        len -= low;
+        exp += low;
+    }
+
+    r->sign = sign;
+    r->len = len;
+    r->exp = exp;
+}
+
+/* r[0..an) = a + b with an >= bn; returns the carry */
+static int add_limbs(uint16_t *r, const uint16_t *a, int an, const uint16_t *b,
+                     int bn)
+{
+    int carry = 0;
+    for(int i = 0; i < an; i++) {
+        int t = a[i] + (i < bn ? b[i] : 0) + carry;
+        carry = (t >= BASE);
+        r[i] = carry ? t - BASE : t;
+    }
+    return carry;
+}
+
+/* r[0..rn) += a[0..an), the result fits */
+static void add_in(uint16_t *r, int rn, const uint16_t *a, int an)
+{
+    int carry = 0;
+    for(int i = 0; i < rn && (i < an || carry); i++) {
+        int t = r[i] + (i < an ? a[i] : 0) + carry;
+        carry = (t >= BASE);
+        r[i] = carry ? t - BASE : t;
+    }
+}
+
+/* r[0..rn) -= a[0..an), the result is not negative */
+static void sub_in(uint16_t *r, int rn, const uint16_t *a, int an)
+{
+    int borrow = 0;
+    for(int i = 0; i < rn && (i < an || borrow); i++) {
+        int t = r[i] - (i < an ? a[i] : 0) - borrow;
+        borrow = (t < 0);
+        r[i] = borrow ? t + BASE : t;
+    }
+}
+
+static int cmp_limbs(const uint16_t *a, const uint16_t *b, int n)
+{
+    for(int i = n - 1; i >= 0; i--) {
+        if(a[i] != b[i]) return (a[i] < b[i]) ? -1 : 1;
+    }
+    return 0;
+}
+
+/* r[0..an+bn) = a × b */
+static void mul_basecase(uint16_t *r, const uint16_t *a, int an,
+                         const uint16_t *b, int bn)
+{
+    memset(r, 0, (an + bn) * sizeof *r);
+    for(int i = 0; i < an; i++) {
+        uint32_t ai = a[i], carry = 0;
+        if(!ai) continue;
+        for(int j = 0; j < bn; j++) {
+            uint32_t t = r[i+j] + ai * b[j] + carry;
+            carry = t / BASE;
+            r[i+j] = t - carry * BASE;
+        }
+        r[i+bn] = carry;
+    }
+}
+
+/* r[0..2n) = a[0..n) × b[0..n), splitting a = a1 BASE^h + a0 and computing
+   a0 b0, a1 b1 and (a0 + a1)(b0 + b1) */
+static void mul_n(uint16_t *r, const uint16_t *a, const uint16_t *b, int n)
+{
+    if(n < BIGDEC_KARATSUBA) {
+        mul_basecase(r, a, n, b, n);
+        return;
+    }
+
+    int h = n / 2, k = n - h;
+    int mark = g_arena_used;
+    uint16_t *sa = arena_alloc(k + 1);
+    uint16_t *sb = arena_alloc(k + 1);
+    uint16_t *z1 = arena_alloc(2 * k + 2);
+
+    sa[k] = add_limbs(sa, a + h, k, a, h);
+    sb[k] = add_limbs(sb, b + h, k, b, h);
+
+    mul_n(r, a, b, h);
+    mul_n(r + 2 * h, a + h, b + h, k);
+    mul_n(z1, sa, sb, k + 1);
+
+    sub_in(z1, 2 * k + 2, r, 2 * h);
+    sub_in(z1, 2 * k + 2, r + 2 * h, 2 * k);
+    add_in(r + h, 2 * n - h, z1, 2 * k + 2);
+
+    g_arena_used = mark;
+}
+
+/* r[0..n+1) = a[0..n) × k */
+static void mul_small_limbs(uint16_t *r, const uint16_t *a, int n, uint32_t k)
+{
+    uint32_t carry = 0;
+    for(int i = 0; i < n; i++) {
+        uint32_t t = a[i] * k + carry;
+        carry = t / BASE;
+        r[i] = t - carry * BASE;
+    }
+    r[n] = carry;
+}
+
+/* ===== Precision ===== */
+
+void bigdec_set_digits(int digits)
+{
+    if(digits < 1) digits = 1;
+    if(digits > BIGDEC_DIGITS_MAX) digits = BIGDEC_DIGITS_MAX;
+    g_digits = digits;
+    g_prec = (digits + 3) / 4 + 1;
+}
+
+int bigdec_get_digits(void)
+{
+    return g_digits;
+}
+
+/* ===== Conversion ===== */
+
+void bigdec_zero(bigdec_t *r)
+{
+    r->sign = 0;
+    r->len = 0;
+    r->exp = 0;
+}
+
+void bigdec_from_int(bigdec_t *r, long long value)
+{
+    uint16_t limbs[5];
+    unsigned long long v = (value < 0) ? -(unsigned long long)value
+                                       : (unsigned long long)value;
+    int n = 0;
+    while(v) {
+        limbs[n++] = v % BASE;
+        v /= BASE;
+    }
+    set_limbs(r, (value < 0) ? -1 : 1, limbs, n, 0);
+}
+
+void bigdec_from_double(bigdec_t *r, double value)
+{
+    if(value == 0 || !isfinite(value)) {
+        bigdec_zero(r);
+        return;
+    }
+
+    /* 15 digits as an integer, times a power of 10 that is a multiple of 4
+       to match the limbs */
+    double v = fabs(value);
+    int e10 = (int)floor(log10(v)) - 14;
+    long long m = llround(v / pow(10, e10 / 2) / pow(10, e10 - e10 / 2));
+    int shift = ((e10 % 4) + 4) % 4;
+    for(int i = 0; i < shift; i++) m *= 10;
+    e10 -= shift;
+
+    uint16_t limbs[5];
+    int n = 0;
+    while(m) {
+        limbs[n++] = m % BASE;
+        m /= BASE;
+    }
+    set_limbs(r, (value < 0) ? -1 : 1, limbs, n, e10 / 4);
+}
+
+bool bigdec_from_string(bigdec_t *r, const char *str)
+{
+    char digits[BIGDEC_DIGITS_MAX + 4];
+    int nd = 0, frac = 0;
+    bool dot = false;
+
+    for(; *str; str++) {
+        if(*str == '.' && !dot) {
+            dot = true;
+        }
+        else if(*str >= '0' && *str <= '9') {
+            if(nd >= BIGDEC_DIGITS_MAX) return false;
+            digits[nd++] = *str - '0';
+            frac += dot;
+        }
+        else return false;
+    }
+    if(nd == 0) return false;
+
+    /* Pad the fractional part to whole limbs */
+    while(frac % 4) {
+        digits[nd++] = 0;
+        frac++;
+    }
+
+    int mark = g_arena_used;
+    int n = (nd + 3) / 4;
+    uint16_t *limbs = arena_alloc(n);
+    for(int i = 0; i < n; i++) {
+        int v = 0;
+        for(int j = 3; j >= 0; j--) {
+            int d = nd - 1 - (4 * i + j);
+            v = v * 10 + (d >= 0 ? digits[d] : 0);
+        }
+        limbs[i] = v;
+    }
+    set_limbs(r, 1, limbs, n, -frac / 4);
+    g_arena_used = mark;
+    return true;
+}
+
+double bigdec_to_double(const bigdec_t *x)
+{
+    double m = 0;
+    int stop = (x->len > 4) ? x->len - 4 : 0;
+    for(int i = x->len - 1; i >= stop; i--) m = m * BASE + x->limb[i];
+    return x->sign * m * pow(BASE, x->exp + stop);
+}
+
+bool bigdec_to_int(const bigdec_t *x, long long *value)
+{
+    if(!x->sign) {
+        *value = 0;
+        return true;
+    }
+    if(x->exp < 0 || x->exp + x->len > 4) return false;
+
+    long long v = 0;
+    for(int i = x->len - 1; i >= 0; i--) v = v * BASE + x->limb[i];
+    for(int i = 0; i < x->exp; i++) v *= BASE;
+    *value = x->sign * v;
+    return true;
+}
+
+int bigdec_digits(const bigdec_t *x, char *digits, int count, int *exponent)
+{
+    if(!x->sign) {
+        digits[0] = '0';
+        *exponent = 0;
+        return 1;
+    }
+
+    char all[4 * BIGDEC_LIMBS];
+    int n = 0;
+    for(int i = x->len - 1; i >= 0; i--, n += 4) {
+        int v = x->limb[i];
+        for(int j = 3; j >= 0; j--, v /= 10) all[n + j] = '0' + v % 10;
+    }
+    int lead = 0;
+    while(all[lead] == '0') lead++;
+    *exponent = 4 * (x->exp + x->len) - lead - 1;
+
+    int nd = n - lead;
+    if(nd > count) nd = count;
+    memcpy(digits, all + lead, nd);
+
+    if(n - lead > count && all[lead + count] >= '5') {
+        int i = nd - 1;
+        while(i >= 0 && digits[i] == '9') digits[i--] = '0';
+        if(i >= 0) {
+            digits[i]++;
+        }
+        else {
+            digits[0] = '1';
+            (*exponent)++;
+        }
+    }
+
+    while(nd > 1 && digits[nd-1] == '0') nd--;
+    return nd;
+}
+
+/* ===== Comparison ===== */
+
+bool bigdec_is_zero(const bigdec_t *x)
+{
+    return x->sign == 0;
+}
+
+int bigdec_exponent(const bigdec_t *x)
+{
+    if(!x->sign) return 0;
+    int top = x->limb[x->len - 1];
+    int d = (top >= 1000) ? 3 : (top >= 100) ? 2 : (top >= 10) ? 1 : 0;
+    return 4 * (x->exp + x->len - 1) + d;
+}
+
+static int cmp_abs(const bigdec_t *a, const bigdec_t *b)
+{
+    int ta = a->exp + a->len, tb = b->exp + b->len;
+    if(ta != tb) return (ta < tb) ? -1 : 1;
+
+    int i = a->len - 1, j = b->len - 1;
+    for(; i >= 0 && j >= 0; i--, j--) {
+        if(a->limb[i] != b->limb[j]) return (a->limb[i] < b->limb[j]) ? -1 : 1;
+    }
+    return (i >= 0) - (j >= 0);
+}
+
+int bigdec_cmp(const bigdec_t *a, const bigdec_t *b)
+{
+    if(a->sign != b->sign) return (a->sign < b->sign) ? -1 : 1;
+    return a->sign * cmp_abs(a, b);
+}
+
+/* ===== Arithmetic ===== */
+
+void bigdec_neg(bigdec_t *r, const bigdec_t *a)
+{
+    *r = *a;
+    r->sign = -r->sign;
+}
+
+void bigdec_abs(bigdec_t *r, const bigdec_t *a)
+{
+    *r = *a;
+    if(r->sign < 0) r->sign = 1;
+}
+
+void bigdec_trunc(bigdec_t *r, const bigdec_t *a)
+{
+    if(a->exp >= 0) {
+        *r = *a;
+        return;
+    }
+    int drop = -a->exp;
+    if(drop >= a->len) {
+        bigdec_zero(r);
+        return;
+    }
+    set_limbs(r, a->sign, a->limb + drop, a->len - drop, 0);
+}
+
+/* Copy the limbs of x at and above BASE^low into r[0..n) */
+static void place(uint16_t *r, int n, const bigdec_t *x, int low)
+{
+    memset(r, 0, n * sizeof *r);
+    for(int i = 0; i < x->len; i++) {
+        int pos = x->exp + i - low;
+        if(pos >= 0) r[pos] = x->limb[i];
+    }
+}
+
+static void add_signed(bigdec_t *r, const bigdec_t *a, const bigdec_t *b,
+                       int b_sign)
+{
+    if(!b->sign) {
+        *r = *a;
+        return;
+    }
+    if(!a->sign) {
+        *r = *b;
+        r->sign = b_sign;
+        set_limbs(r, r->sign, r->limb, r->len, r->exp);
+        return;
+    }
+
+    /* Align, ignoring limbs far below the precision of the result */
+    int ta = a->exp + a->len, tb = b->exp + b->len;
+    int top = (ta > tb) ? ta : tb;
+    int low = (a->exp < b->exp) ? a->exp : b->exp;
+    if(low < top - g_prec - 2) low = top - g_prec - 2;
+    int n = top - low + 1;
+
+    int mark = g_arena_used;
+    uint16_t *x = arena_alloc(n);
+    uint16_t *y = arena_alloc(n);
+    place(x, n, a, low);
+    place(y, n, b, low);
+
+    int sign = a->sign;
+    if(a->sign == b_sign) {
+        add_in(x, n, y, n);
+    }
+    else if(cmp_limbs(x, y, n) >= 0) {
+        sub_in(x, n, y, n);
+    }
+    else {
+        sub_in(y, n, x, n);
+        x = y;
+        sign = b_sign;
+    }
+    set_limbs(r, sign, x, n, low);
+    g_arena_used = mark;
+}
+
+void bigdec_add(bigdec_t *r, const bigdec_t *a, const bigdec_t *b)
+{
+    add_signed(r, a, b, b->sign);
+}
+
+void bigdec_sub(bigdec_t *r, const bigdec_t *a, const bigdec_t *b)
+{
+    add_signed(r, a, b, -b->sign);
+}
+
+void bigdec_mul(bigdec_t *r, const bigdec_t *a, const bigdec_t *b)
+{
+    if(!a->sign || !b->sign) {
+        bigdec_zero(r);
+        return;
+    }
+
+    int an = a->len, bn = b->len;
+    int n = (an > bn) ? an : bn;
+    int mark = g_arena_used;
+    uint16_t *p = arena_alloc(2 * n);
+
+    if(an < BIGDEC_KARATSUBA || bn < BIGDEC_KARATSUBA) {
+        mul_basecase(p, a->limb, an, b->limb, bn);
+    }
+    else {
+        uint16_t *x = arena_alloc(n);
+        uint16_t *y = arena_alloc(n);
+        memset(x, 0, n * sizeof *x);
+        memset(y, 0, n * sizeof *y);
+        memcpy(x, a->limb, an * sizeof *x);
+        memcpy(y, b->limb, bn * sizeof *y);
+        mul_n(p, x, y, n);
+    }
+
+    set_limbs(r, a->sign * b->sign, p, an + bn, a->exp + b->exp);
+    g_arena_used = mark;
+}
+
+/* Long division (Knuth's algorithm D), with the dividend shifted so that the
+   quotient has at least the precision plus a guard limb */
+bool bigdec_div(bigdec_t *r, const bigdec_t *a, const bigdec_t *b)
+{
+    if(!b->sign) return false;
+    if(!a->sign) {
+        bigdec_zero(r);
+        return true;
+    }
+
+    int n = b->len, an = a->len;
+    int s = g_prec + 1 + n - an;
+    if(s < 0) s = 0;
+    int m = an + s - n;
+    int sign = a->sign * b->sign;
+    int exp = a->exp - s - b->exp;
+
+    int mark = g_arena_used;
+    uint16_t *u = arena_alloc(an + s + 1);
+    uint16_t *q = arena_alloc(m + 1);
+    memset(u, 0, s * sizeof *u);
+
+    if(n == 1) {
+        uint32_t v = b->limb[0], rem = 0;
+        memcpy(u + s, a->limb, an * sizeof *u);
+        for(int j = an + s - 1; j >= 0; j--) {
+            uint32_t cur = rem * BASE + u[j];
+            q[j] = cur / v;
+            rem = cur - q[j] * v;
+        }
+        set_limbs(r, sign, q, an + s, exp);
+        g_arena_used = mark;
+        return true;
+    }
+
+    /* Normalize so that the top limb of the divisor is at least BASE/2 */
+    uint16_t *v = arena_alloc(n + 1);
+    uint32_t d = BASE / (b->limb[n-1] + 1);
+    mul_small_limbs(u + s, a->limb, an, d);
+    mul_small_limbs(v, b->limb, n, d);
+
+    for(int j = m; j >= 0; j--) {
+        uint32_t num = u[j+n] * BASE + u[j+n-1];
+        uint32_t qhat = num / v[n-1];
+        uint32_t rhat = num - qhat * v[n-1];
+        while(qhat >= BASE || qhat * v[n-2] > rhat * BASE + u[j+n-2]) {
+            qhat--;
+            rhat += v[n-1];
+            if(rhat >= BASE) break;
+        }
+
+        /* u[j..j+n] -= qhat × v */
+        uint32_t carry = 0;
+        int borrow = 0;
+        for(int i = 0; i < n; i++) {
+            uint32_t p = qhat * v[i] + carry;
+            carry = p / BASE;
+            int t = u[i+j] - (int)(p - carry * BASE) - borrow;
+            borrow = (t < 0);
+            u[i+j] = borrow ? t + BASE : t;
+        }
+        int top = u[j+n] - (int)carry - borrow;
+
+        /* qhat was one too large: add v back */
+        if(top < 0) {
+            qhat--;
+            int c = 0;
+            for(int i = 0; i < n; i++) {
+                int t = u[i+j] + v[i] + c;
+                c = (t >= BASE);
+                u[i+j] = c ? t - BASE : t;
+            }
+            top += c;
+        }
+        u[j+n] = top;
+        q[j] = qhat;
+    }
+
+    set_limbs(r, sign, q, m + 1, exp);
+    g_arena_used = mark;
+    return true;
+}
+
+void bigdec_mul_small(bigdec_t *r, const bigdec_t *a, int k)
+{
+    if(!a->sign) {
+        bigdec_zero(r);
+        return;
+    }
+    int mark = g_arena_used;
+    uint16_t *p = arena_alloc(a->len + 2);
+    mul_small_limbs(p, a->limb, a->len, k);
+    p[a->len + 1] = p[a->len] / BASE;
+    p[a->len] %= BASE;
+    set_limbs(r, a->sign, p, a->len + 2, a->exp);
+    g_arena_used = mark;
+}
+
+void bigdec_div_small(bigdec_t *r, const bigdec_t *a, int k)
+{
+    if(!a->sign) {
+        bigdec_zero(r);
+        return;
+    }
+
+    /* Quotient limbs from the top limb of a down to below the precision */
+    int n = g_prec + 2;
+    int mark = g_arena_used;
+    uint16_t *q = arena_alloc(n);
+    uint32_t rem = 0;
+    for(int i = n - 1, ai = a->len - 1; i >= 0; i--, ai--) {
+        uint32_t cur = rem * BASE + (ai >= 0 ? a->limb[ai] : 0);
+        q[i] = cur / k;
+        rem = cur - q[i] * k;
+    }
+    set_limbs(r, a->sign, q, n, a->exp + a->len - n);
+    g_arena_used = mark;
+}
+
+static bool too_large(const bigdec_t *x)
+{
+    return x->exp + x->len > BIGDEC_EXP_MAX || x->exp < -BIGDEC_EXP_MAX;
+}
+
+bool bigdec_pow_int(bigdec_t *r, const bigdec_t *a, long long n)
+{
+    if(!a->sign) {
+        if(n < 0) return false;
+        if(n == 0) bigdec_from_int(r, 1);
+        else bigdec_zero(r);
+        return true;
+    }
+
+    unsigned long long e = (n < 0) ? -(unsigned long long)n
+                                   : (unsigned long long)n;
+    bigdec_t base = *a, acc;
+    bigdec_from_int(&acc, 1);
+    while(e) {
+        if(e & 1) bigdec_mul(&acc, &acc, &base);
+        e >>= 1;
+        if(e) bigdec_mul(&base, &base, &base);
+        if(too_large(&acc) || too_large(&base)) return false;
+    }
+
+    if(n < 0) {
+        bigdec_t one;
+        bigdec_from_int(&one, 1);
+        bigdec_div(&acc, &one, &acc);
+    }
+    *r = acc;
+    return true;
+}
+
+bool bigdec_sqrt(bigdec_t *r, const bigdec_t *a)
+{
+    return bigdec_root(r, a, 2);
+}
+
+/* Newton's iteration x -= (x - a / x^(n-1)) / n from a double estimate; it
+   doubles the number of correct digits each time */
+bool bigdec_root(bigdec_t *r, const bigdec_t *a, int n)
+{
+    if(n < 1 || (a->sign < 0 && n % 2 == 0)) return false;
+    if(n == 1 || !a->sign) {
+        *r = *a;
+        return true;
+    }
+
+    bigdec_t abs_a, x, t;
+    bigdec_abs(&abs_a, a);
+
+    /* Estimate with the exponent split off so that doubles don't overflow:
+       a = m × BASE^(qn + rem) */
+    double m = 0;
+    int stop = (a->len > 4) ? a->len - 4 : 0;
+    for(int i = a->len - 1; i >= stop; i--) m = m * BASE + a->limb[i];
+    int e = a->exp + stop;
+    int q = (e >= 0) ? e / n : -((-e + n - 1) / n);
+    int rem = e - q * n;
+    bigdec_from_double(&x, pow(m, 1.0 / n) * pow(BASE, (double)rem / n));
+    x.exp += q;
+
+    int iterations = 2;
+    for(int digits = 14; digits < 4 * g_prec; digits *= 2) iterations++;
+
+    for(int i = 0; i < iterations; i++) {
+        if(!bigdec_pow_int(&t, &x, n - 1)) return false;
+        bigdec_div(&t, &abs_a, &t);
+        bigdec_sub(&t, &x, &t);
+        bigdec_div_small(&t, &t, n);
+        bigdec_sub(&x, &x, &t);
+    }
+
+    x.sign = x.sign ? a->sign : 0;
+    *r = x;
+    return true;
+}
+
+/* ===== Constants ===== */
+
+/* Check if a term is below the precision, for series that converge to
+   values around 1 */
+static bool negligible(const bigdec_t *x)
+{
+    return !x->sign || x->exp + x->len < -g_prec;
+}
+
+/* atan(1/k) = 1/k - 1/3k³ + 1/5k⁵ - ..., for k <= 255 */
+static void atan_inv(bigdec_t *r, int k)
+{
+    bigdec_t term, t;
+    bigdec_from_int(&term, 1);
+    bigdec_div_small(&term, &term, k);
+    *r = term;
+
+    for(int i = 1;; i++) {
+        bigdec_div_small(&term, &term, k * k);
+        if(negligible(&term)) break;
+        bigdec_div_small(&t, &term, 2 * i + 1);
+        if(i & 1) bigdec_sub(r, r, &t);
+        else bigdec_add(r, r, &t);
+    }
+}
+
+/* Machin's formula: π = 16 atan(1/5) - 4 atan(1/239) */
+void bigdec_pi(bigdec_t *r)
+{
+    bigdec_t a, b;
+    atan_inv(&a, 5);
+    bigdec_mul_small(&a, &a, 16);
+    atan_inv(&b, 239);
+    bigdec_mul_small(&b, &b, 4);
+    bigdec_sub(r, &a, &b);
+}
+
+/* e = 1 + 1/1! + 1/2! + ... */
+void bigdec_e(bigdec_t *r)
+{
+    bigdec_t term;
+    bigdec_from_int(&term, 1);
+    *r = term;
+    for(int k = 1;; k++) {
+        bigdec_div_small(&term, &term, k);
+        if(negligible(&term)) break;
+        bigdec_add(r, r, &term);
+    }
+}
@@ -0,0 +1,118 @@
+/*
+ * bigdec.h - Fixed-size big decimal arithmetic
+ *
+ * Numbers are stored in base 10000 (four decimal digits per 16-bit limb) so
+ * that decimal input and output are exact, and that limb products fit in 32
+ * bits without a hardware divider having to deal with 64-bit values.
+ *
+ * All values have the same fixed size and live wherever the caller puts
+ * them. Results are rounded to the working precision set by
+ * bigdec_set_digits(), plus one guard limb. Temporary limbs (products,
+ * Karatsuba terms, division remainders) come from a static arena that is
+ * used as a stack: every operation releases what it took before returning,
+ * so there is no heap use and no fragmentation.
+ *
+ * Destinations may alias operands.
+ */
+
+#ifndef BIGDEC_H
+#define BIGDEC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Largest working precision, in decimal digits */
+#define BIGDEC_DIGITS_MAX 240
+
+#define BIGDEC_BASE 10000
+#define BIGDEC_LIMBS (BIGDEC_DIGITS_MAX / 4 + 2)
+
+/* Operand size (in limbs) from which multiplication uses Karatsuba; below
+   it schoolbook multiplication is faster */
+#ifndef BIGDEC_KARATSUBA
+#define BIGDEC_KARATSUBA 20
+#endif
+
+/* Arena size: a multiplication uses at most 12 times the operand size */
+#define BIGDEC_ARENA_LIMBS (12 * BIGDEC_LIMBS)
+
+/* Largest exponent (in limbs) that powers may reach */
+#define BIGDEC_EXP_MAX 100000
+
+/* Big decimal: sign × limb[len-1] ... limb[0] × BASE^exp */
+typedef struct {
+    int8_t sign;            /* 1, -1, or 0 for zero */
+    uint8_t len;            /* Limbs used; the top and bottom ones are not 0 */
+    int32_t exp;            /* Power of BASE of limb[0] */
+    uint16_t limb[BIGDEC_LIMBS];    /* Least significant first */
+} bigdec_t;
+
+/* ===== Precision ===== */
+
+/* Set the working precision, at most BIGDEC_DIGITS_MAX digits */
+void bigdec_set_digits(int digits);
+int bigdec_get_digits(void);
+
+/* ===== Conversion ===== */
+
+void bigdec_zero(bigdec_t *r);
+void bigdec_from_int(bigdec_t *r, long long value);
+void bigdec_from_double(bigdec_t *r, double value);
+
+/* Parse a plain decimal number ("12", "0.25", ".5"); returns false if the
+   string is not one or has more than BIGDEC_DIGITS_MAX digits */
+bool bigdec_from_string(bigdec_t *r, const char *str);
+
+double bigdec_to_double(const bigdec_t *x);
+
+/* Get the value of an integer of at most 16 digits, else return false */
+bool bigdec_to_int(const bigdec_t *x, long long *value);
+
+/* Round to count significant digits, written to digits[] without a NUL.
+   Trailing zeros are dropped; returns the number of digits, and sets
+   *exponent to the power of 10 of the first one. Zero gives "0". */
+int bigdec_digits(const bigdec_t *x, char *digits, int count, int *exponent);
+
+/* ===== Comparison ===== */
+
+bool bigdec_is_zero(const bigdec_t *x);
+
+/* Power of 10 of the first significant digit; 0 for zero */
+int bigdec_exponent(const bigdec_t *x);
+
+/* Returns <0, 0 or >0 */
+int bigdec_cmp(const bigdec_t *a, const bigdec_t *b);
+
+/* ===== Arithmetic ===== */
+
+void bigdec_neg(bigdec_t *r, const bigdec_t *a);
+void bigdec_abs(bigdec_t *r, const bigdec_t *a);
+
+/* Drop the fractional part */
+void bigdec_trunc(bigdec_t *r, const bigdec_t *a);
+
+void bigdec_add(bigdec_t *r, const bigdec_t *a, const bigdec_t *b);
+void bigdec_sub(bigdec_t *r, const bigdec_t *a, const bigdec_t *b);
+void bigdec_mul(bigdec_t *r, const bigdec_t *a, const bigdec_t *b);
+
+/* Returns false on division by zero */
+bool bigdec_div(bigdec_t *r, const bigdec_t *a, const bigdec_t *b);
+
+/* Multiply or divide by 1 <= k <= 65535 */
+void bigdec_mul_small(bigdec_t *r, const bigdec_t *a, int k);
+void bigdec_div_small(bigdec_t *r, const bigdec_t *a, int k);
+
+/* Integer power; returns false for 0^-n or if the result is too large */
+bool bigdec_pow_int(bigdec_t *r, const bigdec_t *a, long long n);
+
+/* Square root and nth root (1 <= n <= 65535); return false for even roots
+   of negative numbers */
+bool bigdec_sqrt(bigdec_t *r, const bigdec_t *a);
+bool bigdec_root(bigdec_t *r, const bigdec_t *a, int n);
+
+/* ===== Constants ===== */
+
+void bigdec_pi(bigdec_t *r);
+void bigdec_e(bigdec_t *r);
+
+#endif /* BIGDEC_H */
@@ -0,0 +1,241 @@
+/*
+ * clone-test.c - Host test for subtree cloning and the clipboard
+ *
+ * Builds an expression with every node type, then checks that clones are
+ * identical and detached, that copy, cut and paste keep the tree linked
+ * correctly, and that no pool node is leaked or shared: every used node
+ * must be reachable from exactly one of the root and the clipboard. It is
+ * not part of the add-in; build it on the host with (the gint build
+ * directory provides the generated <gint/config.h>):
+ *
+ *   cc -O2 -I../build-cg/include -I../include -DFXCG50 \
+ *      -o clone-test clone-test.c math2.c host-stubs.c host-type.c
+ */
+
+#include "host-type.h"
+#include <stdio.h>
+#include <string.h>
+
+static math_expr2_t expr;
+static int errors;
+
+#define CHECK(cond) do {                                            \
+    if(!(cond)) {                                                   \
+        printf("  FAIL line %d: %s\n", __LINE__, #cond);            \
+        errors++;                                                   \
+    }                                                               \
+} while(0)
+
+/* ===== Tree Checks ===== */
+
+static int count_used(void)
+{
+    int n = 0;
+    for(int i = 0; i < MAX_NODES; i++)
+        n += (expr.nodes[i].type != NODE_EMPTY);
+    return n;
+}
+
+/* Get the child sequences of a node; returns how many there are */
+static int slots(expr_node_t *node, expr_node_t *slot[3])
+{
+    switch(node->type) {
+    case NODE_FRACTION:
+        slot[0] = node->data.frac.numer;
+        slot[1] = node->data.frac.denom;
+        return 2;
+    case NODE_EXPONENT:
+        slot[0] = node->data.exp.base;
+        slot[1] = node->data.exp.power;
+        return 2;
+    case NODE_SUBSCRIPT:
+        slot[0] = node->data.subscript.base;
+        slot[1] = node->data.subscript.sub;
+        return 2;
+    case NODE_ROOT:
+        slot[0] = node->data.root.content;
+        return 1;
+    case NODE_NTHROOT:
+        slot[0] = node->data.nthroot.index;
+        slot[1] = node->data.nthroot.content;
+        return 2;
+    case NODE_MIXED_FRAC:
+        slot[0] = node->data.mixed.whole;
+        slot[1] = node->data.mixed.numer;
+        slot[2] = node->data.mixed.denom;
+        return 3;
+    case NODE_ABS:
+        slot[0] = node->data.abs.content;
+        return 1;
+    case NODE_PAREN:
+        slot[0] = node->data.paren.content;
+        return 1;
+    case NODE_FUNCTION:
+        slot[0] = node->data.func.arg;
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/* Count the nodes of a subtree, checking parent and sibling links */
+static int reach(expr_node_t *node)
+{
+    if(!node) return 0;
+    int count = 1;
+
+    if(node->type == NODE_SEQUENCE) {
+        expr_node_t *prev = NULL;
+        for(expr_node_t *c = node->data.seq.first; c; c = c->next) {
+            CHECK(c->parent == node);
+            CHECK(c->prev == prev);
+            prev = c;
+            count += reach(c);
+        }
+        CHECK(node->data.seq.last == prev);
+        return count;
+    }
+
+    expr_node_t *slot[3];
+    int n = slots(node, slot);
+    for(int i = 0; i < n; i++) {
+        CHECK(slot[i] && slot[i]->type == NODE_SEQUENCE);
+        CHECK(slot[i]->parent == node);
+        count += reach(slot[i]);
+    }
+    return count;
+}
+
+/* Check that two subtrees are equal but share no node */
+static bool same(expr_node_t *a, expr_node_t *b)
+{
+    if(a == b || a->type != b->type) return false;
+
+    if(a->type == NODE_TEXT)
+        return a->data.text.subtype == b->data.text.subtype &&
+               !strcmp(a->data.text.text, b->data.text.text);
+    if(a->type == NODE_ROOT && a->data.root.index != b->data.root.index)
+        return false;
+    if(a->type == NODE_FUNCTION &&
+       strcmp(a->data.func.name, b->data.func.name))
+        return false;
+
+    if(a->type == NODE_SEQUENCE) {
+        expr_node_t *x = a->data.seq.first, *y = b->data.seq.first;
+        for(; x && y; x = x->next, y = y->next)
+            if(!same(x, y)) return false;
+        return !x && !y;
+    }
+
+    expr_node_t *sa[3], *sb[3];
+    int n = slots(a, sa);
+    slots(b, sb);
+    for(int i = 0; i < n; i++)
+        if(!same(sa[i], sb[i])) return false;
+    return true;
+}
+
+/* Every used node belongs to exactly one of the root and the clipboard */
+static void check_pool(void)
+{
+    CHECK(reach(expr.root) + reach(expr.clipboard) == count_used());
+}
+
+static const char *latex(void)
+{
+    static char buf[MAX_LATEX];
+    math2_out_t out;
+    math2_out_init(&out, buf, sizeof buf);
+    math2_write_latex(&out, expr.root, LATEX_VERBOSE);
+    return buf;
+}
+
+/* ===== Tests ===== */
+
+static void test_clone(void)
+{
+    int used = count_used();
+
+    for(expr_node_t *c = expr.root->data.seq.first; c; c = c->next) {
+        expr_node_t *copy = math2_clone(&expr, c);
+        CHECK(copy != NULL);
+        if(!copy) continue;
+        CHECK(!copy->parent && !copy->next && !copy->prev);
+        CHECK(same(c, copy));
+        CHECK(reach(copy) == reach(c));
+        math2_free_node(&expr, copy);
+    }
+    CHECK(count_used() == used);
+}
+
+static void test_clipboard(void)
+{
+    int used = count_used();
+    char original[MAX_LATEX];
+    strcpy(original, latex());
+
+    /* Copy everything, then paste it twice at the end */
+    expr.cursor.sequence = expr.root;
+    expr.cursor.after = NULL;
+    math2_select_start(&expr);
+    while(cursor_right(&expr)) {}
+
+    expr_node_t *first, *last;
+    CHECK(math2_get_selection(&expr, &first, &last));
+    CHECK(math2_copy(&expr));
+    CHECK(count_used() == 2 * used);
+    CHECK(same(expr.root, expr.clipboard));
+    math2_select_end(&expr);
+
+    CHECK(math2_paste(&expr));
+    CHECK(math2_paste(&expr));
+    char tripled[3 * MAX_LATEX];
+    snprintf(tripled, sizeof tripled, "%s%s%s", original, original, original);
+    CHECK(!strcmp(latex(), tripled));
+    check_pool();
+
+    /* Cut the last three nodes */
+    int root_nodes = reach(expr.root);
+    math2_select_start(&expr);
+    cursor_left(&expr);
+    cursor_left(&expr);
+    cursor_left(&expr);
+    CHECK(math2_cut(&expr));
+    CHECK(reach(expr.root) < root_nodes);
+    check_pool();
+
+    /* Paste until the pool is full; a paste that doesn't fit must not use
+       any node */
+    int pastes = 0;
+    while(math2_paste(&expr)) pastes++;
+    check_pool();
+    CHECK(pastes > 0);
+    CHECK(count_used() + reach(expr.clipboard) > MAX_NODES);
+
+    /* Clearing keeps the clipboard */
+    math2_clear(&expr);
+    CHECK(count_used() == 1 + reach(expr.clipboard));
+    CHECK(math2_paste(&expr));
+    check_pool();
+}
+
+/* ===== Main ===== */
+
+int main(void)
+{
+    math2_init(&expr);
+    type(&expr, "1\\f2\\v\\rx\\>\\>+\\m3\\n1\\n4\\>-y\\^2\\>+a\\_k\\>"
+        "\\x5\\n8\\>\\*\\a-1\\>\\/\\(a+b\\>=\\sx\\>\\l\\p\\>\\3\\t");
+    printf("tree: %s\n", latex());
+    check_pool();
+
+    test_clone();
+    test_clipboard();
+
+    if(errors) {
+        printf("%d error(s)\n", errors);
+        return 1;
+    }
+    printf("Clones and clipboard operations are consistent\n");
+    return 0;
+}
@@ -0,0 +1,214 @@
+/*
+ * eval-bench.c - Host benchmark for the math2 evaluator
+ *
+ * Builds a few expression trees by hand, checks their values, and measures
+ * how many compilations and runs per second math2-eval.c manages. It is not
+ * part of the add-in; build it on the host with:
+ *
+ *   cc -O2 -o eval-bench eval-bench.c math2-eval.c bigdec.c -lm
+ */
+
+#include "math2-eval.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* ===== Tree Construction ===== */
+
+static expr_node_t pool[MAX_NODES];
+static int pool_used;
+
+static expr_node_t *node(node_type_t type)
+{
+    expr_node_t *n = &pool[pool_used++];
+    memset(n, 0, sizeof(*n));
+    n->type = type;
+    return n;
+}
+
+static void append(expr_node_t *seq, expr_node_t *n)
+{
+    n->parent = seq;
+    n->prev = seq->data.seq.last;
+    if(seq->data.seq.last) seq->data.seq.last->next = n;
+    else seq->data.seq.first = n;
+    seq->data.seq.last = n;
+}
+
+static expr_node_t *seq(void)
+{
+    return node(NODE_SEQUENCE);
+}
+
+/* Append one text node per character, or per UTF-8 symbol */
+static void text(expr_node_t *s, text_type_t subtype, const char *str)
+{
+    expr_node_t *n = node(NODE_TEXT);
+    n->data.text.subtype = subtype;
+    strncpy(n->data.text.text, str, sizeof(n->data.text.text) - 1);
+    append(s, n);
+}
+
+static void digits(expr_node_t *s, const char *str)
+{
+    for(; *str; str++) {
+        char c[2] = { *str, 0 };
+        text(s, TEXT_NUMBER, c);
+    }
+}
+
+static void op(expr_node_t *s, const char *str)
+{
+    text(s, TEXT_OPERATOR, str);
+}
+
+static expr_node_t *frac(expr_node_t *s, expr_node_t **numer,
+                         expr_node_t **denom)
+{
+    expr_node_t *n = node(NODE_FRACTION);
+    n->data.frac.numer = *numer = seq();
+    n->data.frac.denom = *denom = seq();
+    (*numer)->parent = (*denom)->parent = n;
+    append(s, n);
+    return n;
+}
+
+static void power(expr_node_t *s, expr_node_t **base, expr_node_t **pow)
+{
+    expr_node_t *n = node(NODE_EXPONENT);
+    n->data.exp.base = *base = seq();
+    n->data.exp.power = *pow = seq();
+    (*base)->parent = (*pow)->parent = n;
+    append(s, n);
+}
+
+static expr_node_t *sqrt_of(expr_node_t *s)
+{
+    expr_node_t *n = node(NODE_ROOT);
+    n->data.root.index = 2;
+    n->data.root.content = seq();
+    n->data.root.content->parent = n;
+    append(s, n);
+    return n->data.root.content;
+}
+
+static expr_node_t *function(expr_node_t *s, const char *name)
+{
+    expr_node_t *n = node(NODE_FUNCTION);
+    strcpy(n->data.func.name, name);
+    n->data.func.arg = seq();
+    n->data.func.arg->parent = n;
+    append(s, n);
+    return n->data.func.arg;
+}
+
+/* ===== Test Expressions ===== */
+
+/* 12² + 3/4 - √2 */
+static expr_node_t *build_numeric(void)
+{
+    expr_node_t *root = seq(), *a, *b;
+    digits(root, "1");
+    power(root, &a, &b);
+    digits(a, "2");
+    digits(b, "2");
+    op(root, "+");
+    frac(root, &a, &b);
+    digits(a, "3");
+    digits(b, "4");
+    op(root, "-");
+    digits(sqrt_of(root), "2");
+    return root;
+}
+
+/* (x² + 1) / (2x) × sin(πx) + √(x + 3) */
+static expr_node_t *build_variable(void)
+{
+    expr_node_t *root = seq(), *numer, *denom, *a, *b;
+    frac(root, &numer, &denom);
+    power(numer, &a, &b);
+    text(a, TEXT_VARIABLE, "x");
+    digits(b, "2");
+    op(numer, "+");
+    digits(numer, "1");
+    digits(denom, "2");
+    text(denom, TEXT_VARIABLE, "x");
+    op(root, "×");
+    expr_node_t *arg = function(root, "sin");
+    text(arg, TEXT_PI, "π");
+    text(arg, TEXT_VARIABLE, "x");
+    op(root, "+");
+    expr_node_t *r = sqrt_of(root);
+    text(r, TEXT_VARIABLE, "x");
+    op(r, "+");
+    digits(r, "3");
+    return root;
+}
+
+static double reference(double x)
+{
+    return (x * x + 1) / (2 * x) * sin(3.14159265358979323846 * x) +
+           sqrt(x + 3);
+}
+
+/* ===== Benchmark ===== */
+
+static double seconds(void)
+{
+    return (double)clock() / CLOCKS_PER_SEC;
+}
+
+int main(void)
+{
+    math2_program_t prog;
+    double vars[EVAL_VARS] = { 0 };
+    int x = math2_var_index("x");
+    double value;
+    char buf[32];
+    int errors = 0;
+
+    expr_node_t *numeric = build_numeric();
+    expr_node_t *variable = build_variable();
+
+    /* Values */
+    math2_compile(&prog, numeric);
+    math2_run(&prog, NULL, &value);
+    math2_format_number(value, buf, sizeof(buf));
+    printf("12^2 + 3/4 - sqrt(2) = %s (%d bytes)\n", buf, prog.len);
+    errors += fabs(value - (144.75 - sqrt(2))) > 1e-12;
+
+    math2_compile(&prog, variable);
+    printf("variable expression: %d bytes, %d constants\n", prog.len,
+           prog.nconsts);
+    for(vars[x] = 0.5; vars[x] < 3; vars[x] += 0.5) {
+        math2_run(&prog, vars, &value);
+        errors += fabs(value - reference(vars[x])) > 1e-12;
+    }
+
+    /* Speed */
+    int n = 0;
+    double start = seconds(), elapsed;
+    do {
+        for(int i = 0; i < 1000; i++) math2_compile(&prog, variable);
+        n += 1000;
+    } while((elapsed = seconds() - start) < 1);
+    printf("compile: %.0f per second\n", n / elapsed);
+
+    math2_compile(&prog, variable);
+    n = 0;
+    double sum = 0;
+    start = seconds();
+    do {
+        for(int i = 0; i < 10000; i++) {
+            vars[x] = 1 + i * 1e-4;
+            math2_run(&prog, vars, &value);
+            sum += value;
+        }
+        n += 10000;
+    } while((elapsed = seconds() - start) < 1);
+    printf("run: %.0f per second (checksum %g)\n", n / elapsed, sum);
+
+    if(errors) printf("%d wrong values\n", errors);
+    return errors != 0;
+}
@@ -0,0 +1,306 @@
+/*
+ * format-test.c - Host golden output test for math2-format.c
+ *
+ * Builds expressions with the editing functions of math2.c and compares
+ * their LaTeX, AsciiMath, UnicodeMath and MathML output, in the compact and
+ * verbose variants, with known-good strings. Update the strings only after checking
+ * the new output in the target apps. It is not part of the add-in; build it
+ * on the host with (the gint build directory provides the generated
+ * <gint/config.h>):
+ *
+ *   cc -O2 -I../build-cg/include -I../include -DFXCG50 -o format-test \
+ *      format-test.c math2-format.c math2.c host-stubs.c host-type.c
+ */
+
+#include "math2-format.h"
+#include "host-type.h"
+#include <stdio.h>
+#include <string.h>
+
+/* ===== Expected Output ===== */
+
+static const struct {
+    const char *script;         /* Editing script for type() */
+    math2_format_id_t format;
+    bool compact;
+    const char *expected;
+} tests[] = {
+    { "x\\^2\\>+2x+1", FORMAT_ASCIIMATH, true,
+      "x^2+2x+1" },
+    { "x\\^2\\>+2x+1", FORMAT_ASCIIMATH, false,
+      "x^(2)+2x+1" },
+    { "x\\^2\\>+2x+1", FORMAT_UNICODEMATH, true,
+      "x^2+2x+1" },
+    { "x\\^2\\>+2x+1", FORMAT_UNICODEMATH, false,
+      "x^(2)+2x+1" },
+    { "x\\^2\\>+2x+1", FORMAT_MATHML, true,
+      "<math><msup><mi>x</mi><mn>2</mn></msup><mo>+</mo><mn>2</mn><mi>x"
+      "</mi><mo>+</mo><mn>1</mn></math>" },
+    { "x\\^2\\>+2x+1", FORMAT_MATHML, false,
+      "<math xmlns=\"http://www.w3.org/1998/Math/MathML\"><msup><mrow>"
+      "<mi>x</mi></mrow><mrow><mn>2</mn></mrow></msup><mo>+</mo><mn>2"
+      "</mn><mi>x</mi><mo>+</mo><mn>1</mn></math>" },
+    { "\\f1\\v2", FORMAT_ASCIIMATH, true,
+      "1/2" },
+    { "\\f1\\v2", FORMAT_ASCIIMATH, false,
+      "(1)/(2)" },
+    { "\\f1\\v2", FORMAT_UNICODEMATH, true,
+      "1/2" },
+    { "\\f1\\v2", FORMAT_UNICODEMATH, false,
+      "(1)/(2)" },
+    { "\\f1\\v2", FORMAT_MATHML, true,
+      "<math><mfrac><mn>1</mn><mn>2</mn></mfrac></math>" },
+    { "\\fx+1\\v2y", FORMAT_ASCIIMATH, true,
+      "(x+1)/(2y)" },
+    { "\\fx+1\\v2y", FORMAT_ASCIIMATH, false,
+      "(x+1)/(2y)" },
+    { "\\fx+1\\v2y", FORMAT_UNICODEMATH, true,
+      "(x+1)/(2y)" },
+    { "\\fx+1\\v2y", FORMAT_UNICODEMATH, false,
+      "(x+1)/(2y)" },
+    { "\\fx+1\\v2y", FORMAT_MATHML, true,
+      "<math><mfrac><mrow><mi>x</mi><mo>+</mo><mn>1</mn></mrow><mrow>"
+      "<mn>2</mn><mi>y</mi></mrow></mfrac></math>" },
+    { "\\r2", FORMAT_ASCIIMATH, true,
+      "sqrt 2" },
+    { "\\r2", FORMAT_ASCIIMATH, false,
+      "sqrt(2)" },
+    { "\\r2", FORMAT_UNICODEMATH, true,
+      "\\sqrt 2" },
+    { "\\r2", FORMAT_UNICODEMATH, false,
+      "\\sqrt(2)" },
+    { "\\r2", FORMAT_MATHML, true,
+      "<math><msqrt><mn>2</mn></msqrt></math>" },
+    { "\\rx+1", FORMAT_ASCIIMATH, true,
+      "sqrt(x+1)" },
+    { "\\rx+1", FORMAT_ASCIIMATH, false,
+      "sqrt(x+1)" },
+    { "\\rx+1", FORMAT_UNICODEMATH, true,
+      "\\sqrt(x+1)" },
+    { "\\rx+1", FORMAT_UNICODEMATH, false,
+      "\\sqrt(x+1)" },
+    { "\\rx+1", FORMAT_MATHML, true,
+      "<math><msqrt><mi>x</mi><mo>+</mo><mn>1</mn></msqrt></math>" },
+    { "\\3x", FORMAT_ASCIIMATH, true,
+      "root3 x" },
+    { "\\3x", FORMAT_ASCIIMATH, false,
+      "root(3)(x)" },
+    { "\\3x", FORMAT_UNICODEMATH, true,
+      "\\sqrt(3&x)" },
+    { "\\3x", FORMAT_UNICODEMATH, false,
+      "\\sqrt(3&x)" },
+    { "\\3x", FORMAT_MATHML, true,
+      "<math><mroot><mi>x</mi><mn>3</mn></mroot></math>" },
+    { "\\xn\\vx", FORMAT_ASCIIMATH, true,
+      "root n x" },
+    { "\\xn\\vx", FORMAT_ASCIIMATH, false,
+      "root(n)(x)" },
+    { "\\xn\\vx", FORMAT_UNICODEMATH, true,
+      "\\sqrt(n&x)" },
+    { "\\xn\\vx", FORMAT_UNICODEMATH, false,
+      "\\sqrt(n&x)" },
+    { "\\xn\\vx", FORMAT_MATHML, true,
+      "<math><mroot><mi>x</mi><mi>n</mi></mroot></math>" },
+    { "\\xn\\vx", FORMAT_MATHML, false,
+      "<math xmlns=\"http://www.w3.org/1998/Math/MathML\"><mroot><mrow>"
+      "<mi>x</mi></mrow><mrow><mi>n</mi></mrow></mroot></math>" },
+    { "\\a-3", FORMAT_ASCIIMATH, true,
+      "|-3|" },
+    { "\\a-3", FORMAT_ASCIIMATH, false,
+      "|-3|" },
+    { "\\a-3", FORMAT_UNICODEMATH, true,
+      "|-3|" },
+    { "\\a-3", FORMAT_UNICODEMATH, false,
+      "|-3|" },
+    { "\\a-3", FORMAT_MATHML, true,
+      "<math><mrow><mo>|</mo><mo>-</mo><mn>3</mn><mo>|</mo></mrow>"
+      "</math>" },
+    { "\\(a+b\\>\\^2", FORMAT_ASCIIMATH, true,
+      "((a+b))^2" },
+    { "\\(a+b\\>\\^2", FORMAT_ASCIIMATH, false,
+      "((a+b))^(2)" },
+    { "\\(a+b\\>\\^2", FORMAT_UNICODEMATH, true,
+      "((a+b))^2" },
+    { "\\(a+b\\>\\^2", FORMAT_UNICODEMATH, false,
+      "((a+b))^(2)" },
+    { "\\(a+b\\>\\^2", FORMAT_MATHML, true,
+      "<math><msup><mrow><mo>(</mo><mi>a</mi><mo>+</mo><mi>b</mi><mo>)"
+      "</mo></mrow><mn>2</mn></msup></math>" },
+    { "\\sx", FORMAT_ASCIIMATH, true,
+      "sin(x)" },
+    { "\\sx", FORMAT_ASCIIMATH, false,
+      "sin(x)" },
+    { "\\sx", FORMAT_UNICODEMATH, true,
+      "sin(x)" },
+    { "\\sx", FORMAT_UNICODEMATH, false,
+      "sin(x)" },
+    { "\\sx", FORMAT_MATHML, true,
+      "<math><mrow><mi>sin</mi><mrow><mo>(</mo><mi>x</mi><mo>)</mo>"
+      "</mrow></mrow></math>" },
+    { "\\sx", FORMAT_MATHML, false,
+      "<math xmlns=\"http://www.w3.org/1998/Math/MathML\"><mrow><mi>sin"
+      "</mi><mo>&#x2061;</mo><mrow><mo>(</mo><mi>x</mi><mo>)</mo></mrow>"
+      "</mrow></math>" },
+    { "\\s\\px\\>", FORMAT_ASCIIMATH, true,
+      "sin(pi x)" },
+    { "\\s\\px\\>", FORMAT_ASCIIMATH, false,
+      "sin(pi x)" },
+    { "\\s\\px\\>", FORMAT_UNICODEMATH, true,
+      "sin(\\pi x)" },
+    { "\\s\\px\\>", FORMAT_UNICODEMATH, false,
+      "sin(\\pi x)" },
+    { "\\s\\px\\>", FORMAT_MATHML, true,
+      "<math><mrow><mi>sin</mi><mrow><mo>(</mo><mi>&#x3C0;</mi><mi>x"
+      "</mi><mo>)</mo></mrow></mrow></math>" },
+    { "\\l\\fa\\vb", FORMAT_ASCIIMATH, true,
+      "ln(a/b)" },
+    { "\\l\\fa\\vb", FORMAT_ASCIIMATH, false,
+      "ln((a)/(b))" },
+    { "\\l\\fa\\vb", FORMAT_UNICODEMATH, true,
+      "ln(a/b)" },
+    { "\\l\\fa\\vb", FORMAT_UNICODEMATH, false,
+      "ln((a)/(b))" },
+    { "\\l\\fa\\vb", FORMAT_MATHML, true,
+      "<math><mrow><mi>ln</mi><mrow><mo>(</mo><mfrac><mi>a</mi><mi>b"
+      "</mi></mfrac><mo>)</mo></mrow></mrow></math>" },
+    { "a\\_n+1", FORMAT_ASCIIMATH, true,
+      "a_(n+1)" },
+    { "a\\_n+1", FORMAT_ASCIIMATH, false,
+      "a_(n+1)" },
+    { "a\\_n+1", FORMAT_UNICODEMATH, true,
+      "a_(n+1)" },
+    { "a\\_n+1", FORMAT_UNICODEMATH, false,
+      "a_(n+1)" },
+    { "a\\_n+1", FORMAT_MATHML, true,
+      "<math><msub><mi>a</mi><mrow><mi>n</mi><mo>+</mo><mn>1</mn></mrow>"
+      "</msub></math>" },
+    { "\\m1\\n2\\n3", FORMAT_ASCIIMATH, true,
+      "1 2/3" },
+    { "\\m1\\n2\\n3", FORMAT_ASCIIMATH, false,
+      "1(2)/(3)" },
+    { "\\m1\\n2\\n3", FORMAT_UNICODEMATH, true,
+      "1 2/3" },
+    { "\\m1\\n2\\n3", FORMAT_UNICODEMATH, false,
+      "1(2)/(3)" },
+    { "\\m1\\n2\\n3", FORMAT_MATHML, true,
+      "<math><mrow><mn>1</mn><mfrac><mn>2</mn><mn>3</mn></mfrac></mrow>"
+      "</math>" },
+    { "2\\*3\\/4", FORMAT_ASCIIMATH, true,
+      "2xx3-:4" },
+    { "2\\*3\\/4", FORMAT_ASCIIMATH, false,
+      "2xx3-:4" },
+    { "2\\*3\\/4", FORMAT_UNICODEMATH, true,
+      "2\\times3\\div4" },
+    { "2\\*3\\/4", FORMAT_UNICODEMATH, false,
+      "2\\times3\\div4" },
+    { "2\\*3\\/4", FORMAT_MATHML, true,
+      "<math><mn>2</mn><mo>&#xD7;</mo><mn>3</mn><mo>&#xF7;</mo><mn>4"
+      "</mn></math>" },
+    { "\\p\\t", FORMAT_ASCIIMATH, true,
+      "pi theta" },
+    { "\\p\\t", FORMAT_ASCIIMATH, false,
+      "pi theta" },
+    { "\\p\\t", FORMAT_UNICODEMATH, true,
+      "\\pi\\theta" },
+    { "\\p\\t", FORMAT_UNICODEMATH, false,
+      "\\pi\\theta" },
+    { "\\p\\t", FORMAT_LATEX, true,
+      "\\pi\\theta" },
+    { "\\p\\t", FORMAT_LATEX, false,
+      "\\pi \\theta " },
+    { "\\tx\\^\\t", FORMAT_LATEX, true,
+      "\\theta x^\\theta" },
+    { "\\p\\t", FORMAT_MATHML, true,
+      "<math><mi>&#x3C0;</mi><mi>&#x3B8;</mi></math>" },
+    { "\\pr\\^2", FORMAT_ASCIIMATH, true,
+      "pi r^2" },
+    { "\\pr\\^2", FORMAT_ASCIIMATH, false,
+      "pi r^(2)" },
+    { "\\pr\\^2", FORMAT_UNICODEMATH, true,
+      "\\pi r^2" },
+    { "\\pr\\^2", FORMAT_UNICODEMATH, false,
+      "\\pi r^(2)" },
+    { "\\pr\\^2", FORMAT_MATHML, true,
+      "<math><mi>&#x3C0;</mi><msup><mi>r</mi><mn>2</mn></msup></math>" },
+    { "x\\^\\f1\\v2", FORMAT_ASCIIMATH, true,
+      "x^(1/2)" },
+    { "x\\^\\f1\\v2", FORMAT_ASCIIMATH, false,
+      "x^((1)/(2))" },
+    { "x\\^\\f1\\v2", FORMAT_UNICODEMATH, true,
+      "x^(1/2)" },
+    { "x\\^\\f1\\v2", FORMAT_UNICODEMATH, false,
+      "x^((1)/(2))" },
+    { "x\\^\\f1\\v2", FORMAT_MATHML, true,
+      "<math><msup><mi>x</mi><mfrac><mn>1</mn><mn>2</mn></mfrac></msup>"
+      "</math>" },
+    { "e\\^i\\p\\>+1=0", FORMAT_ASCIIMATH, true,
+      "e^(i pi)+1=0" },
+    { "e\\^i\\p\\>+1=0", FORMAT_ASCIIMATH, false,
+      "e^(i pi)+1=0" },
+    { "e\\^i\\p\\>+1=0", FORMAT_UNICODEMATH, true,
+      "e^(i\\pi)+1=0" },
+    { "e\\^i\\p\\>+1=0", FORMAT_UNICODEMATH, false,
+      "e^(i\\pi)+1=0" },
+    { "e\\^i\\p\\>+1=0", FORMAT_MATHML, true,
+      "<math><msup><mi>e</mi><mrow><mi>i</mi><mi>&#x3C0;</mi></mrow>"
+      "</msup><mo>+</mo><mn>1</mn><mo>=</mo><mn>0</mn></math>" },
+    { "\\f\\f1\\v2\\>\\>\\v3", FORMAT_ASCIIMATH, true,
+      "(1/2)/3" },
+    { "\\f\\f1\\v2\\>\\>\\v3", FORMAT_ASCIIMATH, false,
+      "((1)/(2))/(3)" },
+    { "\\f\\f1\\v2\\>\\>\\v3", FORMAT_UNICODEMATH, true,
+      "(1/2)/3" },
+    { "\\f\\f1\\v2\\>\\>\\v3", FORMAT_UNICODEMATH, false,
+      "((1)/(2))/(3)" },
+    { "\\f\\f1\\v2\\>\\>\\v3", FORMAT_MATHML, true,
+      "<math><mfrac><mfrac><mn>1</mn><mn>2</mn></mfrac><mn>3</mn>"
+      "</mfrac></math>" },
+    { "1.5x", FORMAT_ASCIIMATH, true,
+      "1.5x" },
+    { "1.5x", FORMAT_ASCIIMATH, false,
+      "1.5x" },
+    { "1.5x", FORMAT_UNICODEMATH, true,
+      "1.5x" },
+    { "1.5x", FORMAT_UNICODEMATH, false,
+      "1.5x" },
+    { "1.5x", FORMAT_MATHML, true,
+      "<math><mn>1.5</mn><mi>x</mi></math>" },
+    { "x\\^n+1\\>", FORMAT_ASCIIMATH, true,
+      "x^(n+1)" },
+    { "x\\^n+1\\>", FORMAT_ASCIIMATH, false,
+      "x^(n+1)" },
+    { "x\\^n+1\\>", FORMAT_UNICODEMATH, true,
+      "x^(n+1)" },
+    { "x\\^n+1\\>", FORMAT_UNICODEMATH, false,
+      "x^(n+1)" },
+    { "x\\^n+1\\>", FORMAT_MATHML, true,
+      "<math><msup><mi>x</mi><mrow><mi>n</mi><mo>+</mo><mn>1</mn></mrow>"
+      "</msup></math>" },
+};
+
+/* ===== Main ===== */
+
+int main(void)
+{
+    static math_expr2_t expr;
+    int count = sizeof tests / sizeof *tests;
+    int errors = 0;
+
+    math2_init(&expr);
+    for(int i = 0; i < count; i++) {
+        math2_clear(&expr);
+        type(&expr, tests[i].script);
+        math2_to_format(&expr, tests[i].format, tests[i].compact);
+
+        if(strcmp(expr.latex, tests[i].expected)) {
+            printf("FAIL: %s (%s, %s)\n  expected: %s\n  got:      %s\n",
+                tests[i].script, math2_formats[tests[i].format].name,
+                tests[i].compact ? "compact" : "verbose", tests[i].expected,
+                expr.latex);
+            errors++;
+        }
+    }
+
+    printf("%d/%d outputs match\n", count - errors, count);
+    return errors != 0;
+}
@@ -0,0 +1,104 @@
+/*
+ * host-stubs.c - Drawing stubs to run math2.c on a host
+ *
+ * The host test programs use the tree, layout and LaTeX functions of math2.c
+ * but never look at the screen, so the gint functions it draws with do
+ * nothing here. The gint headers are still needed for the declarations; see
+ * the build lines in the test programs.
+ */
+
+#include <gint/display.h>
+#include <gint/image.h>
+#include <stdlib.h>
+
+#define HOST_DWIDTH 396
+#define HOST_DHEIGHT 224
+
+static uint16_t host_vram[HOST_DWIDTH * HOST_DHEIGHT];
+uint16_t *gint_vram = host_vram;
+
+struct dwindow dwindow = { 0, 0, HOST_DWIDTH, HOST_DHEIGHT };
+
+struct dwindow dwindow_set(struct dwindow new_mode)
+{
+    struct dwindow old_mode = dwindow;
+    dwindow = new_mode;
+    return old_mode;
+}
+
+void drect(int x1, int y1, int x2, int y2, int color)
+{
+    (void)x1; (void)y1; (void)x2; (void)y2; (void)color;
+}
+
+void drect_border(int x1, int y1, int x2, int y2, int fill_color,
+    int border_width, int border_color)
+{
+    (void)x1; (void)y1; (void)x2; (void)y2;
+    (void)fill_color; (void)border_width; (void)border_color;
+}
+
+void dpixel(int x, int y, int color)
+{
+    (void)x; (void)y; (void)color;
+}
+
+void dline(int x1, int y1, int x2, int y2, int color)
+{
+    (void)x1; (void)y1; (void)x2; (void)y2; (void)color;
+}
+
+void dtext(int x, int y, int fg, char const *str)
+{
+    (void)x; (void)y; (void)fg; (void)str;
+}
+
+void dimage(int x, int y, bopti_image_t const *image)
+{
+    (void)x; (void)y; (void)image;
+}
+
+image_t *image_alloc(int width, int height, int format)
+{
+    image_t *img = calloc(1, sizeof *img);
+    if(!img) return NULL;
+    img->format = format;
+    img->width = width;
+    img->height = height;
+    img->stride = (width * 2 + 3) & ~3;
+    img->data = calloc(height, img->stride);
+    return img;
+}
+
+image_t *image_create_vram(void)
+{
+    image_t *img = calloc(1, sizeof *img);
+    if(!img) return NULL;
+    img->width = HOST_DWIDTH;
+    img->height = HOST_DHEIGHT;
+    img->stride = HOST_DWIDTH * 2;
+    img->data = host_vram;
+    return img;
+}
+
+void image_free(image_t *img)
+{
+    if(img && img->data != host_vram) free(img->data);
+    free(img);
+}
+
+/* Parenthesized because <gint/image.h> wraps it in a macro */
+image_t *(image_sub)(image_t const *src, int x, int y, int w, int h,
+    image_t *dst)
+{
+    static image_t sub;
+    (void)x; (void)y; (void)w; (void)h;
+    if(!dst) dst = &sub;
+    *dst = *src;
+    return dst;
+}
+
+void image_copy(image_t const *src, image_t *dst, bool copy_alpha)
+{
+    (void)src; (void)dst; (void)copy_alpha;
+}
@@ -0,0 +1,51 @@
+/*
+ * host-type.c - Editing scripts for the host test programs
+ *
+ * Shared by the host tests that build expressions with the editing
+ * functions of math2.c; see the build lines in the test programs.
+ */
+
+#include "host-type.h"
+
+void type(math_expr2_t *e, const char *script)
+{
+    for(const char *p = script; *p; p++) {
+        char c[2] = { *p, 0 };
+
+        if((*p >= '0' && *p <= '9') || *p == '.') {
+            math2_insert_text(e, TEXT_NUMBER, c);
+            continue;
+        }
+        if((*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z')) {
+            math2_insert_text(e, TEXT_VARIABLE, c);
+            continue;
+        }
+        if(*p != '\\') {
+            math2_insert_text(e, TEXT_OPERATOR, c);
+            continue;
+        }
+
+        switch(*++p) {
+        case 'f': math2_insert_fraction(e); break;
+        case '^': math2_insert_exponent(e); break;
+        case '_': math2_insert_subscript(e); break;
+        case 'r': math2_insert_sqrt(e); break;
+        case '3': math2_insert_nthroot(e, 3); break;
+        case 'x': math2_insert_xthroot(e); break;
+        case 'm': math2_insert_mixed_frac(e); break;
+        case 'a': math2_insert_abs(e); break;
+        case '(': math2_insert_paren(e); break;
+        case 's': math2_insert_function(e, "sin"); break;
+        case 'l': math2_insert_function(e, "ln"); break;
+        case 'p': math2_insert_text(e, TEXT_PI, "π"); break;
+        case 't': math2_insert_text(e, TEXT_VARIABLE, "θ"); break;
+        case '*': math2_insert_text(e, TEXT_OPERATOR, "×"); break;
+        case '/': math2_insert_text(e, TEXT_OPERATOR, "÷"); break;
+        case '>': cursor_exit_right(e); break;
+        case 'v': if(!cursor_down(e)) cursor_next_slot(e); break;
+        case 'n': cursor_next_slot(e); break;
+        case '<': cursor_left(e); break;
+        case 0: return;
+        }
+    }
+}
@@ -0,0 +1,21 @@
+/*
+ * host-type.h - Editing scripts for the host test programs
+ *
+ * The host tests build their expressions by replaying what a user would
+ * type, written as a short script; see host-type.c.
+ */
+
+#ifndef MATH2_HOST_TYPE_H
+#define MATH2_HOST_TYPE_H
+
+#include "math2.h"
+
+/* Run an editing script: plain characters are typed as numbers, variables
+   or operators, and '\' introduces a structure or cursor command:
+     \f fraction   \^ exponent   \_ subscript  \r sqrt      \3 cube root
+     \x nth root   \m mixed frac \a abs        \( parens    \s sin  \l ln
+     \p pi         \t theta      \* times      \/ divide
+     \> exit right \v down or next slot        \n next slot \< left */
+void type(math_expr2_t *e, const char *script);
+
+#endif /* MATH2_HOST_TYPE_H */
@@ -0,0 +1,236 @@
+/*
+ * latex-diff-check.c - Host replay checker for latex-diff.c
+ *
+ * Generates pairs of strings related by random edits, replays the script
+ * that latex_diff() produces for each pair on a model of a PC text field,
+ * and checks that it yields the new text with the cursor at the end. It also
+ * reports how many keys the scripts save over retyping everything. It is not
+ * part of the add-in; build it on the host with (the gint build directory
+ * provides the generated <gint/config.h>):
+ *
+ *   cc -O2 -I../build-cg/include -I../include -DFXCG50 \
+ *      -o latex-diff-check latex-diff-check.c latex-diff.c
+ *
+ * Usage: latex-diff-check [pairs]
+ */
+
+#include "latex-diff.h"
+#include "usb-hid-kbd.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_TEXT 160
+
+static int errors;
+
+/* ===== Text Field Model ===== */
+
+/* A single-line text field with a cursor and an optional select-all */
+typedef struct {
+    char text[2 * MAX_TEXT + 1];
+    int len, cursor;
+    bool all_selected;
+} field_t;
+
+static void field_set(field_t *f, const char *text)
+{
+    strcpy(f->text, text);
+    f->len = strlen(text);
+    f->cursor = f->len;
+    f->all_selected = false;
+}
+
+/* Replacing or removing the selection empties the field */
+static bool field_drop_selection(field_t *f)
+{
+    if(!f->all_selected) return false;
+    f->all_selected = false;
+    f->len = f->cursor = 0;
+    f->text[0] = 0;
+    return true;
+}
+
+static void field_key(field_t *f, char c)
+{
+    switch(c) {
+    case HID_CHAR_SELECT_ALL:
+        f->all_selected = f->len > 0;
+        return;
+    case HID_CHAR_BACKSPACE:
+        if(field_drop_selection(f) || f->cursor == 0) return;
+        memmove(f->text + f->cursor - 1, f->text + f->cursor,
+            f->len - f->cursor + 1);
+        f->cursor--;
+        f->len--;
+        return;
+    case HID_CHAR_DELETE:
+        if(field_drop_selection(f) || f->cursor == f->len) return;
+        memmove(f->text + f->cursor, f->text + f->cursor + 1,
+            f->len - f->cursor);
+        f->len--;
+        return;
+    }
+
+    /* Cursor keys collapse the selection like in most text fields */
+    if(f->all_selected && (c == HID_CHAR_LEFT || c == HID_CHAR_HOME)) {
+        f->all_selected = false;
+        f->cursor = 0;
+        return;
+    }
+    if(f->all_selected && (c == HID_CHAR_RIGHT || c == HID_CHAR_END)) {
+        f->all_selected = false;
+        f->cursor = f->len;
+        return;
+    }
+
+    switch(c) {
+    case HID_CHAR_LEFT:  if(f->cursor > 0) f->cursor--; return;
+    case HID_CHAR_RIGHT: if(f->cursor < f->len) f->cursor++; return;
+    case HID_CHAR_HOME:  f->cursor = 0; return;
+    case HID_CHAR_END:   f->cursor = f->len; return;
+    }
+
+    field_drop_selection(f);
+    if(f->len >= (int)sizeof(f->text) - 1) return;
+    memmove(f->text + f->cursor + 1, f->text + f->cursor,
+        f->len - f->cursor + 1);
+    f->text[f->cursor++] = c;
+    f->len++;
+}
+
+/* ===== Checks ===== */
+
+static long keys_script, keys_retype;
+
+/* Check that the script turns old_text into new_text */
+static void check_pair(const char *old_text, const char *new_text)
+{
+    char script[2 * MAX_TEXT + 8];
+    int n = latex_diff(old_text, new_text, script, sizeof script);
+    if(n < 0) {
+        printf("  FAIL: no script for \"%s\" -> \"%s\"\n", old_text,
+            new_text);
+        errors++;
+        return;
+    }
+
+    field_t f;
+    field_set(&f, old_text);
+    for(int i = 0; script[i]; i++) field_key(&f, script[i]);
+
+    int retype = 1 + (new_text[0] ? (int)strlen(new_text) : 1);
+    if(strcmp(f.text, new_text) || f.cursor != f.len || f.all_selected
+        || n != (int)strlen(script) || n > retype) {
+        printf("  FAIL: \"%s\" -> \"%s\" gave \"%s\" (cursor %d/%d, %d keys"
+            ", retype %d)\n", old_text, new_text, f.text, f.cursor, f.len,
+            n, retype);
+        errors++;
+    }
+    keys_script += n;
+    keys_retype += retype;
+}
+
+static const char alphabet[] = "0123456789+-=()^_{}\\fracsqrtxyz ";
+
+static char random_char(void)
+{
+    return alphabet[rand() % (sizeof alphabet - 1)];
+}
+
+static void random_text(char *buf, int len)
+{
+    for(int i = 0; i < len; i++) buf[i] = random_char();
+    buf[len] = 0;
+}
+
+/* Apply a few insertions, deletions and substitutions */
+static void random_edit(const char *old_text, char *new_text)
+{
+    strcpy(new_text, old_text);
+    int len = strlen(new_text);
+    int edits = 1 + rand() % 4;
+
+    for(int e = 0; e < edits; e++) {
+        int at = len ? rand() % (len + 1) : 0;
+        int kind = rand() % 3;
+        int count = 1 + rand() % ((rand() % 8) ? 3 : 70);
+
+        if(kind == 0 && len + count <= MAX_TEXT) {
+            memmove(new_text + at + count, new_text + at, len - at + 1);
+            for(int i = 0; i < count; i++) new_text[at + i] = random_char();
+            len += count;
+        }
+        else if(kind == 1 && at < len) {
+            if(count > len - at) count = len - at;
+            memmove(new_text + at, new_text + at + count,
+                len - at - count + 1);
+            len -= count;
+        }
+        else if(at < len) {
+            new_text[at] = random_char();
+        }
+    }
+}
+
+static void test_fixed(void)
+{
+    static const char *pairs[][2] = {
+        { "", "" },
+        { "", "x" },
+        { "x", "" },
+        { "x^{2}", "x^{2}" },
+        { "x^{2}+1", "x^{3}+1" },
+        { "\\frac{1}{2}", "\\frac{1}{3}" },
+        { "abc", "xabc" },
+        { "abc", "abcx" },
+        { "abc", "xyz" },
+        { "aaaa", "aa" },
+        { "abab", "baba" },
+    };
+    for(size_t i = 0; i < sizeof pairs / sizeof *pairs; i++)
+        check_pair(pairs[i][0], pairs[i][1]);
+
+    /* A change longer than LATEX_DIFF_MAX is deleted and retyped */
+    char a[MAX_TEXT + 1], b[MAX_TEXT + 1];
+    memset(a, 'a', 100); a[100] = 0;
+    memset(b, 'b', 100); b[100] = 0;
+    a[0] = b[0] = a[99] = b[99] = 'x';
+    check_pair(a, b);
+
+    /* A script that doesn't fit in the buffer is an error */
+    char small[4];
+    if(latex_diff("", "hello", small, sizeof small) != -1) {
+        printf("  FAIL: script larger than the buffer\n");
+        errors++;
+    }
+}
+
+/* ===== Main ===== */
+
+int main(int argc, char **argv)
+{
+    long pairs = (argc > 1) ? atol(argv[1]) : 200000;
+    srand(1);
+
+    keys_script = keys_retype = 0;
+    test_fixed();
+
+    keys_script = keys_retype = 0;
+    for(long i = 0; i < pairs; i++) {
+        char old_text[MAX_TEXT + 1], new_text[MAX_TEXT + 1];
+        random_text(old_text, rand() % (MAX_TEXT / 2 + 1));
+        random_edit(old_text, new_text);
+        check_pair(old_text, new_text);
+    }
+
+    printf("%ld random pairs, %.1f%% of the keys of a full retype\n", pairs,
+        keys_retype ? 100.0 * keys_script / keys_retype : 0.0);
+
+    if(errors) {
+        printf("%d error(s)\n", errors);
+        return 1;
+    }
+    printf("All scripts reproduce the new text\n");
+    return 0;
+}
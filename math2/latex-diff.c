@@ -0,0 +1,146 @@
+/*
+ * latex-diff.c - Keystroke edit scripts between two sent strings
+ */
+
+#include "latex-diff.h"
+#include "usb-hid-kbd.h"
+#include <string.h>
+
+/* Alignment costs for suffixes of the middle parts; cost[i][j] is the number
+   of keys needed to turn a[i..] into b[j..] with the cursor before a[i] */
+static unsigned char cost[LATEX_DIFF_MAX + 1][LATEX_DIFF_MAX + 1];
+
+/* Script being written */
+typedef struct {
+    char *buf;
+    int size;
+    int len;
+} script_t;
+
+static void put(script_t *s, char c)
+{
+    if(s->len < s->size - 1) s->buf[s->len] = c;
+    s->len++;
+}
+
+static void put_n(script_t *s, char c, int count)
+{
+    while(count-- > 0) put(s, c);
+}
+
+static void put_str(script_t *s, const char *str, int count)
+{
+    for(int i = 0; i < count; i++) put(s, str[i]);
+}
+
+static int min2(int x, int y)
+{
+    return (x < y) ? x : y;
+}
+
+/* Fill the alignment table for a[0..n] and b[0..m] */
+static void align(const char *a, int n, const char *b, int m)
+{
+    for(int i = n; i >= 0; i--)
+    for(int j = m; j >= 0; j--) {
+        if(i == n) {
+            cost[i][j] = m - j;
+        }
+        else if(j == m) {
+            cost[i][j] = n - i;
+        }
+        else {
+            int c = 1 + min2(cost[i+1][j], cost[i][j+1]);
+            if(a[i] == b[j]) c = min2(c, 1 + cost[i+1][j+1]);
+            cost[i][j] = c;
+        }
+    }
+}
+
+/* Write the keys for the aligned middle parts. Rights over kept characters
+   are only sent when an edit follows them; returns the number of characters
+   left to the right of the cursor. */
+static int edit_aligned(script_t *s, const char *a, int n, const char *b,
+                        int m)
+{
+    int i = 0, j = 0, pending = 0;
+
+    while(i < n || j < m) {
+        if(i < n && j < m && a[i] == b[j] &&
+           cost[i][j] == 1 + cost[i+1][j+1]) {
+            pending++;
+            i++;
+            j++;
+            continue;
+        }
+
+        put_n(s, HID_CHAR_RIGHT, pending);
+        pending = 0;
+
+        if(i < n && (j == m || cost[i][j] == 1 + cost[i+1][j])) {
+            put(s, HID_CHAR_DELETE);
+            i++;
+        }
+        else {
+            put(s, b[j]);
+            j++;
+        }
+    }
+    return pending;
+}
+
+int latex_diff(const char *old_text, const char *new_text, char *script,
+               int size)
+{
+    int old_len = strlen(old_text);
+    int new_len = strlen(new_text);
+    script_t s = { script, size, 0 };
+
+    /* Skip the common prefix and suffix */
+    int p = 0;
+    while(p < old_len && p < new_len && old_text[p] == new_text[p]) p++;
+    int q = 0;
+    while(q < old_len - p && q < new_len - p &&
+          old_text[old_len - 1 - q] == new_text[new_len - 1 - q]) q++;
+
+    const char *a = old_text + p;
+    const char *b = new_text + p;
+    int n = old_len - p - q;
+    int m = new_len - p - q;
+
+    if(n > 0 || m > 0) {
+        /* Move to the start of the change from the end of the text */
+        if(n + q <= 1 + p) {
+            put_n(&s, HID_CHAR_LEFT, n + q);
+        }
+        else {
+            put(&s, HID_CHAR_HOME);
+            put_n(&s, HID_CHAR_RIGHT, p);
+        }
+
+        int right = q;
+        if(n <= LATEX_DIFF_MAX && m <= LATEX_DIFF_MAX) {
+            align(a, n, b, m);
+            right += edit_aligned(&s, a, n, b, m);
+        }
+        else {
+            put_n(&s, HID_CHAR_DELETE, n);
+            put_str(&s, b, m);
+        }
+
+        if(right > 0) put(&s, HID_CHAR_END);
+    }
+
+    /* Select everything and retype if that's not longer */
+    int retype = 1 + (new_len ? new_len : 1);
+    if(s.len >= retype) {
+        s.len = 0;
+        put(&s, HID_CHAR_SELECT_ALL);
+        if(new_len) put_str(&s, new_text, new_len);
+        else put(&s, HID_CHAR_BACKSPACE);
+    }
+
+    if(s.len >= size) return -1;
+    script[s.len] = '\0';
+    return s.len;
+}
@@ -0,0 +1,32 @@
+/*
+ * latex-diff.h - Keystroke edit scripts between two sent strings
+ *
+ * When the same expression is sent again after a small edit, typing the
+ * keys that edit the previous text in place is much faster than retyping
+ * everything. The script is a string where printable characters are typed
+ * and HID_CHAR_* control characters (see usb-hid-kbd.h) stand for cursor
+ * and editing keys.
+ *
+ * Model: the text cursor is at the end of the old text, and every key costs
+ * the same. Common prefix and suffix are skipped, and the middle parts are
+ * aligned with an edit distance where keeping a character costs a Right,
+ * removing one costs a Delete and adding one costs the character. The cursor
+ * is then sent back to the end with End. If this isn't shorter than
+ * selecting everything and retyping, the script does that instead.
+ */
+
+#ifndef LATEX_DIFF_H
+#define LATEX_DIFF_H
+
+/* Maximum length of the changed middle parts for the alignment; longer
+   changes are deleted and retyped as a whole. The alignment table uses
+   (LATEX_DIFF_MAX + 1)^2 bytes of static memory. */
+#define LATEX_DIFF_MAX 64
+
+/* Generate the script that turns old_text into new_text
+   Writes a NUL-terminated script of at most size bytes (including the NUL).
+   Returns the number of keystrokes, or -1 if the script does not fit. */
+int latex_diff(const char *old_text, const char *new_text, char *script,
+               int size);
+
+#endif /* LATEX_DIFF_H */
@@ -0,0 +1,284 @@
+/*
+ * latex-style-test.c - Host test and benchmark for the LaTeX output styles
+ *
+ * Builds random expressions with the editing functions of math2.c and checks
+ * that the compact and verbose LaTeX of each one mean the same thing: both
+ * are parsed with the TeX argument rules into a normal form where every
+ * argument is braced and \left/\right are dropped, and the normal forms must
+ * be equal. The compact form must also never be longer. Then it measures the
+ * size and generation speed of both styles on a corpus of typical
+ * expressions. It is not part of the add-in; build it on the host with (the
+ * gint build directory provides the generated <gint/config.h>):
+ *
+ *   cc -O2 -I../build-cg/include -I../include -DFXCG50 \
+ *      -o latex-style-test latex-style-test.c math2.c host-stubs.c \
+ *      host-type.c
+ *
+ * Usage: latex-style-test [expressions]
+ */
+
+#include "host-type.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static math_expr2_t expr;
+static int errors;
+
+/* ===== Expression Construction ===== */
+
+static const char *random_steps[] = {
+    "1", "2", "7", ".", "x", "y", "k", "+", "-", "=", "\\*", "\\/", "\\p",
+    "\\t", "\\f", "\\^", "\\_", "\\r", "\\3", "\\x", "\\m", "\\a", "\\(",
+    "\\s", "\\l", "\\>", "\\>", "\\v", "\\n", "\\<",
+};
+
+static void random_expr(math_expr2_t *e)
+{
+    math2_clear(e);
+    int steps = 1 + rand() % 40;
+    for(int i = 0; i < steps; i++)
+        type(e, random_steps[rand() % (sizeof random_steps / sizeof
+            *random_steps)]);
+}
+
+/* ===== Normal Form ===== */
+
+/* Reads TeX tokens from a math mode string, where spaces are ignored */
+typedef struct {
+    const char *str;
+    char token[32];
+    bool error;
+} lexer_t;
+
+static bool is_letter(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+static const char *peek(lexer_t *lx)
+{
+    while(*lx->str == ' ') lx->str++;
+    const char *s = lx->str;
+    int n = 0;
+
+    if(!*s) return NULL;
+    if(*s == '\\') {
+        lx->token[n++] = *s++;
+        if(is_letter(*s)) while(is_letter(*s) && n < 31)
+            lx->token[n++] = *s++;
+        else if(*s)
+            lx->token[n++] = *s++;
+    }
+    else lx->token[n++] = *s++;
+
+    lx->token[n] = 0;
+    return lx->token;
+}
+
+static const char *next(lexer_t *lx)
+{
+    const char *t = peek(lx);
+    if(t) lx->str += strlen(t);
+    return t;
+}
+
+static void canon_list(lexer_t *lx, math2_out_t *out, const char *end);
+
+static void put_token(math2_out_t *out, const char *token)
+{
+    if(out->len > 0) math2_out_char(out, ' ');
+    math2_out_put(out, token);
+}
+
+/* An argument is one token or one group; it is always written braced */
+static void canon_arg(lexer_t *lx, math2_out_t *out)
+{
+    const char *t = next(lx);
+    if(!t || !strcmp(t, "}") || !strcmp(t, "^") || !strcmp(t, "_")) {
+        lx->error = true;
+        return;
+    }
+    put_token(out, "{");
+    if(!strcmp(t, "{")) canon_list(lx, out, "}");
+    else put_token(out, t);
+    put_token(out, "}");
+}
+
+static void canon_list(lexer_t *lx, math2_out_t *out, const char *end)
+{
+    const char *t;
+    while((t = next(lx))) {
+        if(end && !strcmp(t, end)) return;
+
+        if(!strcmp(t, "{")) {
+            /* A group around a single item makes no difference */
+            char buf[MAX_LATEX * 2];
+            math2_out_t group;
+            math2_out_init(&group, buf, sizeof buf);
+            canon_list(lx, &group, "}");
+            if(strchr(buf, ' ')) {
+                put_token(out, "{");
+                put_token(out, buf);
+                put_token(out, "}");
+            }
+            else if(buf[0]) put_token(out, buf);
+        }
+        else if(!strcmp(t, "^") || !strcmp(t, "_")) {
+            put_token(out, t);
+            canon_arg(lx, out);
+        }
+        else if(!strcmp(t, "\\frac")) {
+            put_token(out, t);
+            canon_arg(lx, out);
+            canon_arg(lx, out);
+        }
+        else if(!strcmp(t, "\\sqrt")) {
+            put_token(out, t);
+            if(peek(lx) && !strcmp(peek(lx), "[")) {
+                next(lx);
+                put_token(out, "[");
+                canon_list(lx, out, "]");
+                put_token(out, "]");
+            }
+            canon_arg(lx, out);
+        }
+        else if(!strcmp(t, "\\left") || !strcmp(t, "\\right")) {
+            /* Sizing only; the delimiter follows as a normal token */
+        }
+        else if(!strcmp(t, "}")) {
+            lx->error = true;
+        }
+        else put_token(out, t);
+    }
+    if(end) lx->error = true;
+}
+
+/* Compute the normal form; returns false if the LaTeX is malformed */
+static bool canon(const char *latex, char *buf, int size)
+{
+    lexer_t lx = { .str = latex };
+    math2_out_t out;
+    math2_out_init(&out, buf, size);
+    canon_list(&lx, &out, NULL);
+    return !lx.error && !out.overflow;
+}
+
+/* ===== Property Test ===== */
+
+static long chars_verbose, chars_compact;
+
+static void check_styles(math_expr2_t *e)
+{
+    static char verbose[MAX_LATEX], compact[MAX_LATEX];
+    static char canon_v[MAX_LATEX * 2], canon_c[MAX_LATEX * 2];
+    math2_out_t out;
+
+    math2_out_init(&out, verbose, sizeof verbose);
+    math2_write_latex(&out, e->root, LATEX_VERBOSE);
+    if(out.overflow) return;
+    math2_out_init(&out, compact, sizeof compact);
+    math2_write_latex(&out, e->root, LATEX_COMPACT);
+
+    bool ok_v = canon(verbose, canon_v, sizeof canon_v);
+    bool ok_c = canon(compact, canon_c, sizeof canon_c);
+
+    if(!ok_v || !ok_c || strcmp(canon_v, canon_c)
+        || strlen(compact) > strlen(verbose)) {
+        if(errors < 10) {
+            printf("  FAIL:\n    verbose: %s\n    compact: %s\n", verbose,
+                compact);
+            printf("    normal forms:\n    %s\n    %s\n", canon_v, canon_c);
+        }
+        errors++;
+    }
+    chars_verbose += strlen(verbose);
+    chars_compact += strlen(compact);
+}
+
+static void test_random(long count)
+{
+    chars_verbose = chars_compact = 0;
+    for(long i = 0; i < count; i++) {
+        random_expr(&expr);
+        check_styles(&expr);
+    }
+    printf("%ld random expressions: compact is %.1f%% of verbose\n", count,
+        chars_verbose ? 100.0 * chars_compact / chars_verbose : 0.0);
+}
+
+/* ===== Corpus Benchmark ===== */
+
+/* Typical inputs, as editing scripts for type() */
+static const char *corpus[] = {
+    "x\\^2\\>+2x+1",
+    "-\\fb\\v2a\\>",
+    "x=\\f-b\\(b\\^2\\>-4ac\\>\\>\\v2a",
+    "\\f1\\v2\\>+\\f1\\v3\\>=\\f5\\v6",
+    "\\s\\px\\>\\^2\\>+\\s\\t\\>",
+    "\\a\\fx-1\\vx+1\\>\\>\\^2",
+    "\\r2\\>\\*\\r3\\>=\\r6",
+    "\\3\\f27\\v8\\>\\>=\\f3\\v2",
+    "\\m1\\n2\\n3\\>+\\m2\\n1\\n4",
+    "e\\^i\\p\\>+1=0",
+    "\\l\\fa\\vb\\>\\>=\\lz\\>-\\ly",
+    "a\\_n\\>=a\\_1\\>+(n-1)d",
+    "\\(\\fx\\vy\\>+1\\>\\^3",
+    "\\x4\\v\\r2\\>\\>+\\f\\p\\v4",
+};
+
+static double seconds(void)
+{
+    return (double)clock() / CLOCKS_PER_SEC;
+}
+
+static void bench_corpus(void)
+{
+    static math_expr2_t exprs[sizeof corpus / sizeof *corpus];
+    int count = sizeof corpus / sizeof *corpus;
+    static char buf[MAX_LATEX];
+    math2_out_t out;
+
+    chars_verbose = chars_compact = 0;
+    for(int i = 0; i < count; i++) {
+        math2_init(&exprs[i]);
+        type(&exprs[i], corpus[i]);
+        check_styles(&exprs[i]);
+    }
+    printf("corpus: %ld characters verbose, %ld compact (%.1f%%)\n",
+        chars_verbose, chars_compact, 100.0 * chars_compact / chars_verbose);
+
+    for(int style = LATEX_VERBOSE; style <= LATEX_COMPACT; style++) {
+        int n = 0;
+        double start = seconds(), elapsed;
+        do {
+            for(int i = 0; i < 1000; i++) {
+                math2_out_init(&out, buf, sizeof buf);
+                math2_write_latex(&out, exprs[i % count].root, style);
+            }
+            n += 1000;
+        } while((elapsed = seconds() - start) < 1);
+        printf("%s: %.0f expressions per second\n",
+            style == LATEX_VERBOSE ? "verbose" : "compact", n / elapsed);
+    }
+}
+
+/* ===== Main ===== */
+
+int main(int argc, char **argv)
+{
+    long count = (argc > 1) ? atol(argv[1]) : 100000;
+    srand(1);
+    math2_init(&expr);
+
+    test_random(count);
+    bench_corpus();
+
+    if(errors) {
+        printf("%d expression(s) with different meanings\n", errors);
+        return 1;
+    }
+    printf("Compact and verbose LaTeX agree\n");
+    return 0;
+}
@@ -9,11 +9,16 @@
 #include <gint/gint.h>
 #include <gint/usb.h>
 #include <gint/rtc.h>
+#include <gint/drivers/r61524.h>
 #include <string.h>
 #include <stdio.h>
 
 #include "math2.h"
+#include "math2-format.h"
+#include "math2-eval.h"
+#include "bigdec-bench.h"
 #include "usb-hid-kbd.h"
+#include "latex-diff.h"
 
 /* External variables (defined in math2.c) */
 extern bool g_color_brackets;
@@ -29,6 +34,19 @@ extern bool g_cursor_visible;
 #define INPUT_Y     80      /* Center expression vertically */
 #define PREVIEW_Y   155     /* LaTeX preview position */
 
+/* Sending screen */
+#define SEND_TEXT_X     10
+#define SEND_TEXT_Y     68
+#define SEND_TEXT_MAX   50      /* Bytes of the sent text shown */
+#define BAR_W           300
+#define BAR_H           24
+#define BAR_X           ((SCREEN_W - BAR_W) / 2)
+#define BAR_Y           (SCREEN_H / 2 + 20)
+#define PERCENT_Y       (BAR_Y + BAR_H + 15)
+
+/* Progress is redrawn at most every this many 128 Hz ticks (32 Hz) */
+#define PROGRESS_TICKS  4
+
 /* ===== Colors - Native Casio Style ===== */
 
 #define COL_HEADER_BG   C_RGB(0, 0, 12)
@@ -46,6 +64,8 @@ extern bool g_cursor_visible;
 #define COL_BOX_BORDER  C_BLACK
 #define COL_SEPARATOR   C_RGB(22, 22, 22)
 #define COL_LATEX_BOX   C_RGB(8, 12, 20)  /* Light blue */
+#define COL_SENT        C_RGB(0, 20, 0)
+#define COL_BAR_FILL    C_RGB(0, 24, 0)
 
 /* Cursor flash state */
 static int g_cursor_flash = 0;
@@ -56,7 +76,6 @@ static int g_cursor_flash = 0;
 #define MODE_LATEX  1
 
 static int current_mode = MODE_LATEX;
-static int progress_percent = 0;
 
 /* ===== Settings ===== */
 
@@ -65,6 +84,9 @@ typedef struct {
     bool clear_on_send;     /* Clear expression after sending */
     bool show_latex;        /* Show LaTeX preview */
     bool wrap_in_dollars;   /* Wrap LaTeX in $...$ */
+    bool compact_output;    /* Send the shortest equivalent output */
+    bool incremental_send;  /* Edit the previously sent text in place */
+    math2_format_id_t format;   /* Output format */
 } settings_t;
 
 static settings_t g_settings = {
@@ -72,8 +94,42 @@ static settings_t g_settings = {
     .clear_on_send = false,
     .show_latex = true,
     .wrap_in_dollars = false,
+    .compact_output = true,
+    .incremental_send = false,
+    .format = FORMAT_LATEX,
 };
 
+/* Generate the output for the preview and for sending into expr->latex;
+   returns false if it was too long */
+static bool format_output(math_expr2_t *expr)
+{
+    return math2_to_format(expr, g_settings.format, g_settings.compact_output);
+}
+
+/* Name of the selected output format */
+static const char *format_label(void)
+{
+    static char label[16];
+    snprintf(label, sizeof(label), "%s:", math2_formats[g_settings.format].name);
+    return label;
+}
+
+/* Text typed by the last complete send, for incremental sending. It is
+   invalid when the contents of the PC's text field are unknown. */
+static char g_last_sent[MAX_LATEX + 4];
+static bool g_last_sent_valid = false;
+
+/* Remove characters that the keyboard can't type, so that the last sent
+   string matches what actually arrived on the PC */
+static void strip_untypeable(char *str)
+{
+    char *out = str;
+    for(char *in = str; *in; in++) {
+        if(*in >= 0x20 && *in < 0x7f) *out++ = *in;
+    }
+    *out = '\0';
+}
+
 /* Alpha lock state (persists across key presses) */
 static bool g_alpha_lock = false;
 
@@ -228,8 +284,9 @@ static char show_variable_menu(void)
 
 static void show_settings_menu(void)
 {
-    int selected = 0;  /* 0=color, 1=clear, 2=preview, 3=wrap */
-    const int num_settings = 4;
+    int selected = 0;  /* 0=color, 1=clear, 2=preview, 3=wrap, 4=compact, 5=incr,
+                          6=format */
+    const int num_settings = 7;
     
     while(1) {
         dclear(COL_BG);
@@ -240,11 +297,11 @@ static void show_settings_menu(void)
                   DTEXT_CENTER, DTEXT_MIDDLE, "Settings");
         
         int y = 50;
-        int row_h = 35;
+        int row_h = 22;
         
         /* Setting 1: Color brackets */
         if(selected == 0) {
-            drect(15, y - 5, SCREEN_W - 15, y + 25, C_RGB(28, 28, 30));
+            drect(15, y - 5, SCREEN_W - 15, y + row_h - 5, C_RGB(28, 28, 30));
         }
         dtext(25, y, COL_TEXT, "Color Brackets:");
         dtext(SCREEN_W - 60, y, g_settings.color_brackets ? C_RGB(0, 20, 0) : C_RGB(20, 0, 0),
@@ -253,7 +310,7 @@ static void show_settings_menu(void)
         
         /* Setting 2: Clear on send */
         if(selected == 1) {
-            drect(15, y - 5, SCREEN_W - 15, y + 25, C_RGB(28, 28, 30));
+            drect(15, y - 5, SCREEN_W - 15, y + row_h - 5, C_RGB(28, 28, 30));
         }
         dtext(25, y, COL_TEXT, "Clear after send:");
         dtext(SCREEN_W - 60, y, g_settings.clear_on_send ? C_RGB(0, 20, 0) : C_RGB(20, 0, 0),
@@ -262,7 +319,7 @@ static void show_settings_menu(void)
         
         /* Setting 3: Show preview */
         if(selected == 2) {
-            drect(15, y - 5, SCREEN_W - 15, y + 25, C_RGB(28, 28, 30));
+            drect(15, y - 5, SCREEN_W - 15, y + row_h - 5, C_RGB(28, 28, 30));
         }
         dtext(25, y, COL_TEXT, "Show preview:");
         dtext(SCREEN_W - 60, y, g_settings.show_latex ? C_RGB(0, 20, 0) : C_RGB(20, 0, 0),
@@ -271,11 +328,40 @@ static void show_settings_menu(void)
         
         /* Setting 4: Wrap in dollars */
         if(selected == 3) {
-            drect(15, y - 5, SCREEN_W - 15, y + 25, C_RGB(28, 28, 30));
+            drect(15, y - 5, SCREEN_W - 15, y + row_h - 5, C_RGB(28, 28, 30));
         }
         dtext(25, y, COL_TEXT, "Wrap in $...$:");
         dtext(SCREEN_W - 60, y, g_settings.wrap_in_dollars ? C_RGB(0, 20, 0) : C_RGB(20, 0, 0),
               g_settings.wrap_in_dollars ? "On" : "Off");
+        y += row_h;
+        
+        /* Setting 5: Compact output */
+        if(selected == 4) {
+            drect(15, y - 5, SCREEN_W - 15, y + row_h - 5, C_RGB(28, 28, 30));
+        }
+        dtext(25, y, COL_TEXT, "Compact output:");
+        dtext(SCREEN_W - 60, y, g_settings.compact_output ? C_RGB(0, 20, 0) : C_RGB(20, 0, 0),
+              g_settings.compact_output ? "On" : "Off");
+        y += row_h;
+        
+        /* Setting 6: Incremental send */
+        if(selected == 5) {
+            drect(15, y - 5, SCREEN_W - 15, y + row_h - 5, C_RGB(28, 28, 30));
+        }
+        dtext(25, y, COL_TEXT, "Edit last sent:");
+        dtext(SCREEN_W - 60, y, g_settings.incremental_send ? C_RGB(0, 20, 0) : C_RGB(20, 0, 0),
+              g_settings.incremental_send ? "On" : "Off");
+        y += row_h;
+        
+        /* Setting 7: Output format */
+        if(selected == 6) {
+            drect(15, y - 5, SCREEN_W - 15, y + row_h - 5, C_RGB(28, 28, 30));
+        }
+        dtext(25, y, COL_TEXT, "Output format:");
+        dtext(SCREEN_W - 100, y, COL_TEXT, math2_formats[g_settings.format].name);
+        
+        /* The format is cycled rather than switched on and off */
+        bool cycle = (selected == 6);
         
         /* Function key bar at bottom - replaces status bar */
         int fkey_h = 16;
@@ -285,12 +371,12 @@ static void show_settings_menu(void)
         /* F1: ON */
         drect(0, fkey_y, fkey_w - 2, SCREEN_H, COL_HEADER_BG);
         dtext_opt(fkey_w / 2, fkey_y + fkey_h / 2, C_WHITE, C_NONE,
-                  DTEXT_CENTER, DTEXT_MIDDLE, "ON");
+                  DTEXT_CENTER, DTEXT_MIDDLE, cycle ? "NEXT" : "ON");
         
         /* F2: OFF */
         drect(fkey_w, fkey_y, fkey_w * 2 - 2, SCREEN_H, COL_HEADER_BG);
         dtext_opt(fkey_w + fkey_w / 2, fkey_y + fkey_h / 2, C_WHITE, C_NONE,
-                  DTEXT_CENTER, DTEXT_MIDDLE, "OFF");
+                  DTEXT_CENTER, DTEXT_MIDDLE, cycle ? "PREV" : "OFF");
         
         dupdate();
         
@@ -309,6 +395,14 @@ static void show_settings_menu(void)
                 case 1: g_settings.clear_on_send = true; break;
                 case 2: g_settings.show_latex = true; break;
                 case 3: g_settings.wrap_in_dollars = true; break;
+                case 4: g_settings.compact_output = true; break;
+                case 5:
+                    g_settings.incremental_send = true;
+                    g_last_sent_valid = false;
+                    break;
+                case 6:
+                    g_settings.format = (g_settings.format + 1) % FORMAT_COUNT;
+                    break;
             }
         }
         
@@ -319,6 +413,11 @@ static void show_settings_menu(void)
                 case 1: g_settings.clear_on_send = false; break;
                 case 2: g_settings.show_latex = false; break;
                 case 3: g_settings.wrap_in_dollars = false; break;
+                case 4: g_settings.compact_output = false; break;
+                case 5: g_settings.incremental_send = false; break;
+                case 6:
+                    g_settings.format = (g_settings.format + FORMAT_COUNT - 1) % FORMAT_COUNT;
+                    break;
             }
         }
     }
@@ -329,84 +428,75 @@ static void show_settings_menu(void)
 /* Store latex string for progress display */
 static const char *g_sending_latex = NULL;
 
+/* What the sending screen shows, so that updates only draw what changed */
+static struct {
+    char text[SEND_TEXT_MAX + 1];   /* Start of g_sending_latex */
+    int text_len;
+    int sent;               /* Bytes of text drawn as sent */
+    int fill;               /* Width of the filled part of the bar */
+    uint32_t tick;          /* RTC tick of the last update */
+} g_progress;
+
+/* Send a rectangle of VRAM to the display, both ends included. With triple
+   buffering the VRAM doesn't hold the previous frame, so the rectangle has
+   to be drawn in full first. */
+static void update_rect(int x1, int y1, int x2, int y2)
+{
+    r61524_display_rect(gint_vram, x1, x2, y1, y2);
+}
+
+/* Called after every character: the screen was drawn by show_sending(), so
+   this only updates the text, bar and counters, at a limited rate */
 static void update_progress(int current, int total)
 {
-    progress_percent = (current * 100) / total;
+    uint32_t now = rtc_ticks();
+    if(current < total && now - g_progress.tick < PROGRESS_TICKS) return;
+    g_progress.tick = now;
     
-    /* Redraw full screen to show progress */
-    dclear(COL_BG);
-    
-    /* Header */
-    drect(0, 0, SCREEN_W, HEADER_H - 1, COL_HEADER_BG);
-    dtext_opt(SCREEN_W / 2, HEADER_H / 2, COL_HEADER_TEXT, C_NONE,
-              DTEXT_CENTER, DTEXT_MIDDLE, "Sending to PC...");
-    
-    /* Show LaTeX with sent/unsent highlighting */
-    int latex_y = 50;
-    dtext(10, latex_y, COL_TEXT_DIM, "LaTeX:");
-    
-    if(g_sending_latex && total > 0) {
-        /* Draw sent portion in green */
-        char sent_part[128];
-        char unsent_part[128];
-        int len = strlen(g_sending_latex);
-        int sent_len = (current < len) ? current : len;
-        int unsent_len = len - sent_len;
-        
-        /* Truncate for display if needed */
-        int max_display = 50;
-        int sent_display = (sent_len > max_display) ? max_display : sent_len;
-        int unsent_display = (unsent_len > (max_display - sent_display)) ? (max_display - sent_display) : unsent_len;
-        
-        if(sent_display > 0) {
-            strncpy(sent_part, g_sending_latex, sent_display);
-            sent_part[sent_display] = '\0';
-            dtext(10, latex_y + 18, C_RGB(0, 20, 0), sent_part);  /* Green = sent */
-        }
-        
-        if(unsent_display > 0) {
-            strncpy(unsent_part, g_sending_latex + sent_len, unsent_display);
-            unsent_part[unsent_display] = '\0';
-            /* Draw unsent after sent */
-            int sent_width = sent_display * 6;  /* Approximate char width */
-            dtext(10 + sent_width, latex_y + 18, COL_TEXT_DIM, unsent_part);  /* Gray = unsent */
-        }
-        
-        if(len > max_display) {
-            dtext(10 + max_display * 6, latex_y + 18, COL_TEXT_DIM, "...");
-        }
+    /* Sent text turns green */
+    int sent = (current < g_progress.text_len) ? current : g_progress.text_len;
+    if(sent > g_progress.sent) {
+        int x1 = 0, x2, h;
+        if(g_progress.sent > 0)
+            dnsize(g_progress.text, g_progress.sent, NULL, &x1, &h);
+        dnsize(g_progress.text, sent, NULL, &x2, &h);
+        x1 += SEND_TEXT_X;
+        x2 += SEND_TEXT_X;
+        
+        drect(x1, SEND_TEXT_Y, x2, SEND_TEXT_Y + h - 1, COL_BG);
+        dtext_opt(SEND_TEXT_X, SEND_TEXT_Y, COL_SENT, C_NONE, DTEXT_LEFT,
+                  DTEXT_TOP, g_progress.text, sent);
+        update_rect(x1, SEND_TEXT_Y, x2, SEND_TEXT_Y + h - 1);
+        g_progress.sent = sent;
     }
     
-    /* Progress bar */
-    int bar_w = 300;
-    int bar_h = 24;
-    int bar_x = (SCREEN_W - bar_w) / 2;
-    int bar_y = SCREEN_H / 2 + 20;
-    
-    int fill_w = (bar_w * progress_percent) / 100;
-    
-    /* Filled portion (green) */
-    if(fill_w > 0) {
-        drect(bar_x + 2, bar_y + 2, bar_x + 2 + fill_w, bar_y + bar_h - 2, C_RGB(0, 24, 0));
+    /* New part of the bar */
+    int percent = (current * 100) / total;
+    int fill = (BAR_W - 4) * percent / 100;
+    if(fill > g_progress.fill) {
+        int x1 = BAR_X + 2 + g_progress.fill;
+        int x2 = BAR_X + 2 + fill - 1;
+        drect(x1, BAR_Y + 2, x2, BAR_Y + BAR_H - 2, COL_BAR_FILL);
+        update_rect(x1, BAR_Y + 2, x2, BAR_Y + BAR_H - 2);
+        g_progress.fill = fill;
     }
-    /* Border */
-    drect_border(bar_x, bar_y, bar_x + bar_w, bar_y + bar_h, C_NONE, 2, COL_HEADER_BG);
     
-    /* Percentage text */
-    char percent_str[16];
-    sprintf(percent_str, "%d%%", progress_percent);
-    dtext_opt(SCREEN_W / 2, bar_y + bar_h + 15, COL_TEXT, C_NONE,
-              DTEXT_CENTER, DTEXT_MIDDLE, percent_str);
+    /* Percentage */
+    char str[64];
+    sprintf(str, "%d%%", percent);
+    drect(SCREEN_W / 2 - 20, PERCENT_Y - 8, SCREEN_W / 2 + 20, PERCENT_Y + 8,
+          COL_BG);
+    dtext_opt(SCREEN_W / 2, PERCENT_Y, COL_TEXT, C_NONE,
+              DTEXT_CENTER, DTEXT_MIDDLE, str);
+    update_rect(SCREEN_W / 2 - 20, PERCENT_Y - 8, SCREEN_W / 2 + 20,
+                PERCENT_Y + 8);
     
     /* Status bar */
-    drect(0, SCREEN_H - STATUS_H, SCREEN_W, SCREEN_H, COL_STATUS_BG);
-    
-    char status[64];
-    sprintf(status, "Sent %d / %d characters  |  AC: Cancel", current, total);
+    sprintf(str, "Sent %d / %d characters  |  AC: Cancel", current, total);
+    drect(0, SCREEN_H - STATUS_H, SCREEN_W - 1, SCREEN_H - 1, COL_STATUS_BG);
     dtext_opt(SCREEN_W / 2, SCREEN_H - STATUS_H/2, COL_STATUS_TEXT, C_NONE,
-              DTEXT_CENTER, DTEXT_MIDDLE, status);
-    
-    dupdate();
+              DTEXT_CENTER, DTEXT_MIDDLE, str);
+    update_rect(0, SCREEN_H - STATUS_H, SCREEN_W - 1, SCREEN_H - 1);
 }
 
 /* ===== Drawing Functions ===== */
@@ -419,6 +509,10 @@ static void draw_header(math_expr2_t *expr)
     
     /* Mode indicators */
     int x = SCREEN_W - 80;
+    if(expr->selecting) {
+        drect(x - 35, 4, x - 5, HEADER_H - 5, COL_MODE_ON);
+        dtext(x - 32, 7, C_BLACK, "SEL");
+    }
     if(expr->shift_mode) {
         drect(x, 4, x + 30, HEADER_H - 5, COL_MODE_ON);
         dtext(x + 3, 7, C_BLACK, "SHF");
@@ -434,6 +528,9 @@ static void draw_header(math_expr2_t *expr)
     }
 }
 
+/* Scroll position of the input box */
+static math2_view_t g_input_view;
+
 static void draw_input_area(math_expr2_t *expr)
 {
     /* Input box - aligned with LaTeX separator */
@@ -453,17 +550,12 @@ static void draw_input_area(math_expr2_t *expr)
         dtext_opt(SCREEN_W / 2, box_top + box_height / 2, COL_TEXT_GREY, C_NONE,
                   DTEXT_CENTER, DTEXT_MIDDLE, "Enter expression...");
     } else {
-        /* Get expression dimensions */
-        int expr_h = math2_get_height(expr);
-        
-        /* Horizontal: start from left side with padding */
-        int x = 25;
-        
-        /* Vertical: center expression in box
-         * math2_draw expects y to be the top of the expression */
-        int y = box_top + (box_height - expr_h) / 2;
-        
-        math2_draw(expr, x, y);
+        /* Draw inside the border, scrolling to follow the cursor */
+        g_input_view.x = 13;
+        g_input_view.y = box_top + 3;
+        g_input_view.w = SCREEN_W - 26;
+        g_input_view.h = box_height - 5;
+        math2_draw_view(expr, &g_input_view);
     }
 }
 
@@ -471,13 +563,13 @@ static void draw_latex_preview(math_expr2_t *expr)
 {
     if(!g_settings.show_latex) return;
     
-    /* Generate LaTeX */
-    math2_to_latex(expr);
+    /* Generate output in the selected format */
+    format_output(expr);
     
     int preview_top = PREVIEW_Y;
     
     /* LaTeX label in grey */
-    dtext(12, preview_top, COL_TEXT_GREY, "LaTeX:");
+    dtext(12, preview_top, COL_TEXT_GREY, format_label());
     
     /* Separator line - matches input box width */
     int sep_y = preview_top + 16;
@@ -498,6 +590,68 @@ static void draw_latex_preview(math_expr2_t *expr)
     dtext(12, sep_y + 8, COL_PREVIEW_TEXT, display);
 }
 
+/* Significant digits of exact results in the preview */
+#define RESULT_DIGITS 20
+
+/* Value of the expression, computed again only after edits */
+static char g_result[40];
+static unsigned int g_result_edit;
+static bool g_result_valid = false;
+
+/* Write the value of the expression after "= ". Exact results are shown
+   with RESULT_DIGITS digits, or as a fraction if they need more; functions
+   like sin fall back to doubles. */
+static void compute_result(math_expr2_t *expr, char *buf, int size)
+{
+    static math2_program_t prog;
+    bigdec_t exact;
+    double value;
+    long long num, den;
+    
+    buf[0] = '\0';
+    if(math2_compile_exact(&prog, expr->root) != EVAL_OK) return;
+    
+    strcpy(buf, "= ");
+    buf += 2;
+    size -= 2;
+    
+    math2_eval_status_t status = math2_run_exact(&prog, &exact);
+    if(status == EVAL_OK) {
+        char digits[EVAL_EXACT_DIGITS];
+        int e;
+        bool terminates = bigdec_digits(&exact, digits, EVAL_EXACT_DIGITS - 4,
+                                        &e) <= RESULT_DIGITS;
+        if(!terminates && math2_exact_fraction(&exact, &num, &den) && den > 1)
+            snprintf(buf, size, "%lld/%lld", num, den);
+        else
+            math2_format_exact(&exact, RESULT_DIGITS, buf, size);
+    }
+    else if(status == EVAL_UNSUPPORTED &&
+            math2_run(&prog, NULL, &value) == EVAL_OK) {
+        math2_format_number(value, buf, size);
+    }
+    else {
+        buf[-2] = '\0';
+    }
+}
+
+static void draw_result_preview(math_expr2_t *expr)
+{
+    unsigned int edit = math2_edit_count();
+    if(!g_result_valid || edit != g_result_edit) {
+        compute_result(expr, g_result, sizeof(g_result));
+        g_result_edit = edit;
+        g_result_valid = true;
+    }
+    
+    /* Right of the preview label; nothing while the expression is
+       incomplete or has variables */
+    if(g_result[0]) {
+        dtext_opt(SCREEN_W - 12, PREVIEW_Y, COL_TEXT, C_NONE, DTEXT_RIGHT,
+                  DTEXT_TOP, g_result);
+    }
+}
+
 static void draw_status_bar(math_expr2_t *expr)
 {
     /* Separator line on top */
@@ -510,7 +664,9 @@ static void draw_status_bar(math_expr2_t *expr)
     
     /* Context-sensitive hints */
     expr_node_t *seq = expr->cursor.sequence;
-    if(seq && seq->parent) {
+    if(expr->selecting) {
+        hint = "F1:Copy | F2:Cut | DEL:Delete | EXIT:Cancel";
+    } else if(seq && seq->parent) {
         node_type_t pt = seq->parent->type;
         if(pt == NODE_FRACTION) {
             if(seq == seq->parent->data.frac.numer)
@@ -538,6 +694,7 @@ static void draw_editor_ui(math_expr2_t *expr)
     draw_header(expr);
     draw_input_area(expr);
     draw_latex_preview(expr);
+    draw_result_preview(expr);
     draw_status_bar(expr);
     dupdate();
 }
@@ -552,30 +709,27 @@ static void show_sending(math_expr2_t *expr)
               DTEXT_CENTER, DTEXT_MIDDLE, "Sending to PC...");
     
     /* Show LaTeX being sent */
-    int latex_y = 50;
-    dtext(10, latex_y, COL_TEXT_DIM, "LaTeX:");
+    dtext(SEND_TEXT_X, SEND_TEXT_Y - 18, COL_TEXT_DIM, format_label());
     
-    /* Display latex text (truncated if needed) */
-    char display_latex[80];
-    if(strlen(expr->latex) > 60) {
-        strncpy(display_latex, expr->latex, 57);
-        display_latex[57] = '.';
-        display_latex[58] = '.';
-        display_latex[59] = '.';
-        display_latex[60] = '\0';
-    } else {
-        strcpy(display_latex, expr->latex);
-    }
-    dtext(10, latex_y + 18, COL_TEXT, display_latex);
+    /* Plain text turns green as it is sent; edit scripts are not shown */
+    const char *text = g_sending_latex ? g_sending_latex : expr->latex;
+    int len = strlen(text);
+    g_progress.text_len = (len > SEND_TEXT_MAX) ? SEND_TEXT_MAX : len;
+    memcpy(g_progress.text, text, g_progress.text_len);
+    g_progress.text[g_progress.text_len] = '\0';
+    if(!g_sending_latex) g_progress.text_len = 0;
     
-    /* Progress bar - match status bar colors */
-    int bar_w = 300;
-    int bar_h = 24;
-    int bar_x = (SCREEN_W - bar_w) / 2;
-    int bar_y = SCREEN_H / 2 + 20;
+    int w = 0, h;
+    dtext(SEND_TEXT_X, SEND_TEXT_Y, g_sending_latex ? COL_TEXT_DIM : COL_TEXT,
+          g_progress.text);
+    dsize(g_progress.text, NULL, &w, &h);
+    if(len > SEND_TEXT_MAX)
+        dtext(SEND_TEXT_X + w + 2, SEND_TEXT_Y, COL_TEXT_DIM, "...");
     
-    drect_border(bar_x, bar_y, bar_x + bar_w, bar_y + bar_h, COL_BG, 2, COL_HEADER_BG);
-    dtext_opt(SCREEN_W / 2, bar_y + bar_h + 15, COL_TEXT_DIM, C_NONE,
+    /* Progress bar - match status bar colors */
+    drect_border(BAR_X, BAR_Y, BAR_X + BAR_W, BAR_Y + BAR_H, COL_BG, 2,
+                 COL_HEADER_BG);
+    dtext_opt(SCREEN_W / 2, PERCENT_Y, COL_TEXT_DIM, C_NONE,
               DTEXT_CENTER, DTEXT_MIDDLE, "0%");
     
     /* Status bar */
@@ -584,6 +738,85 @@ static void show_sending(math_expr2_t *expr)
               DTEXT_CENTER, DTEXT_MIDDLE, "Transmitting...");
     
     dupdate();
+    
+    g_progress.sent = 0;
+    g_progress.fill = 0;
+    g_progress.tick = rtc_ticks();
+}
+
+/* ===== Big Decimal Benchmark ===== */
+
+/* Each measurement runs for at least this many 128 Hz RTC ticks */
+#define BENCH_TICKS 64
+
+static const int bench_digits[] = { 20, 50, 200 };
+#define BENCH_SIZES (int)(sizeof(bench_digits) / sizeof(bench_digits[0]))
+
+/* Operations per second, doubling the batch size until it takes long
+   enough for the RTC to measure */
+static uint32_t bench_rate(int op)
+{
+    int count = 1;
+    while(1) {
+        uint32_t start = rtc_ticks();
+        bigdec_bench_run(op, count);
+        uint32_t ticks = rtc_ticks() - start;
+        if(ticks >= BENCH_TICKS || count >= (1 << 24))
+            return (uint32_t)((uint64_t)count * 128 / (ticks ? ticks : 1));
+        count *= 2;
+    }
+}
+
+static void format_rate(uint32_t rate, char *buf, int size)
+{
+    if(rate >= 1000000) snprintf(buf, size, "%u.%uM", (unsigned)(rate / 1000000),
+                                 (unsigned)(rate / 100000 % 10));
+    else if(rate >= 10000) snprintf(buf, size, "%uK", (unsigned)(rate / 1000));
+    else snprintf(buf, size, "%u", (unsigned)rate);
+}
+
+static void show_bigdec_bench(void)
+{
+    int row_h = 20;
+    int col_w = 90;
+    int table_y = HEADER_H + 12;
+    int label_x = 12;
+    int first_col = label_x + 60;
+    char buf[16];
+    
+    dclear(COL_BG);
+    drect(0, 0, SCREEN_W, HEADER_H - 1, COL_HEADER_BG);
+    dtext(8, (HEADER_H - 11) / 2, COL_HEADER_TEXT, "Big decimal benchmark");
+    
+    for(int j = 0; j < BENCH_SIZES; j++) {
+        snprintf(buf, sizeof(buf), "%d digits", bench_digits[j]);
+        dtext(first_col + j * col_w, table_y, COL_TEXT_DIM, buf);
+    }
+    for(int op = 0; op < BIGDEC_BENCH_OPS; op++)
+        dtext(label_x, table_y + (op + 1) * row_h, COL_TEXT,
+              bigdec_bench_names[op]);
+    
+    drect(0, SCREEN_H - STATUS_H, SCREEN_W, SCREEN_H, COL_STATUS_BG);
+    dtext_opt(SCREEN_W / 2, SCREEN_H - STATUS_H/2, COL_STATUS_TEXT, C_NONE,
+              DTEXT_CENTER, DTEXT_MIDDLE, "Running... (operations per second)");
+    dupdate();
+    
+    /* Fill the table as results come in */
+    for(int j = 0; j < BENCH_SIZES; j++) {
+        bigdec_bench_setup(bench_digits[j]);
+        for(int op = 0; op < BIGDEC_BENCH_OPS; op++) {
+            format_rate(bench_rate(op), buf, sizeof(buf));
+            dtext(first_col + j * col_w, table_y + (op + 1) * row_h,
+                  COL_TEXT, buf);
+            dupdate();
+        }
+    }
+    
+    drect(0, SCREEN_H - STATUS_H, SCREEN_W, SCREEN_H, COL_STATUS_BG);
+    dtext_opt(SCREEN_W / 2, SCREEN_H - STATUS_H/2, COL_STATUS_TEXT, C_NONE,
+              DTEXT_CENTER, DTEXT_MIDDLE, "Operations per second | any key: Back");
+    dupdate();
+    getkey();
 }
 
 /* ===== Mode Selection Screen ===== */
@@ -623,13 +856,14 @@ static int show_mode_selection(void)
         /* Status bar */
         drect(0, SCREEN_H - STATUS_H, SCREEN_W, SCREEN_H, COL_STATUS_BG);
         dtext_opt(SCREEN_W / 2, SCREEN_H - STATUS_H/2, COL_STATUS_TEXT, C_NONE,
-                  DTEXT_CENTER, DTEXT_MIDDLE, "Press F1 or F2 to select | EXIT to quit");
+                  DTEXT_CENTER, DTEXT_MIDDLE, "F1/F2: Select | F6: Benchmark | EXIT: Quit");
         
         dupdate();
         
         key_event_t ev = getkey();
         if(ev.key == KEY_F1) return MODE_NUMPAD;
         if(ev.key == KEY_F2) return MODE_LATEX;
+        if(ev.key == KEY_F6) show_bigdec_bench();
         if(ev.key == KEY_EXIT) return -1;
     }
 }
@@ -657,6 +891,20 @@ static void show_timeout_error(void)
     getkey();
 }
 
+static void show_too_long_error(void)
+{
+    dclear(COL_BG);
+    drect(0, 0, SCREEN_W, HEADER_H - 1, C_RGB(20, 0, 0));
+    dtext_opt(SCREEN_W / 2, HEADER_H / 2, C_WHITE, C_NONE,
+              DTEXT_CENTER, DTEXT_MIDDLE, "Too long!");
+    dtext_opt(SCREEN_W / 2, SCREEN_H / 2 - 10, COL_TEXT, C_NONE,
+              DTEXT_CENTER, DTEXT_MIDDLE, "Output doesn't fit in the send buffer");
+    dtext_opt(SCREEN_W / 2, SCREEN_H / 2 + 20, COL_TEXT_DIM, C_NONE,
+              DTEXT_CENTER, DTEXT_MIDDLE, "Try a shorter format, press any key");
+    dupdate();
+    getkey();
+}
+
 static void draw_numpad_ui(bool is_dimmed)
 {
     dclear(C_RGB(28, 30, 28));
@@ -820,6 +1068,37 @@ static bool run_latex_mode(void)
         bool shift = expr->shift_mode;
         bool alpha = expr->alpha_mode;
         
+        /* Selection: LEFT/RIGHT extend it, F1 copies, F2 cuts, and other
+           keys end it (SHIFT+9 pastes over it) */
+        if(expr->selecting) {
+            if(ev.key == KEY_LEFT) {
+                cursor_left(expr);
+                continue;
+            }
+            if(ev.key == KEY_RIGHT) {
+                cursor_right(expr);
+                continue;
+            }
+            if(ev.key == KEY_F1) {
+                math2_copy(expr);
+                continue;
+            }
+            if(ev.key == KEY_F2) {
+                math2_cut(expr);
+                continue;
+            }
+            if(ev.key == KEY_DEL) {
+                if(!math2_delete_selection(expr)) math2_select_end(expr);
+                continue;
+            }
+            if(ev.key == KEY_EXIT) {
+                math2_select_end(expr);
+                continue;
+            }
+            if(ev.key != KEY_SHIFT && !(shift && ev.key == KEY_9))
+                math2_select_end(expr);
+        }
+        
         /* Mode switch */
         if(ev.key == KEY_F1) {
             return true;  /* Switch to numpad */
@@ -889,37 +1168,56 @@ static bool run_latex_mode(void)
             continue;
         }
         
-        /* Send LaTeX */
+        /* Send output */
         if(ev.key == KEY_EXE) {
             /* If in nested slot, exit first */
             if(expr->cursor.sequence != expr->root) {
                 cursor_exit(expr);
             } else {
-                /* Send LaTeX */
-                math2_to_latex(expr);
-                if(strlen(expr->latex) > 0) {
+                /* Send output */
+                if(!format_output(expr)) {
+                    show_too_long_error();
+                } else if(strlen(expr->latex) > 0) {
                     /* Build string to send - optionally wrap in dollars */
                     static char send_buf[MAX_LATEX + 4];
-                    if(g_settings.wrap_in_dollars) {
+                    if(g_settings.wrap_in_dollars && g_settings.format == FORMAT_LATEX) {
                         snprintf(send_buf, sizeof(send_buf), "$%s$", expr->latex);
                     } else {
                         strncpy(send_buf, expr->latex, sizeof(send_buf) - 1);
                         send_buf[sizeof(send_buf) - 1] = '\0';
                     }
                     
-                    g_sending_latex = send_buf;  /* Set for progress display */
+                    /* Type only the keys that edit the last sent text */
+                    const char *to_type = send_buf;
+                    static char script[MAX_LATEX + 8];
+                    if(g_settings.incremental_send) {
+                        strip_untypeable(send_buf);
+                        if(g_last_sent_valid &&
+                           latex_diff(g_last_sent, send_buf, script, sizeof(script)) >= 0)
+                            to_type = script;
+                    }
+                    
+                    /* Scripts contain editing keys, so only show plain text */
+                    g_sending_latex = (to_type == send_buf) ? send_buf : NULL;
                     g_cancel_send = false;  /* Reset cancel flag */
                     show_sending(expr);
                     
-                    int result = usb_hid_kbd_type_string_cancellable(
-                        send_buf, 
-                        update_progress,
-                        check_cancel_send,
-                        USB_TIMEOUT_TICKS
-                    );
+                    int result = 0;
+                    if(to_type[0]) {
+                        result = usb_hid_kbd_type_string_cancellable(
+                            to_type, 
+                            update_progress,
+                            check_cancel_send,
+                            USB_TIMEOUT_TICKS
+                        );
+                    }
                     
                     g_sending_latex = NULL;
                     
+                    /* A partial send leaves the PC's text unknown */
+                    g_last_sent_valid = g_settings.incremental_send && result == 0;
+                    if(g_last_sent_valid) strcpy(g_last_sent, send_buf);
+                    
                     if(result == -2) {
                         /* Cancelled - show message */
                         dclear(COL_BG);
@@ -946,9 +1244,11 @@ static bool run_latex_mode(void)
                         /* Success - brief pause to show completion */
                         for(volatile int i = 0; i < 20000; i++);
                         
-                        /* Clear if setting enabled */
+                        /* Clear if setting enabled; the next expression is a
+                           new one, not an edit of the text just sent */
                         if(g_settings.clear_on_send) {
                             math2_clear(expr);
+                            g_last_sent_valid = false;
                         }
                     }
                 }
@@ -981,11 +1281,11 @@ static bool run_latex_mode(void)
             continue;
         }
         if(ev.key == KEY_UP) {
-            cursor_prev_slot(expr);
+            if(!cursor_up(expr)) cursor_prev_slot(expr);
             continue;
         }
         if(ev.key == KEY_DOWN) {
-            cursor_next_slot(expr);
+            if(!cursor_down(expr)) cursor_next_slot(expr);
             continue;
         }
         
@@ -1002,6 +1302,7 @@ static bool run_latex_mode(void)
                 return false;
             }
             math2_clear(expr);
+            g_last_sent_valid = false;
             continue;
         }
         
@@ -1070,6 +1371,18 @@ static bool run_latex_mode(void)
         
         /* ===== SHIFT modifiers ===== */
         
+        /* SHIFT+8: CLIP (start selecting), SHIFT+9: PASTE, as in the OS */
+        if(shift && ev.key == KEY_8) {
+            math2_select_start(expr);
+            math2_clear_modes(expr);
+            continue;
+        }
+        if(shift && ev.key == KEY_9) {
+            math2_paste(expr);
+            math2_clear_modes(expr);
+            continue;
+        }
+        
         /* Numbers - no shift modifiers but check alpha first */
         if(!alpha) {
             if(ev.key == KEY_0) {
@@ -0,0 +1,753 @@
+/*
+ * math2-eval.c - Numeric evaluation of math2 expressions
+ */
+
+#include "math2-eval.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#define PI 3.14159265358979323846
+#define E  2.71828182845904523536
+
+/* ===== Bytecode ===== */
+
+/* Instructions are one byte, followed by a one-byte operand for OP_CONST,
+   OP_VAR and OP_LITERAL. Binary operators come first. */
+enum {
+    OP_ADD,
+    OP_SUB,
+    OP_MUL,
+    OP_DIV,
+    OP_POW,
+    OP_ROOT,            /* x, n -> nth root of x */
+    OP_NEG,
+    OP_SQRT,
+    OP_ABS,
+    OP_SIN,
+    OP_COS,
+    OP_TAN,
+    OP_ASIN,
+    OP_ACOS,
+    OP_ATAN,
+    OP_LN,
+    OP_LOG,
+    OP_CONST,           /* Push consts[operand] */
+    OP_VAR,             /* Push vars[operand] */
+    OP_LITERAL,         /* Push the number written at literals + operand */
+    OP_PI,
+    OP_E,
+};
+
+#define IS_BINARY(op) ((op) <= OP_ROOT)
+
+static const struct {
+    const char *name;
+    uint8_t op;
+} functions[] = {
+    { "sin", OP_SIN },
+    { "cos", OP_COS },
+    { "tan", OP_TAN },
+    { "arcsin", OP_ASIN },
+    { "arccos", OP_ACOS },
+    { "arctan", OP_ATAN },
+    { "ln", OP_LN },
+    { "log", OP_LOG },
+};
+
+/* Odd roots of negative numbers are real, pow() doesn't know that */
+static double root(double x, double n)
+{
+    if(x < 0 && n == floor(n) && fmod(n, 2) != 0) return -pow(-x, 1 / n);
+    return pow(x, 1 / n);
+}
+
+/* Apply an operator; b is unused for unary operators */
+static double apply(uint8_t op, double a, double b)
+{
+    switch(op) {
+        case OP_ADD:  return a + b;
+        case OP_SUB:  return a - b;
+        case OP_MUL:  return a * b;
+        case OP_DIV:  return a / b;
+        case OP_POW:  return pow(a, b);
+        case OP_ROOT: return root(a, b);
+        case OP_NEG:  return -a;
+        case OP_SQRT: return sqrt(a);
+        case OP_ABS:  return fabs(a);
+        case OP_SIN:  return sin(a);
+        case OP_COS:  return cos(a);
+        case OP_TAN:  return tan(a);
+        case OP_ASIN: return asin(a);
+        case OP_ACOS: return acos(a);
+        case OP_ATAN: return atan(a);
+        case OP_LN:   return log(a);
+        case OP_LOG:  return log10(a);
+    }
+    return NAN;
+}
+
+/* ===== Compiler ===== */
+
+typedef struct {
+    math2_program_t *prog;
+    expr_node_t *node;      /* Next node of the sequence being parsed */
+    math2_eval_status_t status;
+    bool exact;             /* Keep numbers as written, don't fold */
+
+    /* Values on the stack when the program runs, with where their code
+       starts; constants are folded when all operands are constants */
+    struct {
+        bool is_const;
+        int start;
+    } stack[EVAL_STACK];
+    int depth;
+} compiler_t;
+
+static void compile_sequence(compiler_t *c, expr_node_t *seq);
+
+static void fail(compiler_t *c, math2_eval_status_t status)
+{
+    if(c->status == EVAL_OK) c->status = status;
+}
+
+static bool push(compiler_t *c, bool is_const, int start)
+{
+    if(c->depth >= EVAL_STACK) {
+        fail(c, EVAL_TOO_LONG);
+        return false;
+    }
+    c->stack[c->depth].is_const = is_const;
+    c->stack[c->depth].start = start;
+    c->depth++;
+    return true;
+}
+
+static void emit_const(compiler_t *c, double value)
+{
+    math2_program_t *p = c->prog;
+    if(c->status != EVAL_OK) return;
+    if(p->len + 2 > EVAL_MAX_CODE || p->nconsts >= EVAL_MAX_CONSTS) {
+        fail(c, EVAL_TOO_LONG);
+        return;
+    }
+    if(!push(c, true, p->len)) return;
+    p->consts[p->nconsts] = value;
+    p->code[p->len++] = OP_CONST;
+    p->code[p->len++] = p->nconsts++;
+}
+
+static void emit_var(compiler_t *c, int var)
+{
+    math2_program_t *p = c->prog;
+    if(c->status != EVAL_OK) return;
+    if(p->len + 2 > EVAL_MAX_CODE) {
+        fail(c, EVAL_TOO_LONG);
+        return;
+    }
+    if(!push(c, false, p->len)) return;
+    p->vars |= (uint64_t)1 << var;
+    p->code[p->len++] = OP_VAR;
+    p->code[p->len++] = var;
+}
+
+/* Number as written; exact programs keep the text */
+static void emit_number(compiler_t *c, const char *text, double value)
+{
+    math2_program_t *p = c->prog;
+    if(!c->exact) {
+        emit_const(c, value);
+        return;
+    }
+    if(c->status != EVAL_OK) return;
+
+    int size = strlen(text) + 1;
+    if(p->len + 2 > EVAL_MAX_CODE ||
+       p->literals_len + size > EVAL_MAX_LITERALS) {
+        fail(c, EVAL_TOO_LONG);
+        return;
+    }
+    if(!push(c, false, p->len)) return;
+    p->code[p->len++] = OP_LITERAL;
+    p->code[p->len++] = p->literals_len;
+    memcpy(p->literals + p->literals_len, text, size);
+    p->literals_len += size;
+}
+
+/* π or e, computed to the working precision by exact programs */
+static void emit_named(compiler_t *c, uint8_t op, double value)
+{
+    math2_program_t *p = c->prog;
+    if(!c->exact) {
+        emit_const(c, value);
+        return;
+    }
+    if(c->status != EVAL_OK) return;
+    if(p->len + 1 > EVAL_MAX_CODE) {
+        fail(c, EVAL_TOO_LONG);
+        return;
+    }
+    if(!push(c, false, p->len)) return;
+    p->code[p->len++] = op;
+}
+
+static void emit_op(compiler_t *c, uint8_t op)
+{
+    math2_program_t *p = c->prog;
+    if(c->status != EVAL_OK) return;
+
+    int n = IS_BINARY(op) ? 2 : 1;
+    c->depth -= n;
+    int start = c->stack[c->depth].start;
+
+    bool folded = c->stack[c->depth].is_const &&
+                  (n == 1 || c->stack[c->depth + 1].is_const);
+    if(folded) {
+        /* The operands are the last constants, drop them with their code */
+        double a = p->consts[p->code[start + 1]];
+        double b = (n == 2) ? p->consts[p->code[start + 3]] : 0;
+        p->nconsts = p->code[start + 1];
+        p->len = start;
+        emit_const(c, apply(op, a, b));
+        return;
+    }
+
+    if(p->len + 1 > EVAL_MAX_CODE) {
+        fail(c, EVAL_TOO_LONG);
+        return;
+    }
+    p->code[p->len++] = op;
+    push(c, false, start);
+}
+
+static bool is_operator(expr_node_t *node, const char *op)
+{
+    return node && node->type == NODE_TEXT &&
+           node->data.text.subtype == TEXT_OPERATOR &&
+           !strcmp(node->data.text.text, op);
+}
+
+static bool is_text(expr_node_t *node, text_type_t subtype)
+{
+    return node && node->type == NODE_TEXT &&
+           node->data.text.subtype == subtype;
+}
+
+/* Check if a sequence only holds digits */
+static bool is_number_seq(expr_node_t *seq)
+{
+    if(!seq->data.seq.first) return false;
+    for(expr_node_t *n = seq->data.seq.first; n; n = n->next) {
+        if(!is_text(n, TEXT_NUMBER)) return false;
+    }
+    return true;
+}
+
+static void append_digits(compiler_t *c, char *buf, int *len, const char *text)
+{
+    int n = strlen(text);
+    if(*len + n >= 32) {
+        fail(c, EVAL_TOO_LONG);
+        return;
+    }
+    memcpy(buf + *len, text, n + 1);
+    *len += n;
+}
+
+/* Number made of consecutive digit nodes, possibly raised to a power */
+static void compile_number(compiler_t *c)
+{
+    char buf[32];
+    int len = 0;
+    buf[0] = '\0';
+
+    while(is_text(c->node, TEXT_NUMBER)) {
+        append_digits(c, buf, &len, c->node->data.text.text);
+        c->node = c->node->next;
+    }
+
+    /* 12² is drawn with the 2 alone in the base */
+    expr_node_t *power = NULL;
+    if(c->node && c->node->type == NODE_EXPONENT &&
+       is_number_seq(c->node->data.exp.base)) {
+        for(expr_node_t *n = c->node->data.exp.base->data.seq.first; n;
+            n = n->next)
+            append_digits(c, buf, &len, n->data.text.text);
+        power = c->node->data.exp.power;
+        c->node = c->node->next;
+    }
+
+    char *end;
+    double value = strtod(buf, &end);
+    if(end != buf + len) fail(c, EVAL_SYNTAX);
+    emit_number(c, buf, value);
+
+    if(power) {
+        compile_sequence(c, power);
+        emit_op(c, OP_POW);
+    }
+}
+
+static void compile_sum(compiler_t *c);
+
+/* Operand: number, variable, constant or structure */
+static void compile_atom(compiler_t *c)
+{
+    expr_node_t *node = c->node;
+    if(!node) {
+        fail(c, EVAL_SYNTAX);
+        return;
+    }
+
+    switch(node->type) {
+        case NODE_TEXT:
+            switch(node->data.text.subtype) {
+                case TEXT_NUMBER:
+                    compile_number(c);
+                    return;
+                case TEXT_PI:
+                    emit_named(c, OP_PI, PI);
+                    break;
+                case TEXT_VARIABLE: {
+                    int var = math2_var_index(node->data.text.text);
+                    if(!strcmp(node->data.text.text, "e"))
+                        emit_named(c, OP_E, E);
+                    else if(var >= 0) emit_var(c, var);
+                    else fail(c, EVAL_UNSUPPORTED);
+                    break;
+                }
+                case TEXT_PAREN_OPEN:
+                    c->node = node->next;
+                    compile_sum(c);
+                    if(!is_text(c->node, TEXT_PAREN_CLOSE)) {
+                        fail(c, EVAL_SYNTAX);
+                        return;
+                    }
+                    break;
+                case TEXT_OPERATOR:
+                    if(is_operator(node, "+") || is_operator(node, "-") ||
+                       is_operator(node, "×") || is_operator(node, "÷"))
+                        fail(c, EVAL_SYNTAX);
+                    else
+                        fail(c, EVAL_UNSUPPORTED);
+                    return;
+                case TEXT_PAREN_CLOSE:
+                    fail(c, EVAL_SYNTAX);
+                    return;
+            }
+            break;
+
+        case NODE_FRACTION:
+            compile_sequence(c, node->data.frac.numer);
+            compile_sequence(c, node->data.frac.denom);
+            emit_op(c, OP_DIV);
+            break;
+        case NODE_EXPONENT:
+            compile_sequence(c, node->data.exp.base);
+            compile_sequence(c, node->data.exp.power);
+            emit_op(c, OP_POW);
+            break;
+        case NODE_ROOT:
+            compile_sequence(c, node->data.root.content);
+            if(node->data.root.index == 2) {
+                emit_op(c, OP_SQRT);
+            }
+            else {
+                char index[12];
+                snprintf(index, sizeof(index), "%d", node->data.root.index);
+                emit_number(c, index, node->data.root.index);
+                emit_op(c, OP_ROOT);
+            }
+            break;
+        case NODE_NTHROOT:
+            compile_sequence(c, node->data.nthroot.content);
+            compile_sequence(c, node->data.nthroot.index);
+            emit_op(c, OP_ROOT);
+            break;
+        case NODE_MIXED_FRAC:
+            compile_sequence(c, node->data.mixed.whole);
+            compile_sequence(c, node->data.mixed.numer);
+            compile_sequence(c, node->data.mixed.denom);
+            emit_op(c, OP_DIV);
+            emit_op(c, OP_ADD);
+            break;
+        case NODE_ABS:
+            compile_sequence(c, node->data.abs.content);
+            emit_op(c, OP_ABS);
+            break;
+        case NODE_PAREN:
+            compile_sequence(c, node->data.paren.content);
+            break;
+        case NODE_FUNCTION: {
+            size_t i = 0;
+            while(i < sizeof(functions) / sizeof(functions[0]) &&
+                  strcmp(functions[i].name, node->data.func.name)) i++;
+            if(i == sizeof(functions) / sizeof(functions[0])) {
+                fail(c, EVAL_UNSUPPORTED);
+                return;
+            }
+            compile_sequence(c, node->data.func.arg);
+            emit_op(c, functions[i].op);
+            break;
+        }
+        default:
+            /* Subscripts name variables that can't hold values */
+            fail(c, EVAL_UNSUPPORTED);
+            return;
+    }
+    c->node = c->node->next;
+}
+
+/* Operand with optional signs, which bind looser than powers */
+static void compile_signed(compiler_t *c)
+{
+    if(is_operator(c->node, "-")) {
+        c->node = c->node->next;
+        compile_signed(c);
+        emit_op(c, OP_NEG);
+    }
+    else if(is_operator(c->node, "+")) {
+        c->node = c->node->next;
+        compile_signed(c);
+    }
+    else {
+        compile_atom(c);
+    }
+}
+
+/* Check if a node starts an operand that is implicitly multiplied */
+static bool starts_operand(expr_node_t *node)
+{
+    return node && !is_text(node, TEXT_OPERATOR) &&
+           !is_text(node, TEXT_PAREN_CLOSE);
+}
+
+static void compile_product(compiler_t *c)
+{
+    compile_signed(c);
+    while(c->status == EVAL_OK) {
+        if(is_operator(c->node, "×") || is_operator(c->node, "÷")) {
+            uint8_t op = is_operator(c->node, "×") ? OP_MUL : OP_DIV;
+            c->node = c->node->next;
+            compile_signed(c);
+            emit_op(c, op);
+        }
+        else if(starts_operand(c->node)) {
+            compile_atom(c);
+            emit_op(c, OP_MUL);
+        }
+        else break;
+    }
+}
+
+static void compile_sum(compiler_t *c)
+{
+    compile_product(c);
+    while(c->status == EVAL_OK &&
+          (is_operator(c->node, "+") || is_operator(c->node, "-"))) {
+        uint8_t op = is_operator(c->node, "+") ? OP_ADD : OP_SUB;
+        c->node = c->node->next;
+        compile_product(c);
+        emit_op(c, op);
+    }
+}
+
+static void compile_sequence(compiler_t *c, expr_node_t *seq)
+{
+    if(c->status != EVAL_OK) return;
+    if(!seq || seq->type != NODE_SEQUENCE) {
+        fail(c, EVAL_SYNTAX);
+        return;
+    }
+
+    expr_node_t *saved = c->node;
+    c->node = seq->data.seq.first;
+    compile_sum(c);
+    if(c->node) {
+        /* Something that isn't an operand, like = or a closing bracket */
+        if(is_text(c->node, TEXT_OPERATOR) &&
+           !is_operator(c->node, "+") && !is_operator(c->node, "-") &&
+           !is_operator(c->node, "×") && !is_operator(c->node, "÷"))
+            fail(c, EVAL_UNSUPPORTED);
+        else
+            fail(c, EVAL_SYNTAX);
+    }
+    c->node = saved;
+}
+
+static math2_eval_status_t compile(math2_program_t *prog, expr_node_t *root,
+                                   bool exact)
+{
+    compiler_t c = { .prog = prog, .status = EVAL_OK, .exact = exact };
+    prog->len = 0;
+    prog->nconsts = 0;
+    prog->literals_len = 0;
+    prog->vars = 0;
+
+    if(!root || !root->data.seq.first) return EVAL_EMPTY;
+    compile_sequence(&c, root);
+    return c.status;
+}
+
+math2_eval_status_t math2_compile(math2_program_t *prog, expr_node_t *root)
+{
+    return compile(prog, root, false);
+}
+
+math2_eval_status_t math2_compile_exact(math2_program_t *prog,
+                                        expr_node_t *root)
+{
+    return compile(prog, root, true);
+}
+
+/* ===== Interpreter ===== */
+
+math2_eval_status_t math2_run(const math2_program_t *prog, const double *vars,
+                              double *result)
+{
+    if(prog->vars && !vars) return EVAL_NO_VALUE;
+
+    double stack[EVAL_STACK];
+    int sp = 0;
+
+    for(int pc = 0; pc < prog->len;) {
+        uint8_t op = prog->code[pc++];
+        if(op == OP_CONST) {
+            stack[sp++] = prog->consts[prog->code[pc++]];
+        }
+        else if(op == OP_VAR) {
+            stack[sp++] = vars[prog->code[pc++]];
+        }
+        else if(op == OP_LITERAL) {
+            stack[sp++] = strtod(prog->literals + prog->code[pc++], NULL);
+        }
+        else if(op == OP_PI || op == OP_E) {
+            stack[sp++] = (op == OP_PI) ? PI : E;
+        }
+        else if(IS_BINARY(op)) {
+            sp--;
+            stack[sp-1] = apply(op, stack[sp-1], stack[sp]);
+        }
+        else {
+            stack[sp-1] = apply(op, stack[sp-1], 0);
+        }
+    }
+
+    *result = stack[0];
+    return isfinite(*result) ? EVAL_OK : EVAL_MATH;
+}
+
+/* ===== Variables and Output ===== */
+
+int math2_var_index(const char *name)
+{
+    if(!name[0] || name[1]) return -1;
+    if(name[0] >= 'A' && name[0] <= 'Z') return name[0] - 'A';
+    if(name[0] >= 'a' && name[0] <= 'z') return 26 + name[0] - 'a';
+    return -1;
+}
+
+/* Write a number from its significant digits d.ddd × 10^e; fixed notation
+   is used for exponents from -4 to max_fixed - 1 */
+static void layout_number(bool negative, const char *digits, int nd, int e,
+                          int max_fixed, char *buf, int size)
+{
+    char tmp[EVAL_EXACT_DIGITS + 16];
+    int len = 0;
+
+    if(negative) tmp[len++] = '-';
+
+    if(e >= 0 && e < max_fixed) {
+        for(int i = 0; i <= e; i++) tmp[len++] = (i < nd) ? digits[i] : '0';
+        if(nd > e + 1) tmp[len++] = '.';
+        for(int i = e + 1; i < nd; i++) tmp[len++] = digits[i];
+    }
+    else if(e < 0 && e >= -4) {
+        tmp[len++] = '0';
+        tmp[len++] = '.';
+        for(int i = -1; i > e; i--) tmp[len++] = '0';
+        for(int i = 0; i < nd; i++) tmp[len++] = digits[i];
+    }
+    else {
+        tmp[len++] = digits[0];
+        if(nd > 1) tmp[len++] = '.';
+        for(int i = 1; i < nd; i++) tmp[len++] = digits[i];
+        len += sprintf(tmp + len, "e%d", e);
+    }
+    tmp[len] = '\0';
+
+    strncpy(buf, tmp, size - 1);
+    buf[size - 1] = '\0';
+}
+
+void math2_format_number(double value, char *buf, int size)
+{
+    if(value == 0 || !isfinite(value)) {
+        strncpy(buf, (value == 0) ? "0" : "undefined", size - 1);
+        buf[size - 1] = '\0';
+        return;
+    }
+    bool negative = (value < 0);
+    value = fabs(value);
+
+    /* Mantissa with EVAL_DIGITS digits; log10() may be off by one */
+    long long low = 1;
+    for(int i = 1; i < EVAL_DIGITS; i++) low *= 10;
+    int e = (int)floor(log10(value));
+    long long m = 0;
+    for(int tries = 0; tries < 3; tries++) {
+        int scale = EVAL_DIGITS - 1 - e;
+        double v = value;
+        while(scale > 300) v *= 1e100, scale -= 100;
+        while(scale < -300) v /= 1e100, scale += 100;
+        m = llround(v * pow(10, scale));
+        if(m >= low * 10) e++;
+        else if(m < low) e--;
+        else break;
+    }
+
+    char digits[EVAL_DIGITS];
+    for(int i = EVAL_DIGITS - 1; i >= 0; i--) {
+        digits[i] = '0' + m % 10;
+        m /= 10;
+    }
+    int nd = EVAL_DIGITS;
+    while(nd > 1 && digits[nd - 1] == '0') nd--;
+
+    layout_number(negative, digits, nd, e, EVAL_DIGITS, buf, size);
+}
+
+/* ===== Exact Evaluation ===== */
+
+/* Apply an operator to big decimals, a = a op b */
+static math2_eval_status_t apply_exact(uint8_t op, bigdec_t *a,
+                                       const bigdec_t *b)
+{
+    long long n;
+
+    switch(op) {
+        case OP_ADD: bigdec_add(a, a, b); break;
+        case OP_SUB: bigdec_sub(a, a, b); break;
+        case OP_MUL: bigdec_mul(a, a, b); break;
+        case OP_DIV:
+            if(!bigdec_div(a, a, b)) return EVAL_MATH;
+            break;
+        case OP_POW:
+            /* Fractional powers are left to the double evaluation */
+            if(!bigdec_to_int(b, &n) || n > EVAL_POW_MAX || n < -EVAL_POW_MAX)
+                return EVAL_UNSUPPORTED;
+            if(!bigdec_pow_int(a, a, n)) return EVAL_MATH;
+            break;
+        case OP_ROOT:
+            if(!bigdec_to_int(b, &n) || n < 1 || n > 65535)
+                return EVAL_UNSUPPORTED;
+            if(!bigdec_root(a, a, n)) return EVAL_MATH;
+            break;
+        case OP_NEG:  bigdec_neg(a, a); break;
+        case OP_ABS:  bigdec_abs(a, a); break;
+        case OP_SQRT:
+            if(!bigdec_sqrt(a, a)) return EVAL_MATH;
+            break;
+        default:
+            /* Transcendental functions */
+            return EVAL_UNSUPPORTED;
+    }
+
+    int e = bigdec_exponent(a);
+    if(e > EVAL_EXACT_EXP_MAX || e < -EVAL_EXACT_EXP_MAX) return EVAL_MATH;
+    return EVAL_OK;
+}
+
+math2_eval_status_t math2_run_exact(const math2_program_t *prog,
+                                    bigdec_t *result)
+{
+    static bigdec_t stack[EVAL_STACK];
+    int sp = 0;
+
+    if(prog->vars) return EVAL_NO_VALUE;
+    bigdec_set_digits(EVAL_EXACT_DIGITS);
+
+    for(int pc = 0; pc < prog->len;) {
+        uint8_t op = prog->code[pc++];
+        math2_eval_status_t status = EVAL_OK;
+
+        if(op == OP_CONST) {
+            bigdec_from_double(&stack[sp++], prog->consts[prog->code[pc++]]);
+        }
+        else if(op == OP_LITERAL) {
+            const char *text = prog->literals + prog->code[pc++];
+            if(!bigdec_from_string(&stack[sp++], text)) return EVAL_TOO_LONG;
+        }
+        else if(op == OP_PI) {
+            bigdec_pi(&stack[sp++]);
+        }
+        else if(op == OP_E) {
+            bigdec_e(&stack[sp++]);
+        }
+        else if(IS_BINARY(op)) {
+            sp--;
+            status = apply_exact(op, &stack[sp-1], &stack[sp]);
+        }
+        else {
+            status = apply_exact(op, &stack[sp-1], NULL);
+        }
+        if(status != EVAL_OK) return status;
+    }
+
+    *result = stack[0];
+    return EVAL_OK;
+}
+
+void math2_format_exact(const bigdec_t *value, int digits, char *buf,
+                        int size)
+{
+    char d[EVAL_EXACT_DIGITS];
+    int e;
+    if(digits > EVAL_EXACT_DIGITS) digits = EVAL_EXACT_DIGITS;
+    int nd = bigdec_digits(value, d, digits, &e);
+    layout_number(value->sign < 0, d, nd, e, digits, buf, size);
+}
+
+/* Continued fraction expansion of |x|, stopping at the first convergent
+   p/q that matches x to the working precision */
+bool math2_exact_fraction(const bigdec_t *x, long long *num, long long *den)
+{
+    bigdec_t abs_x, y, a, t, p, one;
+    long long p0 = 0, q0 = 1, p1 = 1, q1 = 0;
+
+    bigdec_set_digits(EVAL_EXACT_DIGITS);
+    bigdec_abs(&abs_x, x);
+    y = abs_x;
+    bigdec_from_int(&one, 1);
+
+    for(int i = 0; i < 64; i++) {
+        long long ai;
+        bigdec_trunc(&a, &y);
+        if(!bigdec_to_int(&a, &ai) || ai > EVAL_FRAC_MAX) return false;
+        if(p1 && ai > (EVAL_FRAC_MAX - p0) / p1) return false;
+        if(q1 && ai > (EVAL_FRAC_DEN_MAX - q0) / q1) return false;
+        long long p2 = ai * p1 + p0, q2 = ai * q1 + q0;
+
+        /* |x| q - p, within the last few digits of |x| q */
+        bigdec_from_int(&t, q2);
+        bigdec_mul(&t, &t, &abs_x);
+        int ref = bigdec_exponent(&t);
+        bigdec_from_int(&p, p2);
+        bigdec_sub(&t, &t, &p);
+        if(bigdec_is_zero(&t) || bigdec_exponent(&t) <
+           ref - (EVAL_EXACT_DIGITS - EVAL_FRAC_SLACK)) {
+            *num = (x->sign < 0) ? -p2 : p2;
+            *den = q2;
+            return true;
+        }
+
+        bigdec_sub(&y, &y, &a);
+        if(bigdec_is_zero(&y)) return false;
+        bigdec_div(&y, &one, &y);
+
+        p0 = p1, q0 = q1;
+        p1 = p2, q1 = q2;
+    }
+    return false;
+}
@@ -0,0 +1,109 @@
+/*
+ * math2-eval.h - Numeric evaluation of math2 expressions
+ *
+ * Expressions are compiled into a small stack bytecode, then run as many
+ * times as needed (for instance with different variable values) without
+ * walking the tree again. The compiler folds constant subexpressions, so an
+ * expression without variables compiles to a single constant.
+ *
+ * Grammar: sums of products, where products are explicit (×, ÷) or implicit
+ * (2π, 3x, 2√5), and unary signs bind looser than powers (-2² = -4).
+ * Adjacent digit nodes form one number, including the base of a following
+ * exponent (the editor puts only the last digit of 12² in the base).
+ * Angles are in radians, log is base 10, and e and π are constants.
+ *
+ * Programs run with doubles, or with big decimals (see bigdec.h) when
+ * compiled for exact evaluation, which gives many digits and fractions.
+ *
+ * This module does not depend on gint, see eval-bench.c.
+ */
+
+#ifndef MATH2_EVAL_H
+#define MATH2_EVAL_H
+
+#include "math2.h"
+#include "bigdec.h"
+#include <stdint.h>
+
+/* Program limits */
+#define EVAL_MAX_CODE   256     /* Bytes of bytecode */
+#define EVAL_MAX_CONSTS 64      /* Number constants */
+#define EVAL_STACK      32      /* Stack depth while running */
+#define EVAL_MAX_LITERALS 256   /* Bytes of number text in exact programs */
+
+/* Variables: A-Z are 0-25 and a-z are 26-51 */
+#define EVAL_VARS       52
+
+/* Significant digits shown by math2_format_number() */
+#define EVAL_DIGITS     10
+
+/* Exact evaluation: working precision in digits, largest integer power, and
+   largest power of 10 of results before they count as an overflow */
+#define EVAL_EXACT_DIGITS   32
+#define EVAL_POW_MAX        10000
+#define EVAL_EXACT_EXP_MAX  9999
+
+/* Fractions found by math2_exact_fraction(): largest numerator and
+   denominator, and digits of x that may differ from p/q */
+#define EVAL_FRAC_MAX       999999999999LL
+#define EVAL_FRAC_DEN_MAX   999999
+#define EVAL_FRAC_SLACK     6
+
+/* Evaluation results */
+typedef enum {
+    EVAL_OK,
+    EVAL_EMPTY,         /* Nothing to evaluate */
+    EVAL_SYNTAX,        /* Empty slot, missing operand, unbalanced bracket */
+    EVAL_UNSUPPORTED,   /* Symbol with no numeric meaning (=, →, i, ...) */
+    EVAL_TOO_LONG,      /* Exceeds the program limits */
+    EVAL_MATH,          /* Division by zero, out of domain or overflow */
+    EVAL_NO_VALUE,      /* Uses a variable that has no value */
+} math2_eval_status_t;
+
+/* Compiled expression */
+typedef struct {
+    uint8_t code[EVAL_MAX_CODE];
+    double consts[EVAL_MAX_CONSTS];
+    char literals[EVAL_MAX_LITERALS];
+    int len;                /* Bytes of code */
+    int nconsts;
+    int literals_len;
+    uint64_t vars;          /* Bit i set if variable i is used */
+} math2_program_t;
+
+/* Compile a sequence; the program is only usable if this returns EVAL_OK */
+math2_eval_status_t math2_compile(math2_program_t *prog, expr_node_t *root);
+
+/* Compile for math2_run_exact(): numbers are kept as written and nothing is
+   folded. math2_run() can run the result too. */
+math2_eval_status_t math2_compile_exact(math2_program_t *prog,
+                                        expr_node_t *root);
+
+/* Run a program. vars holds EVAL_VARS values, and may be NULL if the
+   program uses no variables (prog->vars == 0). */
+math2_eval_status_t math2_run(const math2_program_t *prog, const double *vars,
+                              double *result);
+
+/* Run a program with EVAL_EXACT_DIGITS big decimals. Transcendental
+   functions and fractional powers return EVAL_UNSUPPORTED; math2_run()
+   gives an approximation for those. Changes the bigdec precision. */
+math2_eval_status_t math2_run_exact(const math2_program_t *prog,
+                                    bigdec_t *result);
+
+/* Write an exact result rounded to the given number of digits (at most
+   EVAL_EXACT_DIGITS), like math2_format_number() */
+void math2_format_exact(const bigdec_t *value, int digits, char *buf,
+                        int size);
+
+/* Find a fraction num/den equal to an exact result, if there is one within
+   the EVAL_FRAC_* limits */
+bool math2_exact_fraction(const bigdec_t *x, long long *num, long long *den);
+
+/* Variable number for a variable name, or -1 if it can't hold a value */
+int math2_var_index(const char *name);
+
+/* Write a value with up to EVAL_DIGITS significant digits, in scientific
+   notation (1.5e-7) if it's very small or large */
+void math2_format_number(double value, char *buf, int size);
+
+#endif /* MATH2_EVAL_H */
@@ -0,0 +1,547 @@
+/*
+ * math2-format.c - Output formats for math2 expressions
+ */
+
+#include "math2-format.h"
+#include <string.h>
+#include <stdio.h>
+
+/* ===== Shared Helpers ===== */
+
+static bool is_letter(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           (unsigned char)c >= 0x80;
+}
+
+static bool is_alnum(char c)
+{
+    return is_letter(c) || (c >= '0' && c <= '9') || c == '.';
+}
+
+static char last_char(const math2_out_t *out)
+{
+    return out->len > 0 ? out->buf[out->len - 1] : '\0';
+}
+
+/* Check if a sequence is a single operand that linear formats can use as a
+   fraction or script argument without parentheses: a number, or a single
+   letter or symbol */
+static bool is_single_operand(expr_node_t *seq)
+{
+    if(!seq || seq->type != NODE_SEQUENCE) return false;
+
+    expr_node_t *first = seq->data.seq.first;
+    if(!first || first->type != NODE_TEXT) return false;
+
+    if(first->data.text.subtype == TEXT_NUMBER) {
+        for(expr_node_t *n = first; n; n = n->next) {
+            if(n->type != NODE_TEXT || n->data.text.subtype != TEXT_NUMBER)
+                return false;
+        }
+        return true;
+    }
+    if(first->next) return false;
+    if(first->data.text.subtype == TEXT_PI) return true;
+    return first->data.text.subtype == TEXT_VARIABLE &&
+           is_letter(first->data.text.text[0]);
+}
+
+/* ===== LaTeX ===== */
+
+static void write_latex(math2_out_t *out, expr_node_t *root, bool compact)
+{
+    math2_write_latex(out, root, compact ? LATEX_COMPACT : LATEX_VERBOSE);
+}
+
+/* ===== AsciiMath and UnicodeMath ===== */
+
+/* Both formats are linear with the same structure: a/b, a^b, a_b, where
+   parentheses around an argument group it and are not displayed. They only
+   differ in the spelling of symbols. */
+typedef struct {
+    const char *name_prefix;    /* Before symbol names: pi, \pi */
+    const char *times;
+    const char *divide;
+    const char *sqrt;
+    bool root_with_amp;         /* \sqrt(n&x) instead of root(n)(x) */
+} linear_syntax_t;
+
+static const linear_syntax_t asciimath_syntax = {
+    .name_prefix = "",
+    .times = "xx",
+    .divide = "-:",
+    .sqrt = "sqrt",
+    .root_with_amp = false,
+};
+
+/* UnicodeMath as entered on a keyboard: Word's math autocorrect turns the
+   control words into the Unicode symbols */
+static const linear_syntax_t unicodemath_syntax = {
+    .name_prefix = "\\",
+    .times = "\\times",
+    .divide = "\\div",
+    .sqrt = "\\sqrt",
+    .root_with_amp = true,
+};
+
+/* What the next token must be separated from with a space */
+typedef enum {
+    SEP_NONE,
+    SEP_LETTER,         /* After a name, which a letter would extend */
+    SEP_ALNUM,          /* After a bare operand, which any operand extends */
+} linear_sep_t;
+
+typedef struct {
+    math2_out_t *out;
+    const linear_syntax_t *syntax;
+    bool compact;
+    linear_sep_t sep;
+} linear_t;
+
+static void linear_sequence(linear_t *w, expr_node_t *seq);
+
+static void linear_emit(linear_t *w, const char *str)
+{
+    char c = str[0];
+    if((w->sep == SEP_LETTER && is_letter(c)) ||
+       (w->sep == SEP_ALNUM && is_alnum(c)))
+        math2_out_char(w->out, ' ');
+    math2_out_put(w->out, str);
+    w->sep = SEP_NONE;
+}
+
+/* Emit a name (sqrt, \pi, alpha); a letter before or after it would be
+   read as part of it */
+static void linear_name(linear_t *w, const char *name)
+{
+    if(is_letter(name[0]) && is_letter(last_char(w->out)))
+        w->sep = SEP_LETTER;
+    linear_emit(w, name);
+    w->sep = SEP_LETTER;
+}
+
+static void linear_symbol(linear_t *w, const char *name)
+{
+    char tmp[16];
+    snprintf(tmp, sizeof(tmp), "%s%s", w->syntax->name_prefix, name);
+    linear_name(w, tmp);
+}
+
+/* Emit a sequence as an argument; bare if it's a single operand, else
+   grouped with parentheses */
+static void linear_operand(linear_t *w, expr_node_t *seq)
+{
+    if(w->compact && is_single_operand(seq)) {
+        if(is_alnum(last_char(w->out))) w->sep = SEP_ALNUM;
+        linear_sequence(w, seq);
+        w->sep = SEP_ALNUM;
+        return;
+    }
+    linear_emit(w, "(");
+    linear_sequence(w, seq);
+    linear_emit(w, ")");
+}
+
+/* Emit the base of a script; unlike arguments, parentheses around it are
+   displayed, so they are only used when needed */
+static void linear_base(linear_t *w, expr_node_t *seq)
+{
+    bool compact = w->compact;
+    w->compact = true;
+    linear_operand(w, seq);
+    w->compact = compact;
+}
+
+static void linear_delimited(linear_t *w, expr_node_t *seq,
+                             const char *open, const char *close)
+{
+    linear_emit(w, open);
+    linear_sequence(w, seq);
+    linear_emit(w, close);
+}
+
+/* Emit a root with either a fixed or an editable index */
+static void linear_root(linear_t *w, const char *index, expr_node_t *index_seq,
+                        expr_node_t *content)
+{
+    if(w->syntax->root_with_amp) {
+        linear_name(w, w->syntax->sqrt);
+        linear_emit(w, "(");
+        if(index) linear_emit(w, index);
+        else linear_sequence(w, index_seq);
+        linear_emit(w, "&");
+        linear_sequence(w, content);
+        linear_emit(w, ")");
+        return;
+    }
+
+    linear_name(w, "root");
+    if(index && w->compact) {
+        linear_emit(w, index);
+        w->sep = SEP_ALNUM;
+    } else if(index) {
+        linear_emit(w, "(");
+        linear_emit(w, index);
+        linear_emit(w, ")");
+    } else {
+        linear_operand(w, index_seq);
+    }
+    linear_operand(w, content);
+}
+
+static void linear_text(linear_t *w, expr_node_t *node)
+{
+    const char *text = node->data.text.text;
+
+    if(strcmp(text, "×") == 0) {
+        linear_name(w, w->syntax->times);
+    } else if(strcmp(text, "÷") == 0) {
+        linear_name(w, w->syntax->divide);
+    } else if(node->data.text.subtype == TEXT_PI || math2_symbol_name(text)) {
+        const char *name = math2_symbol_name(text);
+        linear_symbol(w, name ? name : "pi");
+    } else {
+        linear_emit(w, text);
+    }
+}
+
+static void linear_node(linear_t *w, expr_node_t *node)
+{
+    switch(node->type) {
+        case NODE_SEQUENCE:
+            linear_sequence(w, node);
+            break;
+
+        case NODE_TEXT:
+            linear_text(w, node);
+            break;
+
+        case NODE_FRACTION:
+            linear_operand(w, node->data.frac.numer);
+            linear_emit(w, "/");
+            linear_operand(w, node->data.frac.denom);
+            break;
+
+        case NODE_EXPONENT:
+            linear_base(w, node->data.exp.base);
+            linear_emit(w, "^");
+            linear_operand(w, node->data.exp.power);
+            break;
+
+        case NODE_SUBSCRIPT:
+            linear_base(w, node->data.subscript.base);
+            linear_emit(w, "_");
+            linear_operand(w, node->data.subscript.sub);
+            break;
+
+        case NODE_ROOT:
+            if(node->data.root.index == 2) {
+                linear_name(w, w->syntax->sqrt);
+                linear_operand(w, node->data.root.content);
+            } else {
+                char index[8];
+                snprintf(index, sizeof(index), "%d", node->data.root.index);
+                linear_root(w, index, NULL, node->data.root.content);
+            }
+            break;
+
+        case NODE_NTHROOT:
+            linear_root(w, NULL, node->data.nthroot.index,
+                        node->data.nthroot.content);
+            break;
+
+        case NODE_ABS:
+            linear_delimited(w, node->data.abs.content, "|", "|");
+            break;
+
+        case NODE_PAREN:
+            linear_delimited(w, node->data.paren.content, "(", ")");
+            break;
+
+        case NODE_FUNCTION:
+            linear_name(w, node->data.func.name);
+            linear_delimited(w, node->data.func.arg, "(", ")");
+            break;
+
+        case NODE_MIXED_FRAC:
+            linear_sequence(w, node->data.mixed.whole);
+            linear_operand(w, node->data.mixed.numer);
+            linear_emit(w, "/");
+            linear_operand(w, node->data.mixed.denom);
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void linear_sequence(linear_t *w, expr_node_t *seq)
+{
+    if(!seq || seq->type != NODE_SEQUENCE) return;
+
+    for(expr_node_t *child = seq->data.seq.first; child; child = child->next)
+        linear_node(w, child);
+}
+
+static void write_linear(math2_out_t *out, expr_node_t *root, bool compact,
+                         const linear_syntax_t *syntax)
+{
+    linear_t w = { out, syntax, compact, SEP_NONE };
+    linear_sequence(&w, root);
+}
+
+static void write_asciimath(math2_out_t *out, expr_node_t *root, bool compact)
+{
+    write_linear(out, root, compact, &asciimath_syntax);
+}
+
+static void write_unicodemath(math2_out_t *out, expr_node_t *root,
+                              bool compact)
+{
+    write_linear(out, root, compact, &unicodemath_syntax);
+}
+
+/* ===== MathML ===== */
+
+typedef struct {
+    math2_out_t *out;
+    bool compact;
+} mathml_t;
+
+static void mathml_element(mathml_t *w, expr_node_t *node);
+
+/* Emit text content, escaping markup and writing non-ASCII characters as
+   character references */
+static void mathml_text(mathml_t *w, const char *text)
+{
+    const unsigned char *s = (const unsigned char *)text;
+
+    while(*s) {
+        if(*s < 0x80) {
+            if(*s == '<') math2_out_put(w->out, "&lt;");
+            else if(*s == '>') math2_out_put(w->out, "&gt;");
+            else if(*s == '&') math2_out_put(w->out, "&amp;");
+            else math2_out_char(w->out, *s);
+            s++;
+            continue;
+        }
+
+        /* Decode one UTF-8 sequence */
+        int extra = (*s >= 0xf0) ? 3 : (*s >= 0xe0) ? 2 : 1;
+        unsigned int cp = *s++ & (0x3f >> extra);
+        while(extra-- > 0 && (*s & 0xc0) == 0x80)
+            cp = (cp << 6) | (*s++ & 0x3f);
+
+        char ref[12];
+        snprintf(ref, sizeof(ref), "&#x%X;", cp);
+        math2_out_put(w->out, ref);
+    }
+}
+
+static void mathml_token(mathml_t *w, const char *tag, const char *text)
+{
+    math2_out_char(w->out, '<');
+    math2_out_put(w->out, tag);
+    math2_out_char(w->out, '>');
+    mathml_text(w, text);
+    math2_out_put(w->out, "</");
+    math2_out_put(w->out, tag);
+    math2_out_char(w->out, '>');
+}
+
+static bool is_number(expr_node_t *node)
+{
+    return node && node->type == NODE_TEXT &&
+           node->data.text.subtype == TEXT_NUMBER;
+}
+
+/* Emit the children of a sequence; runs of digits form a single <mn> */
+static void mathml_children(mathml_t *w, expr_node_t *seq)
+{
+    if(!seq || seq->type != NODE_SEQUENCE) return;
+
+    for(expr_node_t *child = seq->data.seq.first; child; child = child->next) {
+        if(!is_number(child)) {
+            mathml_element(w, child);
+            continue;
+        }
+        math2_out_put(w->out, "<mn>");
+        mathml_text(w, child->data.text.text);
+        while(is_number(child->next)) {
+            child = child->next;
+            mathml_text(w, child->data.text.text);
+        }
+        math2_out_put(w->out, "</mn>");
+    }
+}
+
+/* Emit a sequence as a single element, as required for the arguments of
+   <mfrac>, <msup>, etc. */
+static void mathml_slot(mathml_t *w, expr_node_t *seq)
+{
+    int count = 0;
+    if(seq && seq->type == NODE_SEQUENCE) {
+        for(expr_node_t *c = seq->data.seq.first; c; c = c->next) {
+            if(!is_number(c) || !is_number(c->prev)) count++;
+        }
+    }
+
+    if(w->compact && count == 1) {
+        mathml_children(w, seq);
+        return;
+    }
+    if(w->compact && count == 0) {
+        math2_out_put(w->out, "<mrow/>");
+        return;
+    }
+    math2_out_put(w->out, "<mrow>");
+    mathml_children(w, seq);
+    math2_out_put(w->out, "</mrow>");
+}
+
+static void mathml_fenced(mathml_t *w, expr_node_t *seq, const char *open,
+                          const char *close)
+{
+    math2_out_put(w->out, "<mrow>");
+    mathml_token(w, "mo", open);
+    mathml_children(w, seq);
+    mathml_token(w, "mo", close);
+    math2_out_put(w->out, "</mrow>");
+}
+
+static void mathml_text_node(mathml_t *w, expr_node_t *node)
+{
+    const char *text = node->data.text.text;
+
+    switch(node->data.text.subtype) {
+        case TEXT_NUMBER:
+            mathml_token(w, "mn", text);
+            break;
+        case TEXT_PI:
+            mathml_token(w, "mi", "π");
+            break;
+        case TEXT_VARIABLE:
+            if(is_letter(text[0])) mathml_token(w, "mi", text);
+            else if(text[0] == ' ') math2_out_put(w->out, "<mspace width=\"0.5em\"/>");
+            else mathml_token(w, "mo", text);
+            break;
+        default:
+            mathml_token(w, "mo", text);
+            break;
+    }
+}
+
+static void mathml_element(mathml_t *w, expr_node_t *node)
+{
+    char index[8];
+
+    switch(node->type) {
+        case NODE_SEQUENCE:
+            mathml_slot(w, node);
+            break;
+
+        case NODE_TEXT:
+            mathml_text_node(w, node);
+            break;
+
+        case NODE_FRACTION:
+            math2_out_put(w->out, "<mfrac>");
+            mathml_slot(w, node->data.frac.numer);
+            mathml_slot(w, node->data.frac.denom);
+            math2_out_put(w->out, "</mfrac>");
+            break;
+
+        case NODE_EXPONENT:
+            math2_out_put(w->out, "<msup>");
+            mathml_slot(w, node->data.exp.base);
+            mathml_slot(w, node->data.exp.power);
+            math2_out_put(w->out, "</msup>");
+            break;
+
+        case NODE_SUBSCRIPT:
+            math2_out_put(w->out, "<msub>");
+            mathml_slot(w, node->data.subscript.base);
+            mathml_slot(w, node->data.subscript.sub);
+            math2_out_put(w->out, "</msub>");
+            break;
+
+        case NODE_ROOT:
+            if(node->data.root.index == 2) {
+                math2_out_put(w->out, "<msqrt>");
+                mathml_children(w, node->data.root.content);
+                math2_out_put(w->out, "</msqrt>");
+                break;
+            }
+            snprintf(index, sizeof(index), "%d", node->data.root.index);
+            math2_out_put(w->out, "<mroot>");
+            mathml_slot(w, node->data.root.content);
+            mathml_token(w, "mn", index);
+            math2_out_put(w->out, "</mroot>");
+            break;
+
+        case NODE_NTHROOT:
+            math2_out_put(w->out, "<mroot>");
+            mathml_slot(w, node->data.nthroot.content);
+            mathml_slot(w, node->data.nthroot.index);
+            math2_out_put(w->out, "</mroot>");
+            break;
+
+        case NODE_ABS:
+            mathml_fenced(w, node->data.abs.content, "|", "|");
+            break;
+
+        case NODE_PAREN:
+            mathml_fenced(w, node->data.paren.content, "(", ")");
+            break;
+
+        case NODE_FUNCTION:
+            math2_out_put(w->out, "<mrow>");
+            mathml_token(w, "mi", node->data.func.name);
+            /* U+2061 FUNCTION APPLICATION */
+            if(!w->compact) math2_out_put(w->out, "<mo>&#x2061;</mo>");
+            mathml_fenced(w, node->data.func.arg, "(", ")");
+            math2_out_put(w->out, "</mrow>");
+            break;
+
+        case NODE_MIXED_FRAC:
+            math2_out_put(w->out, "<mrow>");
+            mathml_children(w, node->data.mixed.whole);
+            math2_out_put(w->out, "<mfrac>");
+            mathml_slot(w, node->data.mixed.numer);
+            mathml_slot(w, node->data.mixed.denom);
+            math2_out_put(w->out, "</mfrac></mrow>");
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void write_mathml(math2_out_t *out, expr_node_t *root, bool compact)
+{
+    mathml_t w = { out, compact };
+
+    if(compact) math2_out_put(out, "<math>");
+    else math2_out_put(out, "<math xmlns=\"http://www.w3.org/1998/Math/MathML\">");
+    mathml_children(&w, root);
+    math2_out_put(out, "</math>");
+}
+
+/* ===== Format Registry ===== */
+
+const math2_format_t math2_formats[FORMAT_COUNT] = {
+    [FORMAT_LATEX]       = { "LaTeX",       write_latex },
+    [FORMAT_ASCIIMATH]   = { "AsciiMath",   write_asciimath },
+    [FORMAT_UNICODEMATH] = { "UnicodeMath", write_unicodemath },
+    [FORMAT_MATHML]      = { "MathML",      write_mathml },
+};
+
+bool math2_to_format(math_expr2_t *expr, math2_format_id_t format,
+                     bool compact)
+{
+    math2_out_t out;
+    math2_out_init(&out, expr->latex, MAX_LATEX);
+    math2_formats[format].write(&out, expr->root, compact);
+    return !out.overflow;
+}
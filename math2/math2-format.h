@@ -0,0 +1,41 @@
+/*
+ * math2-format.h - Output formats for math2 expressions
+ *
+ * Each format is a serializer that walks the expression tree and writes to
+ * a math2_out_t. Target apps accept different linear formats, and the
+ * shorter ones (AsciiMath, UnicodeMath) need far fewer keystrokes than
+ * LaTeX. All formats only produce ASCII for typable content: the names of
+ * math2_symbol_name(), as \alpha or alpha, replace non-ASCII characters, and
+ * MathML uses character references.
+ */
+
+#ifndef MATH2_FORMAT_H
+#define MATH2_FORMAT_H
+
+#include "math2.h"
+
+/* Available formats */
+typedef enum {
+    FORMAT_LATEX,           /* \frac{1}{2}, see math2_write_latex() */
+    FORMAT_ASCIIMATH,       /* 1/2, sqrt x, x^(n+1) */
+    FORMAT_UNICODEMATH,     /* 1/2, \sqrt x, x^(n+1), as typed in Word */
+    FORMAT_MATHML,          /* <math><mfrac><mn>1</mn>...</math> */
+    FORMAT_COUNT,
+} math2_format_id_t;
+
+/* Output format */
+typedef struct {
+    const char *name;       /* Name shown in the settings and preview */
+    /* Write the root sequence; compact asks for the shortest equivalent
+       output, otherwise every argument is grouped explicitly */
+    void (*write)(math2_out_t *out, expr_node_t *root, bool compact);
+} math2_format_t;
+
+extern const math2_format_t math2_formats[FORMAT_COUNT];
+
+/* Generate the expression in the given format into expr->latex
+   Returns false if the output was truncated to MAX_LATEX. */
+bool math2_to_format(math_expr2_t *expr, math2_format_id_t format,
+                     bool compact);
+
+#endif /* MATH2_FORMAT_H */
@@ -4,9 +4,13 @@
 
 #include "math2.h"
 #include <gint/display.h>
+#include <gint/image.h>
 #include <gint/keyboard.h>
 #include <string.h>
+#include <stdlib.h>
+#include <limits.h>
 #include <stdio.h>
+#include <stdint.h>
 
 /* ===== Constants ===== */
 
@@ -17,6 +21,10 @@
 #define EXP_SCALE   70      
 #define ROOT_PAD    4       
 
+/* Bitmap cache: maximum entries and total bitmap memory */
+#define CACHE_ENTRIES   16
+#define CACHE_BUDGET    (48 * 1024)
+
 /* Colors */
 #define COL_TEXT        C_BLACK
 #define COL_CURSOR      C_RGB(0, 0, 31)
@@ -41,6 +49,9 @@ bool g_color_brackets = true;
 /* Cursor flash state (controlled externally) */
 bool g_cursor_visible = true;
 
+/* Number of edits to the expression trees so far */
+static unsigned int g_edit_count = 0;
+
 /* ===== Node Pool Management ===== */
 
 void math2_init(math_expr2_t *expr)
@@ -55,6 +66,7 @@ void math2_init(math_expr2_t *expr)
     
     /* Create root sequence */
     expr->root = math2_new_sequence(expr);
+    g_edit_count++;
     
     /* Initialize cursor at start of root */
     expr->cursor.sequence = expr->root;
@@ -62,6 +74,8 @@ void math2_init(math_expr2_t *expr)
     
     expr->shift_mode = false;
     expr->alpha_mode = false;
+    
+    math2_cache_flush();
 }
 
 expr_node_t *math2_alloc_node(math_expr2_t *expr, node_type_t type)
@@ -73,6 +87,7 @@ expr_node_t *math2_alloc_node(math_expr2_t *expr, node_type_t type)
             expr_node_t *node = &expr->nodes[idx];
             memset(node, 0, sizeof(*node));
             node->type = type;
+            node->dirty = true;
             expr->next_free = (idx + 1) % MAX_NODES;
             return node;
         }
@@ -146,12 +161,163 @@ expr_node_t *math2_new_sequence(math_expr2_t *expr)
     return seq;
 }
 
+/* Pointers to the child sequences of a container */
+static int child_slots(expr_node_t *node, expr_node_t **slots[3])
+{
+    switch(node->type) {
+        case NODE_FRACTION:
+            slots[0] = &node->data.frac.numer;
+            slots[1] = &node->data.frac.denom;
+            return 2;
+        case NODE_EXPONENT:
+            slots[0] = &node->data.exp.base;
+            slots[1] = &node->data.exp.power;
+            return 2;
+        case NODE_SUBSCRIPT:
+            slots[0] = &node->data.subscript.base;
+            slots[1] = &node->data.subscript.sub;
+            return 2;
+        case NODE_ROOT:
+            slots[0] = &node->data.root.content;
+            return 1;
+        case NODE_NTHROOT:
+            slots[0] = &node->data.nthroot.index;
+            slots[1] = &node->data.nthroot.content;
+            return 2;
+        case NODE_ABS:
+            slots[0] = &node->data.abs.content;
+            return 1;
+        case NODE_PAREN:
+            slots[0] = &node->data.paren.content;
+            return 1;
+        case NODE_FUNCTION:
+            slots[0] = &node->data.func.arg;
+            return 1;
+        case NODE_MIXED_FRAC:
+            slots[0] = &node->data.mixed.whole;
+            slots[1] = &node->data.mixed.numer;
+            slots[2] = &node->data.mixed.denom;
+            return 3;
+        default:
+            return 0;
+    }
+}
+
+/* Deep copies: the source nodes in pre-order, their copies, and for each
+   pool node its position + 1 in the source list (0 when not in it) */
+static expr_node_t *g_clone_src[MAX_NODES];
+static expr_node_t *g_clone_dst[MAX_NODES];
+static uint16_t g_clone_pos[MAX_NODES];
+
+/* Add a node and its subtree to the source list */
+static int clone_collect(expr_node_t *node, int n)
+{
+    g_clone_src[n++] = node;
+    if(node->type == NODE_SEQUENCE) {
+        for(expr_node_t *child = node->data.seq.first; child; child = child->next)
+            n = clone_collect(child, n);
+        return n;
+    }
+    
+    expr_node_t **slots[3];
+    int count = child_slots(node, slots);
+    for(int i = 0; i < count; i++) {
+        if(*slots[i]) n = clone_collect(*slots[i], n);
+    }
+    return n;
+}
+
+/* Take count free nodes in a single pass over the pool, or none at all */
+static bool pool_take(math_expr2_t *expr, expr_node_t **nodes, int count)
+{
+    int n = 0;
+    for(int i = 0; i < MAX_NODES && n < count; i++) {
+        int idx = (expr->next_free + i) % MAX_NODES;
+        if(expr->nodes[idx].type == NODE_EMPTY) nodes[n++] = &expr->nodes[idx];
+    }
+    if(n < count) return false;
+    
+    expr->next_free = (nodes[count - 1] - expr->nodes + 1) % MAX_NODES;
+    return true;
+}
+
+/* Copy of a source node, or NULL for links that leave the copied nodes */
+static expr_node_t *clone_map(math_expr2_t *expr, expr_node_t *node)
+{
+    int pos = node ? g_clone_pos[node - expr->nodes] : 0;
+    return pos ? g_clone_dst[pos - 1] : NULL;
+}
+
+/* Copy the nodes first..last of a sequence with their subtrees. The copies
+   are linked to each other but have no parent; returns the copy of first
+   and sets *copy_last, or returns NULL if the pool is too full. */
+static expr_node_t *clone_range(math_expr2_t *expr, expr_node_t *first,
+                                expr_node_t *last, expr_node_t **copy_last)
+{
+    int n = 0;
+    for(expr_node_t *node = first; node; node = node->next) {
+        n = clone_collect(node, n);
+        if(node == last) break;
+    }
+    if(!pool_take(expr, g_clone_dst, n)) return NULL;
+    
+    for(int i = 0; i < n; i++)
+        g_clone_pos[g_clone_src[i] - expr->nodes] = i + 1;
+    
+    /* Copy and relink every node in one pass */
+    for(int i = 0; i < n; i++) {
+        expr_node_t *src = g_clone_src[i];
+        expr_node_t *dst = g_clone_dst[i];
+        
+        *dst = *src;
+        dst->parent = clone_map(expr, src->parent);
+        dst->next = clone_map(expr, src->next);
+        dst->prev = clone_map(expr, src->prev);
+        dst->dirty = true;
+        
+        if(dst->type == NODE_SEQUENCE) {
+            dst->data.seq.first = clone_map(expr, src->data.seq.first);
+            dst->data.seq.last = clone_map(expr, src->data.seq.last);
+        } else {
+            expr_node_t **slots[3];
+            int count = child_slots(dst, slots);
+            for(int j = 0; j < count; j++)
+                *slots[j] = clone_map(expr, *slots[j]);
+        }
+    }
+    
+    *copy_last = clone_map(expr, last);
+    for(int i = 0; i < n; i++)
+        g_clone_pos[g_clone_src[i] - expr->nodes] = 0;
+    return g_clone_dst[0];
+}
+
+expr_node_t *math2_clone(math_expr2_t *expr, expr_node_t *node)
+{
+    expr_node_t *last;
+    return node ? clone_range(expr, node, node, &last) : NULL;
+}
+
 /* ===== Sequence Operations ===== */
 
+/* Mark a sequence and its ancestors as changed for the bitmap cache, and
+   count the edit for everything else */
+static void mark_dirty(expr_node_t *node)
+{
+    g_edit_count++;
+    for(; node; node = node->parent) node->dirty = true;
+}
+
+unsigned int math2_edit_count(void)
+{
+    return g_edit_count;
+}
+
 void seq_insert_after(expr_node_t *seq, expr_node_t *after, expr_node_t *node)
 {
     if(!seq || !node || seq->type != NODE_SEQUENCE) return;
     
+    mark_dirty(seq);
     node->parent = seq;
     
     if(after == NULL) {
@@ -186,6 +352,7 @@ void seq_remove(expr_node_t *node)
     expr_node_t *seq = node->parent;
     if(seq->type != NODE_SEQUENCE) return;
     
+    mark_dirty(seq);
     if(node->prev) {
         node->prev->next = node->next;
     } else {
@@ -208,6 +375,40 @@ bool seq_is_empty(expr_node_t *seq)
     return seq && seq->type == NODE_SEQUENCE && seq->data.seq.first == NULL;
 }
 
+/* Insert a chain of linked nodes without a parent after a position */
+static void seq_insert_chain(expr_node_t *seq, expr_node_t *after,
+                             expr_node_t *first, expr_node_t *last)
+{
+    mark_dirty(seq);
+    for(expr_node_t *node = first; node; node = node->next)
+        node->parent = seq;
+    
+    expr_node_t *next = after ? after->next : seq->data.seq.first;
+    first->prev = after;
+    last->next = next;
+    if(after) after->next = first;
+    else seq->data.seq.first = first;
+    if(next) next->prev = last;
+    else seq->data.seq.last = last;
+}
+
+/* Remove the nodes first..last from their sequence, as a chain */
+static void seq_remove_chain(expr_node_t *first, expr_node_t *last)
+{
+    expr_node_t *seq = first->parent;
+    
+    mark_dirty(seq);
+    if(first->prev) first->prev->next = last->next;
+    else seq->data.seq.first = last->next;
+    if(last->next) last->next->prev = first->prev;
+    else seq->data.seq.last = first->prev;
+    
+    first->prev = NULL;
+    last->next = NULL;
+    for(expr_node_t *node = first; node; node = node->next)
+        node->parent = NULL;
+}
+
 /* ===== Cursor Operations ===== */
 
 bool cursor_left(math_expr2_t *expr)
@@ -830,14 +1031,138 @@ void math2_clear(math_expr2_t *expr)
     }
     expr->root->data.seq.first = NULL;
     expr->root->data.seq.last = NULL;
+    mark_dirty(expr->root);
+    math2_cache_flush();
     
     /* Reset cursor to root */
     expr->cursor.sequence = expr->root;
     expr->cursor.after = NULL;
+    expr->selecting = false;
     
     math2_clear_modes(expr);
 }
 
+/* ===== Selection and Clipboard ===== */
+
+void math2_select_start(math_expr2_t *expr)
+{
+    expr->selecting = true;
+    expr->sel_anchor = expr->cursor;
+}
+
+void math2_select_end(math_expr2_t *expr)
+{
+    expr->selecting = false;
+}
+
+bool math2_get_selection(math_expr2_t *expr, expr_node_t **first,
+                         expr_node_t **last)
+{
+    expr_node_t *seq = expr->cursor.sequence;
+    expr_node_t *a = expr->sel_anchor.after;
+    expr_node_t *b = expr->cursor.after;
+    
+    if(!expr->selecting || expr->sel_anchor.sequence != seq || a == b)
+        return false;
+    /* The anchor node may have been deleted since */
+    if(a && (a->type == NODE_EMPTY || a->parent != seq)) return false;
+    
+    /* Order the two positions */
+    bool ordered = (a == NULL);
+    if(!ordered && b) {
+        for(expr_node_t *node = a->next; node; node = node->next) {
+            if(node == b) {
+                ordered = true;
+                break;
+            }
+        }
+    }
+    if(!ordered) {
+        expr_node_t *tmp = a;
+        a = b;
+        b = tmp;
+    }
+    
+    *first = a ? a->next : seq->data.seq.first;
+    *last = b;
+    return true;
+}
+
+static void free_chain(math_expr2_t *expr, expr_node_t *node)
+{
+    while(node) {
+        expr_node_t *next = node->next;
+        math2_free_node(expr, node);
+        node = next;
+    }
+}
+
+static void delete_range(math_expr2_t *expr, expr_node_t *first,
+                         expr_node_t *last)
+{
+    expr->cursor.after = first->prev;
+    expr->selecting = false;
+    seq_remove_chain(first, last);
+    free_chain(expr, first);
+}
+
+bool math2_copy(math_expr2_t *expr)
+{
+    expr_node_t *first, *last, *copy_last;
+    if(!math2_get_selection(expr, &first, &last)) return false;
+    
+    expr_node_t *copy = clone_range(expr, first, last, &copy_last);
+    if(!copy) return false;
+    
+    expr_node_t *clip = math2_new_sequence(expr);
+    if(!clip) {
+        free_chain(expr, copy);
+        return false;
+    }
+    seq_insert_chain(clip, NULL, copy, copy_last);
+    
+    math2_free_node(expr, expr->clipboard);
+    expr->clipboard = clip;
+    expr->selecting = false;
+    return true;
+}
+
+bool math2_cut(math_expr2_t *expr)
+{
+    expr_node_t *first, *last;
+    if(!math2_get_selection(expr, &first, &last)) return false;
+    if(!math2_copy(expr)) return false;
+    
+    delete_range(expr, first, last);
+    return true;
+}
+
+bool math2_delete_selection(math_expr2_t *expr)
+{
+    expr_node_t *first, *last;
+    if(!math2_get_selection(expr, &first, &last)) return false;
+    
+    delete_range(expr, first, last);
+    return true;
+}
+
+bool math2_paste(math_expr2_t *expr)
+{
+    expr_node_t *clip = expr->clipboard, *last;
+    if(!clip || !clip->data.seq.first) return false;
+    
+    /* Copy first, so that a full pool leaves the selection alone */
+    expr_node_t *copy = clone_range(expr, clip->data.seq.first,
+                                    clip->data.seq.last, &last);
+    if(!copy) return false;
+    
+    math2_delete_selection(expr);
+    expr->selecting = false;
+    seq_insert_chain(expr->cursor.sequence, expr->cursor.after, copy, last);
+    expr->cursor.after = last;
+    return true;
+}
+
 /* ===== Rendering ===== */
 
 /* Scale dimensions by percentage */
@@ -1042,6 +1367,7 @@ metrics_t math2_measure(expr_node_t *node, int font_scale)
             break;
     }
     
+    node->box = m;
     return m;
 }
 
@@ -1077,17 +1403,27 @@ static metrics_t measure_sequence(expr_node_t *seq, int font_scale)
         m.baseline = m.height / 2;
     }
     
+    seq->box = m;
     return m;
 }
 
-/* Draw placeholder box for empty slot */
-static void draw_placeholder(int x, int y, int w, int h, bool is_cursor_here)
+/* Metrics of a node from the last measure pass */
+static metrics_t node_box(expr_node_t *node)
 {
-    if(is_cursor_here && g_cursor_visible) {
-        drect(x, y, x + w - 1, y + h - 1, COL_CURSOR);
-    } else {
-        drect_border(x, y, x + w - 1, y + h - 1, C_WHITE, 1, COL_PLACEHOLDER);
+    metrics_t none = {0, 0, 0};
+    return node ? node->box : none;
+}
+
+/* Drawing clip rectangle for culling, right and bottom excluded */
+static struct dwindow g_clip = { 0, 0, DWIDTH, DHEIGHT };
+
+/* Check if a node is the cursor's sequence or one of its ancestors */
+static bool has_cursor(math_expr2_t *expr, expr_node_t *node)
+{
+    for(expr_node_t *n = expr->cursor.sequence; n; n = n->parent) {
+        if(n == node) return true;
     }
+    return false;
 }
 
 /* Check if cursor is in this sequence */
@@ -1096,6 +1432,51 @@ static bool cursor_in_seq(math_expr2_t *expr, expr_node_t *seq)
     return expr->cursor.sequence == seq;
 }
 
+/* ===== Layout Index ===== */
+
+/* Boxes of all the slots (sequences) in expression coordinates, recorded by
+   a drawing pass with everything masked and no cursor gap. They are kept in
+   an array ordered by vertical center for geometric UP/DOWN navigation, and
+   also locate the cursor for scrolling views. */
+typedef struct {
+    expr_node_t *slot;
+    int16_t x, y, w, h;
+    uint8_t scale;          /* Font scale, 0 for an empty slot's placeholder */
+} layout_box_t;
+
+static layout_box_t g_boxes[MAX_NODES];
+static uint8_t g_by_center[MAX_NODES];      /* Box indices, by center y */
+static int g_box_count = 0;
+static math_expr2_t *g_index_expr = NULL;   /* Expression indexed */
+static unsigned int g_index_edit = 0;       /* Edit count when indexed */
+static bool g_indexing = false;             /* Recording pass running */
+
+static void index_add(expr_node_t *slot, int x, int y, int w, int h,
+                      int scale)
+{
+    if(g_box_count >= MAX_NODES) return;
+    layout_box_t *b = &g_boxes[g_box_count++];
+    b->slot = slot;
+    b->x = x;
+    b->y = y;
+    b->w = w;
+    b->h = h;
+    b->scale = scale;
+}
+
+/* Draw placeholder box for empty slot */
+static void draw_placeholder(int x, int y, int w, int h, math_expr2_t *expr,
+                             expr_node_t *seq)
+{
+    bool is_cursor_here = cursor_in_seq(expr, seq);
+    if(g_indexing) index_add(seq, x, y, w, h, 0);
+    if(is_cursor_here && g_cursor_visible) {
+        drect(x, y, x + w - 1, y + h - 1, COL_CURSOR);
+    } else {
+        drect_border(x, y, x + w - 1, y + h - 1, C_WHITE, 1, COL_PLACEHOLDER);
+    }
+}
+
 /* Draw cursor line */
 static void draw_cursor_line(int x, int y, int h)
 {
@@ -1113,7 +1494,7 @@ void math2_draw_node(expr_node_t *node, int x, int y_baseline, int font_scale,
 {
     if(!node) return;
     
-    metrics_t m = math2_measure(node, font_scale);
+    metrics_t m = node_box(node);
     int y_top = y_baseline - m.baseline;
     
     switch(node->type) {
@@ -1144,8 +1525,8 @@ void math2_draw_node(expr_node_t *node, int x, int y_baseline, int font_scale,
             
         case NODE_FRACTION:
             {
-                metrics_t num = math2_measure(node->data.frac.numer, font_scale);
-                metrics_t den = math2_measure(node->data.frac.denom, font_scale);
+                metrics_t num = node_box(node->data.frac.numer);
+                metrics_t den = node_box(node->data.frac.denom);
                 
                 int bar_y = y_baseline;
                 int num_y = bar_y - FRAC_PAD - num.height + num.baseline;
@@ -1159,7 +1540,7 @@ void math2_draw_node(expr_node_t *node, int x, int y_baseline, int font_scale,
                 if(seq_is_empty(node->data.frac.numer)) {
                     draw_placeholder(num_x, bar_y - FRAC_PAD - 10, 
                                    num.width, 10,
-                                   cursor_in_seq(expr, node->data.frac.numer));
+                                   expr, node->data.frac.numer);
                 } else {
                     draw_sequence(node->data.frac.numer, num_x, num_y, font_scale, expr);
                 }
@@ -1171,7 +1552,7 @@ void math2_draw_node(expr_node_t *node, int x, int y_baseline, int font_scale,
                 if(seq_is_empty(node->data.frac.denom)) {
                     draw_placeholder(den_x, bar_y + FRAC_PAD + FRAC_BAR_H,
                                    den.width, 10,
-                                   cursor_in_seq(expr, node->data.frac.denom));
+                                   expr, node->data.frac.denom);
                 } else {
                     draw_sequence(node->data.frac.denom, den_x, den_y, font_scale, expr);
                 }
@@ -1180,15 +1561,15 @@ void math2_draw_node(expr_node_t *node, int x, int y_baseline, int font_scale,
             
         case NODE_EXPONENT:
             {
-                metrics_t base = math2_measure(node->data.exp.base, font_scale);
+                metrics_t base = node_box(node->data.exp.base);
                 int exp_scale = scale(font_scale, EXP_SCALE);
                 if(exp_scale < 60) exp_scale = 60;  /* Min ~60% of normal */
-                metrics_t power = math2_measure(node->data.exp.power, exp_scale);
+                metrics_t power = node_box(node->data.exp.power);
                 
                 /* Draw base */
                 if(seq_is_empty(node->data.exp.base)) {
                     draw_placeholder(x, y_top, 8, m.height,
-                                   cursor_in_seq(expr, node->data.exp.base));
+                                   expr, node->data.exp.base);
                 } else {
                     draw_sequence(node->data.exp.base, x, y_baseline, font_scale, expr);
                 }
@@ -1199,7 +1580,7 @@ void math2_draw_node(expr_node_t *node, int x, int y_baseline, int font_scale,
                 
                 if(seq_is_empty(node->data.exp.power)) {
                     draw_placeholder(power_x, y_top, power.width, power.height,
-                                   cursor_in_seq(expr, node->data.exp.power));
+                                   expr, node->data.exp.power);
                 } else {
                     draw_sequence(node->data.exp.power, power_x, power_y, exp_scale, expr);
                 }
@@ -1208,14 +1589,14 @@ void math2_draw_node(expr_node_t *node, int x, int y_baseline, int font_scale,
             
         case NODE_SUBSCRIPT:
             {
-                metrics_t base = math2_measure(node->data.subscript.base, font_scale);
+                metrics_t base = node_box(node->data.subscript.base);
                 int sub_scale = scale(font_scale, EXP_SCALE);
-                metrics_t sub = math2_measure(node->data.subscript.sub, sub_scale);
+                metrics_t sub = node_box(node->data.subscript.sub);
                 
                 /* Draw base */
                 if(seq_is_empty(node->data.subscript.base)) {
                     draw_placeholder(x, y_top, 8, base.height,
-                                   cursor_in_seq(expr, node->data.subscript.base));
+                                   expr, node->data.subscript.base);
                 } else {
                     draw_sequence(node->data.subscript.base, x, y_baseline, font_scale, expr);
                 }
@@ -1226,7 +1607,7 @@ void math2_draw_node(expr_node_t *node, int x, int y_baseline, int font_scale,
                 
                 if(seq_is_empty(node->data.subscript.sub)) {
                     draw_placeholder(sub_x, y_baseline, sub.width, sub.height,
-                                   cursor_in_seq(expr, node->data.subscript.sub));
+                                   expr, node->data.subscript.sub);
                 } else {
                     draw_sequence(node->data.subscript.sub, sub_x, sub_y, sub_scale, expr);
                 }
@@ -1235,7 +1616,7 @@ void math2_draw_node(expr_node_t *node, int x, int y_baseline, int font_scale,
             
         case NODE_ROOT:
             {
-                metrics_t content = math2_measure(node->data.root.content, font_scale);
+                metrics_t content = node_box(node->data.root.content);
                 int root_w = scale(10, font_scale);
                 int index_w = 0;
                 int index_h = 0;
@@ -1263,7 +1644,7 @@ void math2_draw_node(expr_node_t *node, int x, int y_baseline, int font_scale,
                 int cx = rx + root_w;
                 if(seq_is_empty(node->data.root.content)) {
                     draw_placeholder(cx, ry + 2, content.width, content.height,
-                                   cursor_in_seq(expr, node->data.root.content));
+                                   expr, node->data.root.content);
                 } else {
                     draw_sequence(node->data.root.content, cx, y_baseline, font_scale, expr);
                 }
@@ -1273,8 +1654,8 @@ void math2_draw_node(expr_node_t *node, int x, int y_baseline, int font_scale,
         case NODE_NTHROOT:
             {
                 int idx_scale = scale(font_scale, 60);
-                metrics_t idx = math2_measure(node->data.nthroot.index, idx_scale);
-                metrics_t content = math2_measure(node->data.nthroot.content, font_scale);
+                metrics_t idx = node_box(node->data.nthroot.index);
+                metrics_t content = node_box(node->data.nthroot.content);
                 int root_w = scale(10, font_scale);
                 
                 if(idx.width < 8) idx.width = 8;
@@ -1283,7 +1664,7 @@ void math2_draw_node(expr_node_t *node, int x, int y_baseline, int font_scale,
                 /* Draw index */
                 if(seq_is_empty(node->data.nthroot.index)) {
                     draw_placeholder(x, y_top, idx.width, idx.height,
-                                   cursor_in_seq(expr, node->data.nthroot.index));
+                                   expr, node->data.nthroot.index);
                 } else {
                     draw_sequence(node->data.nthroot.index, x, y_top + idx.baseline, idx_scale, expr);
                 }
@@ -1301,7 +1682,7 @@ void math2_draw_node(expr_node_t *node, int x, int y_baseline, int font_scale,
                 int cx = rx + root_w;
                 if(seq_is_empty(node->data.nthroot.content)) {
                     draw_placeholder(cx, ry + 2, content.width, content.height,
-                                   cursor_in_seq(expr, node->data.nthroot.content));
+                                   expr, node->data.nthroot.content);
                 } else {
                     draw_sequence(node->data.nthroot.content, cx, y_baseline, font_scale, expr);
                 }
@@ -1310,9 +1691,9 @@ void math2_draw_node(expr_node_t *node, int x, int y_baseline, int font_scale,
             
         case NODE_MIXED_FRAC:
             {
-                metrics_t whole = math2_measure(node->data.mixed.whole, font_scale);
-                metrics_t num = math2_measure(node->data.mixed.numer, font_scale);
-                metrics_t den = math2_measure(node->data.mixed.denom, font_scale);
+                metrics_t whole = node_box(node->data.mixed.whole);
+                metrics_t num = node_box(node->data.mixed.numer);
+                metrics_t den = node_box(node->data.mixed.denom);
                 
                 if(whole.width < 8) whole.width = 8;
                 if(num.width < 10) num.width = 10;
@@ -1324,7 +1705,7 @@ void math2_draw_node(expr_node_t *node, int x, int y_baseline, int font_scale,
                 /* Draw whole part */
                 if(seq_is_empty(node->data.mixed.whole)) {
                     draw_placeholder(x, y_top + (m.height - whole.height) / 2, whole.width, whole.height,
-                                   cursor_in_seq(expr, node->data.mixed.whole));
+                                   expr, node->data.mixed.whole);
                 } else {
                     draw_sequence(node->data.mixed.whole, x, y_baseline, font_scale, expr);
                 }
@@ -1337,7 +1718,7 @@ void math2_draw_node(expr_node_t *node, int x, int y_baseline, int font_scale,
                 int num_y = bar_y - FRAC_PAD - num.height + num.baseline;
                 if(seq_is_empty(node->data.mixed.numer)) {
                     draw_placeholder(num_x, bar_y - FRAC_PAD - num.height, num.width, num.height,
-                                   cursor_in_seq(expr, node->data.mixed.numer));
+                                   expr, node->data.mixed.numer);
                 } else {
                     draw_sequence(node->data.mixed.numer, num_x, num_y, font_scale, expr);
                 }
@@ -1350,7 +1731,7 @@ void math2_draw_node(expr_node_t *node, int x, int y_baseline, int font_scale,
                 int den_y = bar_y + FRAC_BAR_H + FRAC_PAD + den.baseline;
                 if(seq_is_empty(node->data.mixed.denom)) {
                     draw_placeholder(den_x, bar_y + FRAC_BAR_H + FRAC_PAD, den.width, den.height,
-                                   cursor_in_seq(expr, node->data.mixed.denom));
+                                   expr, node->data.mixed.denom);
                 } else {
                     draw_sequence(node->data.mixed.denom, den_x, den_y, font_scale, expr);
                 }
@@ -1359,7 +1740,7 @@ void math2_draw_node(expr_node_t *node, int x, int y_baseline, int font_scale,
             
         case NODE_ABS:
             {
-                metrics_t content = math2_measure(node->data.abs.content, font_scale);
+                metrics_t content = node_box(node->data.abs.content);
                 
                 /* Draw | bars */
                 dline(x + 2, y_top, x + 2, y_top + m.height - 1, COL_TEXT);
@@ -1369,7 +1750,7 @@ void math2_draw_node(expr_node_t *node, int x, int y_baseline, int font_scale,
                 int cx = x + 4;
                 if(seq_is_empty(node->data.abs.content)) {
                     draw_placeholder(cx, y_top + 2, content.width, content.height,
-                                   cursor_in_seq(expr, node->data.abs.content));
+                                   expr, node->data.abs.content);
                 } else {
                     draw_sequence(node->data.abs.content, cx, y_baseline, font_scale, expr);
                 }
@@ -1378,7 +1759,7 @@ void math2_draw_node(expr_node_t *node, int x, int y_baseline, int font_scale,
             
         case NODE_PAREN:
             {
-                metrics_t content = math2_measure(node->data.paren.content, font_scale);
+                metrics_t content = node_box(node->data.paren.content);
                 
                 /* Get color based on nesting depth (or black if coloring disabled) */
                 color_t paren_color;
@@ -1431,7 +1812,7 @@ void math2_draw_node(expr_node_t *node, int x, int y_baseline, int font_scale,
                 int cx = x + paren_w + 2;
                 if(seq_is_empty(node->data.paren.content)) {
                     draw_placeholder(cx, y_top + 2, content.width, content.height,
-                                   cursor_in_seq(expr, node->data.paren.content));
+                                   expr, node->data.paren.content);
                 } else {
                     draw_sequence(node->data.paren.content, cx, y_baseline, font_scale, expr);
                 }
@@ -1452,7 +1833,7 @@ void math2_draw_node(expr_node_t *node, int x, int y_baseline, int font_scale,
                 int ax = x + name_w + 6;
                 if(seq_is_empty(node->data.func.arg)) {
                     draw_placeholder(ax, y_top, 8, m.height,
-                                   cursor_in_seq(expr, node->data.func.arg));
+                                   expr, node->data.func.arg);
                 } else {
                     draw_sequence(node->data.func.arg, ax, y_baseline, font_scale, expr);
                 }
@@ -1466,6 +1847,150 @@ void math2_draw_node(expr_node_t *node, int x, int y_baseline, int font_scale,
     }
 }
 
+/* ===== Bitmap Cache ===== */
+
+typedef struct {
+    expr_node_t *node;      /* NULL for a free entry */
+    image_t *img;
+    int scale;              /* Font scale it was drawn at */
+    int color;              /* Paren color index, -1 without coloring */
+    unsigned int used;      /* Tick of the last use, for LRU */
+} cache_entry_t;
+
+static cache_entry_t g_cache[CACHE_ENTRIES];
+static int g_cache_bytes = 0;
+static unsigned int g_cache_tick = 0;
+static math2_cache_stats_t g_cache_stats;
+
+/* VRAM as an image, to capture rendered subtrees */
+static image_t *g_vram_img = NULL;
+
+/* Set while drawing a node that will be captured; its descendants are part
+   of its bitmap and don't get their own */
+static bool g_capturing = false;
+
+static void cache_drop(cache_entry_t *e)
+{
+    g_cache_bytes -= e->img->stride * e->img->height;
+    image_free(e->img);
+    e->node = NULL;
+    e->img = NULL;
+}
+
+void math2_cache_flush(void)
+{
+    for(int i = 0; i < CACHE_ENTRIES; i++) {
+        if(g_cache[i].node) cache_drop(&g_cache[i]);
+    }
+}
+
+void math2_cache_stats(math2_cache_stats_t *stats)
+{
+    *stats = g_cache_stats;
+    stats->entries = 0;
+    for(int i = 0; i < CACHE_ENTRIES; i++) {
+        if(g_cache[i].node) stats->entries++;
+    }
+    stats->bytes = g_cache_bytes;
+}
+
+/* Only containers are worth caching; text is a single dtext() */
+static bool cacheable(expr_node_t *node)
+{
+    return node->type != NODE_TEXT && node->type != NODE_SEQUENCE;
+}
+
+/* Get a free entry, evicting the least recently used ones until the new
+   bitmap fits in the budget */
+static cache_entry_t *cache_alloc(int bytes)
+{
+    while(1) {
+        cache_entry_t *slot = NULL, *lru = NULL;
+        for(int i = 0; i < CACHE_ENTRIES; i++) {
+            cache_entry_t *e = &g_cache[i];
+            if(!e->node) slot = e;
+            else if(!lru || e->used < lru->used) lru = e;
+        }
+        if(slot && g_cache_bytes + bytes <= CACHE_BUDGET) return slot;
+        if(!lru) return NULL;
+        cache_drop(lru);
+        g_cache_stats.evictions++;
+    }
+}
+
+/* Copy a node's rendering from VRAM into a new cache entry */
+static void cache_capture(expr_node_t *node, int x, int y, int scale,
+                          int color)
+{
+    metrics_t m = node->box;
+    if(m.width <= 0 || m.height <= 0) return;
+    
+    /* Only capture fully visible nodes, anything clipped would be lost */
+    if(x < dwindow.left || y < dwindow.top || x + m.width > dwindow.right ||
+       y + m.height > dwindow.bottom) return;
+    
+    int bytes = ((m.width * 2 + 3) & ~3) * m.height;
+    if(bytes > CACHE_BUDGET / 4) return;
+    
+    if(!g_vram_img) g_vram_img = image_create_vram();
+    if(!g_vram_img) return;
+    g_vram_img->data = gint_vram;  /* Follows dupdate() with triple buffering */
+    
+    cache_entry_t *e = cache_alloc(bytes);
+    if(!e) return;
+    e->img = image_alloc(m.width, m.height, IMAGE_RGB565);
+    if(!e->img) return;
+    
+    image_copy(image_sub(g_vram_img, x, y, m.width, m.height), e->img, false);
+    e->node = node;
+    e->scale = scale;
+    e->color = color;
+    e->used = g_cache_tick;
+    g_cache_bytes += e->img->stride * e->img->height;
+    node->dirty = false;
+}
+
+/* Draw a node, from its cached bitmap if it hasn't changed */
+static void draw_node_cached(expr_node_t *node, int x, int y_baseline,
+                             int font_scale, math_expr2_t *expr)
+{
+    /* Nodes that have the cursor change with every blink */
+    if(!cacheable(node) || has_cursor(expr, node) ||
+       dwindow.left >= dwindow.right) {
+        math2_draw_node(node, x, y_baseline, font_scale, expr);
+        return;
+    }
+    
+    int color = g_color_brackets ? g_paren_depth % NUM_PAREN_COLORS : -1;
+    int y = y_baseline - node->box.baseline;
+    g_cache_tick++;
+    
+    for(int i = 0; i < CACHE_ENTRIES; i++) {
+        cache_entry_t *e = &g_cache[i];
+        if(e->node != node) continue;
+        
+        if(!node->dirty && e->scale == font_scale && e->color == color) {
+            dimage(x, y, e->img);
+            e->used = g_cache_tick;
+            g_cache_stats.hits++;
+            return;
+        }
+        cache_drop(e);
+        break;
+    }
+    
+    if(g_capturing) {
+        math2_draw_node(node, x, y_baseline, font_scale, expr);
+        return;
+    }
+    
+    g_cache_stats.misses++;
+    g_capturing = true;
+    math2_draw_node(node, x, y_baseline, font_scale, expr);
+    g_capturing = false;
+    cache_capture(node, x, y, font_scale, color);
+}
+
 static void draw_sequence(expr_node_t *seq, int x, int y_baseline, int font_scale,
                           math_expr2_t *expr)
 {
@@ -1473,25 +1998,60 @@ static void draw_sequence(expr_node_t *seq, int x, int y_baseline, int font_scal
     
     int cx = x;
     bool cursor_here = cursor_in_seq(expr, seq);
+    /* The index is laid out without the cursor and the gap after it, so it
+       stays valid when only the cursor moves */
+    bool cursor_drawn = cursor_here && !g_indexing;
+    
+    if(g_indexing) {
+        metrics_t m = node_box(seq);
+        index_add(seq, x, y_baseline - m.baseline, m.width, m.height,
+                  font_scale);
+    }
     
     /* Cursor height based on font scale */
     int cursor_h = (CHAR_H * font_scale) / 100 + 4;
     int cursor_offset = cursor_h / 2;
     
+    /* Selected nodes are inverted once they are drawn */
+    expr_node_t *sel_first = NULL, *sel_last = NULL;
+    int sel_x = 0, sel_top = INT_MAX, sel_bottom = INT_MIN;
+    bool selected = false;
+    if(cursor_drawn)
+        math2_get_selection(expr, &sel_first, &sel_last);
+    
     /* Draw cursor at start if needed */
-    if(cursor_here && expr->cursor.after == NULL) {
+    if(cursor_drawn && expr->cursor.after == NULL) {
         draw_cursor_line(cx, y_baseline - cursor_offset, cursor_h);
         cx += 3;
     }
     
     expr_node_t *child = seq->data.seq.first;
     while(child) {
-        metrics_t cm = math2_measure(child, font_scale);
-        math2_draw_node(child, cx, y_baseline, font_scale, expr);
+        metrics_t cm = node_box(child);
+        int top = y_baseline - cm.baseline;
+        
+        /* Skip nodes outside the clip, except on the way to the cursor */
+        bool visible = cx < g_clip.right && cx + cm.width > g_clip.left &&
+                       top < g_clip.bottom && top + cm.height > g_clip.top;
+        if(visible || g_indexing || has_cursor(expr, child))
+            draw_node_cached(child, cx, y_baseline, font_scale, expr);
+        
+        if(child == sel_first) {
+            selected = true;
+            sel_x = cx;
+        }
+        if(selected) {
+            if(top < sel_top) sel_top = top;
+            if(top + cm.height > sel_bottom) sel_bottom = top + cm.height;
+        }
         cx += cm.width;
+        if(child == sel_last) {
+            drect(sel_x, sel_top, cx - 1, sel_bottom - 1, C_INVERT);
+            selected = false;
+        }
         
         /* Draw cursor after this node if needed */
-        if(cursor_here && expr->cursor.after == child) {
+        if(cursor_drawn && expr->cursor.after == child) {
             draw_cursor_line(cx, y_baseline - cursor_offset, cursor_h);
             cx += 3;
         }
@@ -1505,9 +2065,218 @@ void math2_draw(math_expr2_t *expr, int x, int y)
     metrics_t m = math2_measure(expr->root, 100);
     /* Center vertically around y */
     int y_baseline = y + m.baseline;
+    g_clip = dwindow;
     draw_sequence(expr->root, x, y_baseline, 100, expr);
 }
 
+/* Space kept between the view's edges and the expression or cursor */
+#define VIEW_MARGIN 12
+
+/* Scroll one axis so that [pos, pos+size) is visible with a margin */
+static int scroll_to(int scroll, int pos, int size, int view_size,
+                     int content_size)
+{
+    if(pos - scroll < VIEW_MARGIN) scroll = pos - VIEW_MARGIN;
+    if(pos + size - scroll > view_size - VIEW_MARGIN)
+        scroll = pos + size - view_size + VIEW_MARGIN;
+
+    int max = content_size - view_size;
+    if(scroll > max) scroll = max;
+    if(scroll < 0) scroll = 0;
+    return scroll;
+}
+
+/* Vertical center of an indexed box */
+static int box_center(int i)
+{
+    return g_boxes[i].y + g_boxes[i].h / 2;
+}
+
+/* Record the slot boxes again if the expression changed since last time */
+static void index_update(math_expr2_t *expr)
+{
+    if(expr == g_index_expr && g_index_edit == g_edit_count) return;
+    
+    metrics_t m = math2_measure(expr->root, 100);
+    struct dwindow none = { 0, 0, 0, 0 };
+    struct dwindow old = dwindow_set(none);
+    g_clip = none;
+    g_box_count = 0;
+    g_indexing = true;
+    draw_sequence(expr->root, 0, m.baseline, 100, expr);
+    g_indexing = false;
+    dwindow_set(old);
+    
+    /* Insertion sort by center, the boxes come out mostly ordered by depth
+       and there are few of them */
+    for(int i = 0; i < g_box_count; i++) {
+        int j = i;
+        while(j > 0 && box_center(g_by_center[j-1]) > box_center(i)) {
+            g_by_center[j] = g_by_center[j-1];
+            j--;
+        }
+        g_by_center[j] = i;
+    }
+    
+    g_index_expr = expr;
+    g_index_edit = g_edit_count;
+}
+
+static layout_box_t *index_find(expr_node_t *slot)
+{
+    for(int i = 0; i < g_box_count; i++) {
+        if(g_boxes[i].slot == slot) return &g_boxes[i];
+    }
+    return NULL;
+}
+
+/* Horizontal offset of the position after a child (NULL for the start) */
+static int slot_offset(expr_node_t *seq, expr_node_t *after)
+{
+    if(!after) return 0;
+    int x = 0;
+    for(expr_node_t *c = seq->data.seq.first; c; c = c->next) {
+        x += node_box(c).width;
+        if(c == after) break;
+    }
+    return x;
+}
+
+/* Where the cursor is drawn, in expression coordinates, according to the
+   layout index. Like the index, this only changes with edits and cursor
+   moves, and doesn't need a drawing pass. */
+static bool index_cursor(math_expr2_t *expr, int *x, int *y, int *w, int *h)
+{
+    index_update(expr);
+    
+    expr_node_t *seq = expr->cursor.sequence;
+    layout_box_t *b = index_find(seq);
+    if(!b) return false;
+    
+    /* Empty slots are highlighted as a whole */
+    if(!b->scale) {
+        *x = b->x;
+        *y = b->y;
+        *w = b->w;
+        *h = b->h;
+        return true;
+    }
+    
+    /* Same line as draw_sequence() */
+    int cursor_h = (CHAR_H * b->scale) / 100 + 4;
+    *x = b->x + slot_offset(seq, expr->cursor.after);
+    *y = b->y + seq->box.baseline - cursor_h / 2;
+    *w = 2;
+    *h = cursor_h;
+    return true;
+}
+
+void math2_draw_view(math_expr2_t *expr, math2_view_t *view)
+{
+    /* The index pass measures the expression, so the metrics are only
+       computed again after an edit */
+    int cx, cy, cw, ch;
+    bool cursor_found = index_cursor(expr, &cx, &cy, &cw, &ch);
+    metrics_t m = node_box(expr->root);
+    
+    /* Content size, with margins on the left and right and room for the
+       cursor; an expression that fits vertically is centered */
+    int content_w = m.width + 3 + 2 * VIEW_MARGIN;
+    bool fits_v = (m.height <= view->h);
+    int top_pad = fits_v ? (view->h - m.height) / 2 : 0;
+    
+    if(cursor_found) {
+        view->scroll_x = scroll_to(view->scroll_x, VIEW_MARGIN + cx, cw,
+                                   view->w, content_w);
+        view->scroll_y = fits_v ? 0 : scroll_to(view->scroll_y,
+                                   top_pad + cy, ch, view->h, m.height);
+    }
+    
+    /* Draw the visible part */
+    struct dwindow box = { view->x, view->y, view->x + view->w,
+                           view->y + view->h };
+    struct dwindow old = dwindow_set(box);
+    g_clip = box;
+    int x = view->x + VIEW_MARGIN - view->scroll_x;
+    int y = view->y + top_pad - view->scroll_y;
+    draw_sequence(expr->root, x, y + m.baseline, 100, expr);
+    dwindow_set(old);
+}
+
+/* Furthest a slot can be to the side of the cursor and still be reached,
+   and smallest vertical move that counts as changing lines */
+#define NAV_MAX_DX 24
+#define NAV_MIN_DY 4
+
+/* Move the cursor to the nearest slot above (dir < 0) or below (dir > 0) */
+static bool cursor_vertical(math_expr2_t *expr, int dir)
+{
+    index_update(expr);
+    
+    expr_node_t *seq = expr->cursor.sequence;
+    layout_box_t *cur = index_find(seq);
+    if(!cur) return false;
+    int cx = cur->x + slot_offset(seq, expr->cursor.after);
+    int cy = cur->y + cur->h / 2;
+    
+    /* First box whose center is at or below the cursor */
+    int lo = 0, hi = g_box_count;
+    while(lo < hi) {
+        int mid = (lo + hi) / 2;
+        if(box_center(g_by_center[mid]) < cy) lo = mid + 1;
+        else hi = mid;
+    }
+    
+    /* Scan away from the cursor until boxes are too far to beat the best */
+    layout_box_t *best = NULL;
+    int best_cost = INT_MAX;
+    for(int i = (dir < 0) ? lo - 1 : lo; i >= 0 && i < g_box_count; i += dir) {
+        layout_box_t *b = &g_boxes[g_by_center[i]];
+        int dy = (box_center(g_by_center[i]) - cy) * dir;
+        if(dy >= best_cost) break;
+        if(dy < NAV_MIN_DY || has_cursor(expr, b->slot)) continue;
+        
+        int dx = 0;
+        if(cx < b->x) dx = b->x - cx;
+        else if(cx > b->x + b->w) dx = cx - b->x - b->w;
+        if(dx > NAV_MAX_DX) continue;
+        
+        int cost = dy + 2 * dx;
+        if(cost < best_cost) {
+            best = b;
+            best_cost = cost;
+        }
+    }
+    if(!best) return false;
+    
+    /* Land on the child boundary closest to the cursor */
+    expr_node_t *target = best->slot;
+    expr_node_t *after = NULL;
+    int x = best->x;
+    int best_dist = abs(x - cx);
+    for(expr_node_t *c = target->data.seq.first; c; c = c->next) {
+        x += node_box(c).width;
+        if(abs(x - cx) < best_dist) {
+            best_dist = abs(x - cx);
+            after = c;
+        }
+    }
+    
+    expr->cursor.sequence = target;
+    expr->cursor.after = after;
+    return true;
+}
+
+bool cursor_up(math_expr2_t *expr)
+{
+    return cursor_vertical(expr, -1);
+}
+
+bool cursor_down(math_expr2_t *expr)
+{
+    return cursor_vertical(expr, 1);
+}
+
 /* Get the total width of the expression for centering */
 int math2_get_width(math_expr2_t *expr)
 {
@@ -1522,112 +2291,251 @@ int math2_get_height(math_expr2_t *expr)
     return m.height;
 }
 
+/* ===== Output Buffer ===== */
+
+void math2_out_init(math2_out_t *out, char *buf, int size)
+{
+    out->buf = buf;
+    out->size = size;
+    out->len = 0;
+    out->overflow = false;
+    buf[0] = '\0';
+}
+
+void math2_out_char(math2_out_t *out, char c)
+{
+    if(out->len >= out->size - 1) {
+        out->overflow = true;
+        return;
+    }
+    out->buf[out->len++] = c;
+    out->buf[out->len] = '\0';
+}
+
+void math2_out_put(math2_out_t *out, const char *str)
+{
+    while(*str) math2_out_char(out, *str++);
+}
+
+/* ===== Symbol Names ===== */
+
+/* Names of the non-ASCII symbols the editor can insert, which are also their
+   LaTeX control words */
+static const struct {
+    const char *utf8;
+    const char *name;
+} symbol_names[] = {
+    { "π", "pi" },
+    { "α", "alpha" },
+    { "β", "beta" },
+    { "γ", "gamma" },
+    { "θ", "theta" },
+    { "λ", "lambda" },
+    { "μ", "mu" },
+    { "ω", "omega" },
+    { "Δ", "Delta" },
+    { "→", "to" },
+};
+
+const char *math2_symbol_name(const char *utf8)
+{
+    for(size_t i = 0; i < sizeof(symbol_names) / sizeof(symbol_names[0]); i++) {
+        if(strcmp(symbol_names[i].utf8, utf8) == 0) return symbol_names[i].name;
+    }
+    return NULL;
+}
+
 /* ===== LaTeX Generation ===== */
 
-static void latex_sequence(expr_node_t *seq, char *buf);
-static void latex_node(expr_node_t *node, char *buf);
+static void latex_sequence(expr_node_t *seq, math2_out_t *out, latex_style_t style);
+static void latex_node(expr_node_t *node, math2_out_t *out, latex_style_t style);
 
-static void latex_node(expr_node_t *node, char *buf)
+/* Check if the output ends with a control word like \pi */
+static bool ends_with_control_word(const math2_out_t *out)
+{
+    const char *buf = out->buf;
+    int i = out->len;
+    int letters = 0;
+    while(i > 0 && ((buf[i-1] >= 'a' && buf[i-1] <= 'z') ||
+                    (buf[i-1] >= 'A' && buf[i-1] <= 'Z'))) {
+        i--;
+        letters++;
+    }
+    return letters > 0 && i > 0 && buf[i-1] == '\\';
+}
+
+/* Append to the LaTeX output. In compact style, the only space ever emitted
+   is the one that ends a control word before a letter (\pi x) */
+static void latex_put(math2_out_t *out, const char *str, latex_style_t style)
+{
+    bool letter = (str[0] >= 'a' && str[0] <= 'z') ||
+                  (str[0] >= 'A' && str[0] <= 'Z');
+    if(style == LATEX_COMPACT && letter && ends_with_control_word(out))
+        math2_out_char(out, ' ');
+    math2_out_put(out, str);
+}
+
+/* Append the text of a node, keeping the output ASCII: named symbols are
+   written as control words (θ becomes \theta) */
+static void latex_text(math2_out_t *out, const char *text, latex_style_t style)
+{
+    const char *name = math2_symbol_name(text);
+    if(!name) {
+        latex_put(out, text, style);
+        return;
+    }
+
+    char tmp[16];
+    snprintf(tmp, sizeof(tmp), "\\%s%s", name,
+             style == LATEX_VERBOSE ? " " : "");
+    latex_put(out, tmp, style);
+}
+
+/* Check if a sequence is exactly one TeX token, so it needs no braces as an
+   argument. Named symbols are a single control word. */
+static bool latex_single_token(expr_node_t *seq)
+{
+    if(!seq || seq->type != NODE_SEQUENCE) return false;
+
+    expr_node_t *node = seq->data.seq.first;
+    if(!node || node->next || node->type != NODE_TEXT) return false;
+    if(node->data.text.subtype == TEXT_PI) return true;
+
+    const char *t = node->data.text.text;
+    if(strcmp(t, "×") == 0 || strcmp(t, "÷") == 0) return true;
+    if(math2_symbol_name(t)) return true;
+    return t[0] > 0 && t[0] < 0x7f && t[1] == '\0';
+}
+
+/* Check if a sequence contains a fraction at any depth; delimiters around it
+   must then be sized with \left and \right */
+static bool latex_is_tall(expr_node_t *seq)
+{
+    if(!seq || seq->type != NODE_SEQUENCE) return false;
+
+    for(expr_node_t *child = seq->data.seq.first; child; child = child->next) {
+        if(child->type == NODE_FRACTION || child->type == NODE_MIXED_FRAC)
+            return true;
+        for(expr_node_t *slot = get_first_slot(child); slot;
+            slot = get_next_slot(child, slot)) {
+            if(latex_is_tall(slot)) return true;
+        }
+    }
+    return false;
+}
+
+/* Emit a sequence as a macro argument or script, with braces unless the
+   compact style can do without them */
+static void latex_group(expr_node_t *seq, math2_out_t *out, latex_style_t style)
+{
+    if(style == LATEX_COMPACT && latex_single_token(seq)) {
+        latex_sequence(seq, out, style);
+        return;
+    }
+    latex_put(out, "{", style);
+    latex_sequence(seq, out, style);
+    latex_put(out, "}", style);
+}
+
+/* Emit a sequence between delimiters, sized only when needed */
+static void latex_delimited(expr_node_t *seq, math2_out_t *out, latex_style_t style,
+                            const char *open, const char *close)
+{
+    bool sized = (style == LATEX_VERBOSE) || latex_is_tall(seq);
+
+    if(sized) latex_put(out, "\\left", style);
+    latex_put(out, open, style);
+    latex_sequence(seq, out, style);
+    if(sized) latex_put(out, "\\right", style);
+    latex_put(out, close, style);
+}
+
+static void latex_node(expr_node_t *node, math2_out_t *out, latex_style_t style)
 {
     if(!node) return;
     
     switch(node->type) {
         case NODE_SEQUENCE:
-            latex_sequence(node, buf);
+            latex_sequence(node, out, style);
             break;
             
         case NODE_TEXT:
             switch(node->data.text.subtype) {
                 case TEXT_PI:
-                    strcat(buf, "\\pi ");
+                    latex_put(out, style == LATEX_VERBOSE ? "\\pi " : "\\pi",
+                              style);
                     break;
                 case TEXT_OPERATOR:
                     if(strcmp(node->data.text.text, "×") == 0) {
-                        strcat(buf, "*");
+                        latex_put(out, "*", style);
                     } else if(strcmp(node->data.text.text, "÷") == 0) {
-                        strcat(buf, "/");
+                        latex_put(out, "/", style);
                     } else {
-                        strcat(buf, node->data.text.text);
+                        latex_text(out, node->data.text.text, style);
                     }
                     break;
                 default:
-                    strcat(buf, node->data.text.text);
+                    latex_text(out, node->data.text.text, style);
                     break;
             }
             break;
             
         case NODE_FRACTION:
-            strcat(buf, "\\frac{");
-            latex_sequence(node->data.frac.numer, buf);
-            strcat(buf, "}{");
-            latex_sequence(node->data.frac.denom, buf);
-            strcat(buf, "}");
+            latex_put(out, "\\frac", style);
+            latex_group(node->data.frac.numer, out, style);
+            latex_group(node->data.frac.denom, out, style);
             break;
             
         case NODE_EXPONENT:
-            strcat(buf, "{");
-            latex_sequence(node->data.exp.base, buf);
-            strcat(buf, "}^{");
-            latex_sequence(node->data.exp.power, buf);
-            strcat(buf, "}");
+            latex_group(node->data.exp.base, out, style);
+            latex_put(out, "^", style);
+            latex_group(node->data.exp.power, out, style);
             break;
             
         case NODE_SUBSCRIPT:
-            strcat(buf, "{");
-            latex_sequence(node->data.subscript.base, buf);
-            strcat(buf, "}_{");
-            latex_sequence(node->data.subscript.sub, buf);
-            strcat(buf, "}");
+            latex_group(node->data.subscript.base, out, style);
+            latex_put(out, "_", style);
+            latex_group(node->data.subscript.sub, out, style);
             break;
             
         case NODE_ROOT:
             if(node->data.root.index == 2) {
-                strcat(buf, "\\sqrt{");
+                latex_put(out, "\\sqrt", style);
             } else {
                 char tmp[16];
-                snprintf(tmp, sizeof(tmp), "\\sqrt[%d]{", node->data.root.index);
-                strcat(buf, tmp);
+                snprintf(tmp, sizeof(tmp), "\\sqrt[%d]", node->data.root.index);
+                latex_put(out, tmp, style);
             }
-            latex_sequence(node->data.root.content, buf);
-            strcat(buf, "}");
+            latex_group(node->data.root.content, out, style);
             break;
             
         case NODE_ABS:
-            strcat(buf, "\\left|");
-            latex_sequence(node->data.abs.content, buf);
-            strcat(buf, "\\right|");
+            latex_delimited(node->data.abs.content, out, style, "|", "|");
             break;
             
         case NODE_PAREN:
-            strcat(buf, "\\left(");
-            latex_sequence(node->data.paren.content, buf);
-            strcat(buf, "\\right)");
+            latex_delimited(node->data.paren.content, out, style, "(", ")");
             break;
             
         case NODE_FUNCTION:
-            strcat(buf, "\\");
-            strcat(buf, node->data.func.name);
-            strcat(buf, "\\left(");
-            latex_sequence(node->data.func.arg, buf);
-            strcat(buf, "\\right)");
+            latex_put(out, "\\", style);
+            latex_put(out, node->data.func.name, style);
+            latex_delimited(node->data.func.arg, out, style, "(", ")");
             break;
             
         case NODE_NTHROOT:
-            strcat(buf, "\\sqrt[");
-            latex_sequence(node->data.nthroot.index, buf);
-            strcat(buf, "]{");
-            latex_sequence(node->data.nthroot.content, buf);
-            strcat(buf, "}");
+            latex_put(out, "\\sqrt[", style);
+            latex_sequence(node->data.nthroot.index, out, style);
+            latex_put(out, "]", style);
+            latex_group(node->data.nthroot.content, out, style);
             break;
             
         case NODE_MIXED_FRAC:
             /* Mixed fraction as whole + frac */
-            latex_sequence(node->data.mixed.whole, buf);
-            strcat(buf, "\\frac{");
-            latex_sequence(node->data.mixed.numer, buf);
-            strcat(buf, "}{");
-            latex_sequence(node->data.mixed.denom, buf);
-            strcat(buf, "}");
+            latex_sequence(node->data.mixed.whole, out, style);
+            latex_put(out, "\\frac", style);
+            latex_group(node->data.mixed.numer, out, style);
+            latex_group(node->data.mixed.denom, out, style);
             break;
             
         default:
@@ -1635,21 +2543,32 @@ static void latex_node(expr_node_t *node, char *buf)
     }
 }
 
-static void latex_sequence(expr_node_t *seq, char *buf)
+static void latex_sequence(expr_node_t *seq, math2_out_t *out, latex_style_t style)
 {
     if(!seq || seq->type != NODE_SEQUENCE) return;
     
     expr_node_t *child = seq->data.seq.first;
     while(child) {
-        latex_node(child, buf);
+        latex_node(child, out, style);
         child = child->next;
     }
 }
 
 void math2_to_latex(math_expr2_t *expr)
 {
-    expr->latex[0] = '\0';
-    latex_sequence(expr->root, expr->latex);
+    math2_to_latex_style(expr, LATEX_VERBOSE);
+}
+
+void math2_to_latex_style(math_expr2_t *expr, latex_style_t style)
+{
+    math2_out_t out;
+    math2_out_init(&out, expr->latex, MAX_LATEX);
+    math2_write_latex(&out, expr->root, style);
+}
+
+void math2_write_latex(math2_out_t *out, expr_node_t *root, latex_style_t style)
+{
+    latex_sequence(root, out, style);
 }
 
 /* ===== Mode Management ===== */
@@ -48,12 +48,25 @@ typedef enum {
 /* Forward declaration */
 typedef struct expr_node expr_node_t;
 
+/* Metrics returned by measure pass */
+typedef struct {
+    int width;
+    int height;
+    int baseline;   /* Distance from top to middle line */
+} metrics_t;
+
 /* Expression node - can be leaf or container */
 struct expr_node {
     node_type_t type;
     expr_node_t *parent;    /* Parent node for navigation */
     expr_node_t *next;      /* Next sibling in sequence */
     expr_node_t *prev;      /* Previous sibling in sequence */
+    metrics_t box;          /* Metrics from the last measure pass */
+    /* Set when the node is created or copied, and on a sequence and its
+       ancestors when the sequence is edited. Only the bitmap cache uses it,
+       to drop stale bitmaps, and clears it on capture; results derived from
+       the whole tree check math2_edit_count() instead. */
+    bool dirty;
     
     union {
         /* NODE_SEQUENCE: horizontal list */
@@ -123,13 +136,6 @@ struct expr_node {
     } data;
 };
 
-/* Metrics returned by measure pass */
-typedef struct {
-    int width;
-    int height;
-    int baseline;   /* Distance from top to middle line */
-} metrics_t;
-
 /* Cursor position in tree */
 typedef struct {
     expr_node_t *sequence;  /* Which sequence we're in */
@@ -144,6 +150,10 @@ typedef struct {
     expr_node_t *root;              /* Root sequence */
     cursor_t cursor;                /* Current cursor position */
     
+    bool selecting;                 /* Selection mode */
+    cursor_t sel_anchor;            /* End of the selection that stays put */
+    expr_node_t *clipboard;         /* Sequence of copied nodes, or NULL */
+    
     char latex[MAX_LATEX];          /* Generated LaTeX */
     
     bool shift_mode;                /* SHIFT pressed */
@@ -164,6 +174,11 @@ void math2_free_node(math_expr2_t *expr, expr_node_t *node);
 /* Create a new empty sequence */
 expr_node_t *math2_new_sequence(math_expr2_t *expr);
 
+/* Copy a node and everything under it; the copy has no parent. All nodes
+   are taken from the pool at once, so if it can't hold the copy this
+   returns NULL without using any. */
+expr_node_t *math2_clone(math_expr2_t *expr, expr_node_t *node);
+
 /* ===== Sequence Operations ===== */
 
 /* Insert node into sequence after given position (NULL = at start) */
@@ -175,6 +190,10 @@ void seq_remove(expr_node_t *node);
 /* Check if sequence is empty */
 bool seq_is_empty(expr_node_t *seq);
 
+/* Number of changes made to sequences so far, to find out whether results
+   derived from an expression are still up to date */
+unsigned int math2_edit_count(void);
+
 /* ===== Cursor Operations ===== */
 
 /* Move cursor left within sequence */
@@ -205,6 +224,11 @@ bool cursor_exit_left(math_expr2_t *expr);
 bool cursor_next_slot(math_expr2_t *expr);
 bool cursor_prev_slot(math_expr2_t *expr);
 
+/* Move to the nearest slot above or below on screen, using the layout after
+   the last edit; returns false if there is none within reach */
+bool cursor_up(math_expr2_t *expr);
+bool cursor_down(math_expr2_t *expr);
+
 /* ===== Editing Operations ===== */
 
 /* Insert text node at cursor */
@@ -246,6 +270,31 @@ void math2_delete(math_expr2_t *expr);
 /* Clear entire expression */
 void math2_clear(math_expr2_t *expr);
 
+/* ===== Selection and Clipboard ===== */
+
+/* The selection is the range between the anchor and the cursor, which must
+   be in the same sequence; moving the cursor left or right extends it. */
+
+/* Start selecting from the cursor position, or stop */
+void math2_select_start(math_expr2_t *expr);
+void math2_select_end(math_expr2_t *expr);
+
+/* Get the first and last selected nodes; false if nothing is selected */
+bool math2_get_selection(math_expr2_t *expr, expr_node_t **first,
+                         expr_node_t **last);
+
+/* Copy the selection to the clipboard, or move it there. Return false if
+   nothing is selected or the pool can't hold the copy. */
+bool math2_copy(math_expr2_t *expr);
+bool math2_cut(math_expr2_t *expr);
+
+/* Delete the selected nodes */
+bool math2_delete_selection(math_expr2_t *expr);
+
+/* Insert a copy of the clipboard at the cursor, replacing the selection;
+   the cursor ends up after it */
+bool math2_paste(math_expr2_t *expr);
+
 /* ===== Rendering ===== */
 
 /* Measure a node and return its metrics */
@@ -258,15 +307,87 @@ void math2_draw(math_expr2_t *expr, int x, int y);
 int math2_get_width(math_expr2_t *expr);
 int math2_get_height(math_expr2_t *expr);
 
-/* Draw a single node (recursive) */
+/* Draw a single node (recursive), using the metrics cached by the last
+   measure pass over it */
 void math2_draw_node(expr_node_t *node, int x, int y_baseline, int font_scale,
                      math_expr2_t *expr);
 
+/* Viewport for expressions larger than their box on screen */
+typedef struct {
+    int x, y, w, h;         /* Box on screen */
+    int scroll_x;           /* Expression coordinates at the box's left */
+    int scroll_y;           /* and top edges; kept across frames */
+} math2_view_t;
+
+/* Draw the expression clipped to a view, scrolling so that the cursor stays
+   visible. Subtrees outside the box are not drawn, so the cost depends on
+   the visible part, not on the length of the expression. The metrics and
+   the cursor position come from the layout index, which is only rebuilt
+   after an edit (see math2_edit_count()). */
+void math2_draw_view(math_expr2_t *expr, math2_view_t *view);
+
+/* ===== Bitmap Cache ===== */
+
+/* Containers that the cursor isn't in are rendered once into a bitmap and
+   blitted on later frames. Entries are dropped when the subtree changes
+   (dirty flags set by edits) and evicted LRU under a fixed memory budget. */
+
+typedef struct {
+    unsigned int hits;      /* Subtrees blitted from the cache */
+    unsigned int misses;    /* Subtrees drawn and captured */
+    unsigned int evictions; /* Entries dropped to stay in budget */
+    int entries;            /* Current number of entries */
+    int bytes;              /* Current bitmap memory */
+} math2_cache_stats_t;
+
+/* Get cache statistics */
+void math2_cache_stats(math2_cache_stats_t *stats);
+
+/* Free all cached bitmaps */
+void math2_cache_flush(void);
+
+/* ===== Output Buffer ===== */
+
+/* Streaming output shared by all output formats. Text that doesn't fit is
+   dropped and sets the overflow flag; the buffer is always NUL-terminated. */
+typedef struct {
+    char *buf;
+    int size;           /* Including the NUL */
+    int len;
+    bool overflow;
+} math2_out_t;
+
+/* Start writing into buf, which holds size bytes */
+void math2_out_init(math2_out_t *out, char *buf, int size);
+
+/* Append a character or a string */
+void math2_out_char(math2_out_t *out, char c);
+void math2_out_put(math2_out_t *out, const char *str);
+
 /* ===== LaTeX Generation ===== */
 
+/* LaTeX output styles */
+typedef enum {
+    LATEX_VERBOSE,      /* Braces around every group, sized delimiters */
+    LATEX_COMPACT,      /* Shortest equivalent form, for typing over USB */
+} latex_style_t;
+
 /* Generate LaTeX string from expression */
 void math2_to_latex(math_expr2_t *expr);
 
+/* Generate LaTeX string in the given style. The compact style drops braces
+   around single tokens (x^2, \frac12), uses plain delimiters unless they
+   contain a fraction, and emits no spaces except to end a control word. */
+void math2_to_latex_style(math_expr2_t *expr, latex_style_t style);
+
+/* Write the LaTeX for a root sequence to an output buffer. The output is
+   ASCII: non-ASCII symbols are written with their control words. */
+void math2_write_latex(math2_out_t *out, expr_node_t *root, latex_style_t style);
+
+/* Name of a non-ASCII symbol the editor can insert ("θ" -> "theta"), which is
+   also its LaTeX control word; NULL for anything else */
+const char *math2_symbol_name(const char *utf8);
+
 /* ===== Mode Management ===== */
 
 /* Toggle shift mode */
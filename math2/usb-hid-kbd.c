@@ -594,8 +594,7 @@ int usb_hid_kbd_type_string_progress(char const *str, usb_hid_kbd_progress_cb ca
         }
         else {
             /* Skip unsupported characters, but still update progress */
-            if(callback && (current % 5 == 0 || current == total))
-                callback(current, total);
+            if(callback) callback(current, total);
             continue;
         }
         
@@ -608,9 +607,8 @@ int usb_hid_kbd_type_string_progress(char const *str, usb_hid_kbd_progress_cb ca
         if(rc < 0) return rc;
         kbd_delay(DELAY_FAST_TYPE);
         
-        /* Report progress every 5 chars or at end (reduces UI overhead) */
-        if(callback && (current % 5 == 0 || current == total))
-            callback(current, total);
+        /* Report progress; callers limit how often they redraw */
+        if(callback) callback(current, total);
     }
     
     return 0;
@@ -712,6 +710,14 @@ static bool char_to_hid(char c, uint8_t *modifiers, uint8_t *key)
     else if(c == '<') { *key = HID_KEY_COMMA; *modifiers = HID_MOD_LSHIFT; return true; }
     else if(c == '>') { *key = HID_KEY_DOT; *modifiers = HID_MOD_LSHIFT; return true; }
     else if(c == '?') { *key = HID_KEY_SLASH; *modifiers = HID_MOD_LSHIFT; return true; }
+    /* Editing keys for edit scripts */
+    else if(c == HID_CHAR_SELECT_ALL) { *key = HID_KEY_A; *modifiers = HID_MOD_LCTRL; return true; }
+    else if(c == HID_CHAR_BACKSPACE) { *key = HID_KEY_BACKSPACE; return true; }
+    else if(c == HID_CHAR_LEFT) { *key = HID_KEY_LEFT; return true; }
+    else if(c == HID_CHAR_RIGHT) { *key = HID_KEY_RIGHT; return true; }
+    else if(c == HID_CHAR_HOME) { *key = HID_KEY_HOME; return true; }
+    else if(c == HID_CHAR_END) { *key = HID_KEY_END; return true; }
+    else if(c == HID_CHAR_DELETE) { *key = HID_KEY_DELETE; return true; }
     
     return false;  /* Unsupported character */
 }
@@ -749,8 +755,7 @@ int usb_hid_kbd_type_string_cancellable(char const *str,
         uint8_t modifiers, key;
         if(!char_to_hid(c, &modifiers, &key)) {
             /* Skip unsupported characters, but still update progress */
-            if(progress_cb && (current % 5 == 0 || current == total))
-                progress_cb(current, total);
+            if(progress_cb) progress_cb(current, total);
             continue;
         }
         
@@ -789,8 +794,7 @@ int usb_hid_kbd_type_string_cancellable(char const *str,
         idle_count = 0;
         
         /* Report progress */
-        if(progress_cb && (current % 5 == 0 || current == total))
-            progress_cb(current, total);
+        if(progress_cb) progress_cb(current, total);
     }
     
     return 0;
@@ -99,6 +99,11 @@ enum {
     HID_KEY_F11 = 0x44,
     HID_KEY_F12 = 0x45,
     
+    /* Navigation keys */
+    HID_KEY_HOME = 0x4A,
+    HID_KEY_DELETE = 0x4C,
+    HID_KEY_END = 0x4D,
+    
     /* Arrow keys */
     HID_KEY_RIGHT = 0x4F,
     HID_KEY_LEFT = 0x50,
@@ -118,6 +123,17 @@ enum {
     HID_MOD_RMETA = 0x80,
 };
 
+/* Control characters for editing keys in typed strings. They are only
+   understood by usb_hid_kbd_type_string_cancellable(), and are used for the
+   edit scripts of latex-diff.h. */
+#define HID_CHAR_SELECT_ALL '\x01'   /* Ctrl+A */
+#define HID_CHAR_BACKSPACE  '\b'
+#define HID_CHAR_LEFT       '\x11'
+#define HID_CHAR_RIGHT      '\x12'
+#define HID_CHAR_HOME       '\x13'
+#define HID_CHAR_END        '\x14'
+#define HID_CHAR_DELETE     '\x7f'
+
 //---
 // Keyboard control functions
 //---
@@ -172,6 +188,7 @@ int usb_hid_kbd_type_string_progress(char const *str, usb_hid_kbd_progress_cb ca
 /* usb_hid_kbd_type_string_cancellable(): Type a string with progress and cancellation
    
    Same as usb_hid_kbd_type_string_progress but also checks for cancellation.
+   HID_CHAR_* control characters are typed as the corresponding keys.
    
    @str             Null-terminated string to type
    @progress_cb     Function called with (current_char, total_chars) after each char
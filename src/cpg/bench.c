@@ -0,0 +1,280 @@
+//---
+// gint:cpg:bench - Calibrated benchmarks for clock speed levels
+//---
+
+#include <gint/clock.h>
+#include <gint/display.h>
+#include <gint/dma.h>
+#include <gint/hardware.h>
+#include <gint/image.h>
+#include <gint/rtc.h>
+#include <gint/usb.h>
+#include <gint/usb-ff-bulk.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Minimum duration of a measurement, in RTC ticks (1/128 s) */
+#define BENCH_TICKS 32
+/* Size of the memory copy buffers */
+#define BENCH_BUFFER 8192
+/* Size of the images used by the image rendering benchmarks */
+#define BENCH_IMAGE_W 128
+#define BENCH_IMAGE_H 64
+
+/* Context shared by the operations */
+struct bench {
+	void *src, *dst;
+	char const *file;
+	void *file_buffer;
+	void *image;
+};
+
+/* Type of a benchmark operation: runs n iterations, returns the number of
+   units processed (eg. bytes) */
+typedef uint32_t bench_op_t(struct bench *b, uint32_t n);
+
+static uint32_t measure(bench_op_t *op, struct bench *b);
+
+static uint32_t op_alu(GUNUSED struct bench *b, uint32_t n)
+{
+	uint32_t x = 0x12345678, y = 0;
+	for(uint32_t i = 0; i < n; i++) {
+		x = (x << 3) ^ (x >> 5) ^ i;
+		y += x;
+		__asm__ volatile ("" :: "r"(y));
+	}
+	return n;
+}
+
+static uint32_t op_memcpy(struct bench *b, uint32_t n)
+{
+	for(uint32_t i = 0; i < n; i++) {
+		memcpy(b->dst, b->src, BENCH_BUFFER);
+		__asm__ volatile ("" ::: "memory");
+	}
+	return n * BENCH_BUFFER;
+}
+
+static uint32_t op_dma_memcpy(struct bench *b, uint32_t n)
+{
+	for(uint32_t i = 0; i < n; i++)
+		dma_memcpy(b->dst, b->src, BENCH_BUFFER);
+	return n * BENCH_BUFFER;
+}
+
+static uint32_t op_vram_fill(GUNUSED struct bench *b, uint32_t n)
+{
+	for(uint32_t i = 0; i < n; i++)
+		dclear(i & 1 ? C_BLACK : C_WHITE);
+	return n;
+}
+
+static uint32_t op_dupdate(GUNUSED struct bench *b, uint32_t n)
+{
+	for(uint32_t i = 0; i < n; i++) {
+#if GINT_RENDER_MONO
+		dupdate_invalidate(0, DHEIGHT - 1);
+#endif
+		dupdate();
+	}
+	return n;
+}
+
+static uint32_t op_file_read(struct bench *b, uint32_t n)
+{
+	uint32_t total = 0;
+
+	for(uint32_t i = 0; i < n; i++) {
+		FILE *fp = fopen(b->file, "rb");
+		if(!fp) return 0;
+
+		size_t rc;
+		while((rc = fread(b->file_buffer, 1, BENCH_BUFFER, fp)) > 0)
+			total += rc;
+		fclose(fp);
+	}
+	return total;
+}
+
+#if GINT_RENDER_RGB
+static uint32_t op_image(struct bench *b, uint32_t n)
+{
+	for(uint32_t i = 0; i < n; i++)
+		dimage(0, 0, b->image);
+	return n * BENCH_IMAGE_W * BENCH_IMAGE_H;
+}
+
+/* bench_image(): Measure the rendering speed of an image format */
+static uint32_t bench_image(struct bench *b, int format)
+{
+	image_t *img = image_alloc(BENCH_IMAGE_W, BENCH_IMAGE_H, format);
+	if(!img)
+		return 0;
+
+	if(IMAGE_IS_P8(format) && !image_alloc_palette(img, 256)) {
+		image_free(img);
+		return 0;
+	}
+	for(int i = 0; i < img->color_count; i++)
+		img->palette[i] = i * 0x0101;
+
+	/* Fill the image with a gradient so every palette entry is used */
+	uint8_t *row = img->data;
+	for(int y = 0; y < img->height; y++, row += img->stride)
+	for(int x = 0; x < img->stride; x++)
+		row[x] = x + y;
+
+	b->image = img;
+	uint32_t kpixels = measure(op_image, b) / 1000;
+	image_free(img);
+	return kpixels;
+}
+#endif
+
+/* elapsed(): Number of RTC ticks between two rtc_ticks() values, accounting
+   for the wrap at midnight */
+static uint32_t elapsed(uint32_t start, uint32_t end)
+{
+	uint32_t const day = 128 * 86400;
+	return (end >= start) ? end - start : end + day - start;
+}
+
+/* measure(): Run an operation with an increasing number of iterations until
+   it lasts long enough, then return its throughput in units per second */
+static uint32_t measure(bench_op_t *op, struct bench *b)
+{
+	for(uint32_t n = 1; n < (1u << 30); n <<= 1) {
+		/* Align on a tick boundary to reduce the measurement error */
+		uint32_t t0 = rtc_ticks();
+		while(rtc_ticks() == t0) {}
+		t0 = rtc_ticks();
+
+		uint64_t units = op(b, n);
+		uint32_t ticks = elapsed(t0, rtc_ticks());
+
+		if(units == 0) return 0;
+		if(ticks >= BENCH_TICKS) return (units * 128) / ticks;
+	}
+	return 0;
+}
+
+void clock_bench_run(char const *file, clock_bench_t *res)
+{
+	memset(res, 0, sizeof *res);
+	res->speed = clock_get_speed();
+	res->Iphi_f = clock_freq()->Iphi_f;
+	res->Bphi_f = clock_freq()->Bphi_f;
+
+	/* dma_memcpy() requires 32-aligned buffers */
+	void *buffer = malloc(3 * BENCH_BUFFER + 32);
+	if(!buffer) return;
+
+	struct bench b = {
+		.src = (void *)(((uint32_t)buffer + 31) & ~31),
+		.file = file,
+	};
+	b.dst = b.src + BENCH_BUFFER;
+	b.file_buffer = b.dst + BENCH_BUFFER;
+	memset(b.src, 0x55, BENCH_BUFFER);
+
+	res->results[CLOCK_BENCH_ALU] = measure(op_alu, &b) / 1000;
+	res->results[CLOCK_BENCH_MEMCPY] = measure(op_memcpy, &b) >> 10;
+	if(!isSH3())
+		res->results[CLOCK_BENCH_DMA_MEMCPY] =
+			measure(op_dma_memcpy, &b) >> 10;
+	res->results[CLOCK_BENCH_VRAM_FILL] = measure(op_vram_fill, &b);
+	res->results[CLOCK_BENCH_DUPDATE] = measure(op_dupdate, &b);
+	if(file)
+		res->results[CLOCK_BENCH_FILE_READ] =
+			measure(op_file_read, &b) >> 10;
+#if GINT_RENDER_RGB
+	res->results[CLOCK_BENCH_IMAGE_RGB16] = bench_image(&b, IMAGE_RGB565);
+	res->results[CLOCK_BENCH_IMAGE_P8] = bench_image(&b, IMAGE_P8_RGB565);
+#endif
+
+	free(buffer);
+}
+
+int clock_bench_all(char const *file, clock_bench_t res[5])
+{
+	struct cpg_overclock_setting original;
+	cpg_get_overclock_setting(&original);
+
+	int count = 0;
+	for(int speed = CLOCK_SPEED_F1; speed <= CLOCK_SPEED_F5; speed++) {
+		clock_set_speed(speed);
+		if(clock_get_speed() != speed)
+			continue;
+		clock_bench_run(file, &res[count++]);
+	}
+
+	cpg_set_overclock_setting(&original);
+	return count;
+}
+
+int clock_bench_table(clock_bench_t const *res, int count, char *buf,
+	size_t size)
+{
+	static char const *header =
+		"Lvl  CPU MHz  Bus MHz  ALU kit/s  memcpy kB/s  "
+		"DMA kB/s  fill/s  dupdate/s  read kB/s  RGB16 kpx/s  "
+		"P8 kpx/s\n";
+	int len = snprintf(buf, size, "%s", header);
+
+	for(int i = 0; i < count; i++) {
+		clock_bench_t const *r = &res[i];
+		uint32_t const *x = r->results;
+
+		char lvl[4] = "??";
+		if(r->speed >= CLOCK_SPEED_F1 && r->speed <= CLOCK_SPEED_F5)
+			sprintf(lvl, "F%d", r->speed);
+
+		len += snprintf(buf + len, (size_t)len < size ? size - len : 0,
+			"%-3s  %7d  %7d  %9u  %11u  %8u  %6u  %9u  %9u  %11u  "
+			"%8u\n",
+			lvl, r->Iphi_f / 1000000, r->Bphi_f / 1000000,
+			(uint)x[0], (uint)x[1], (uint)x[2], (uint)x[3],
+			(uint)x[4], (uint)x[5], (uint)x[6], (uint)x[7]);
+	}
+
+	/* Speedups relative to the first row, in percent */
+	if(count > 1) {
+		len += snprintf(buf + len, (size_t)len < size ? size - len : 0,
+			"Relative to first row (%%):\n");
+
+		for(int i = 1; i < count; i++) {
+			len += snprintf(buf + len,
+				(size_t)len < size ? size - len : 0, "F%d  ",
+				res[i].speed);
+			for(int j = 0; j < CLOCK_BENCH_COUNT; j++) {
+				uint32_t ref = res[0].results[j];
+				uint32_t val = res[i].results[j];
+				int pct = ref ? (int)((uint64_t)val * 100 / ref) : 0;
+				len += snprintf(buf + len,
+					(size_t)len < size ? size - len : 0,
+					" %5d", pct);
+			}
+			len += snprintf(buf + len,
+				(size_t)len < size ? size - len : 0, "\n");
+		}
+	}
+
+	return len;
+}
+
+void clock_bench_send(clock_bench_t const *res, int count)
+{
+	if(!usb_is_open())
+		return;
+
+	int len = clock_bench_table(res, count, NULL, 0);
+	char *buf = malloc(len + 1);
+	if(!buf)
+		return;
+
+	clock_bench_table(res, count, buf, len + 1);
+	usb_fxlink_text(buf, len);
+	free(buf);
+}
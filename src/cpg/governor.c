@@ -0,0 +1,196 @@
+//---
+// gint:cpg:governor - Workload-based clock speed control
+//---
+
+#include <gint/clock.h>
+#include <gint/timer.h>
+#include <gint/hardware.h>
+#include <gint/cpu.h>
+#include <gint/config.h>
+
+#include <string.h>
+#include "../cpu/cpu.h"
+
+/* Current policy, decision state and statistics. The statistics and the
+   target are updated by the sampling interrupt, so other accesses to them
+   are atomic. */
+static clock_governor_policy_t policy;
+static clock_governor_state_t state;
+static clock_governor_stats_t stats;
+
+/* Sampling timer, or -1 when the governor is stopped */
+static int timer = -1;
+/* Samples in the current window, and how many of them found the CPU idle */
+static int samples, idle_samples;
+/* Whether the program has marked the current section as idle */
+static bool volatile marked_idle = false;
+/* Speed level decided but not yet applied, or -1 */
+static int8_t volatile target = -1;
+
+void clock_governor_default_policy(clock_governor_policy_t *p)
+{
+	memset(p, 0, sizeof *p);
+
+	/* Levels ordered by CPU frequency, see <gint/clock.h> */
+#if GINT_HW_FX
+	if(gint[HWCALC] == HWCALC_FX9860G_SH3) {
+		p->levels[0] = CLOCK_SPEED_F1;
+		p->levels[1] = CLOCK_SPEED_F2;
+		p->levels[2] = CLOCK_SPEED_F4;
+		p->level_count = 3;
+	}
+	else if(gint[HWCALC] == HWCALC_G35PE2) {
+		p->levels[0] = CLOCK_SPEED_F3;
+		p->levels[1] = CLOCK_SPEED_F1;
+		p->levels[2] = CLOCK_SPEED_F4;
+		p->levels[3] = CLOCK_SPEED_F5;
+		p->level_count = 4;
+	}
+	else {
+		p->levels[0] = CLOCK_SPEED_F1;
+		p->levels[1] = CLOCK_SPEED_F2;
+		p->levels[2] = CLOCK_SPEED_F4;
+		p->levels[3] = CLOCK_SPEED_F5;
+		p->level_count = 4;
+	}
+#endif
+
+#if GINT_HW_CG
+	if(gint[HWCALC] == HWCALC_PRIZM) {
+		p->levels[0] = CLOCK_SPEED_F1;
+		p->levels[1] = CLOCK_SPEED_F3;
+		p->levels[2] = CLOCK_SPEED_F5;
+		p->level_count = 3;
+	}
+	else {
+		p->levels[0] = CLOCK_SPEED_F2;
+		p->levels[1] = CLOCK_SPEED_F1;
+		p->levels[2] = CLOCK_SPEED_F4;
+		p->level_count = 3;
+	}
+#endif
+
+	/* Without known levels, the governor stays at the default speed */
+	if(p->level_count == 0) {
+		p->levels[0] = CLOCK_SPEED_DEFAULT;
+		p->level_count = 1;
+	}
+
+	p->jump_up = true;
+	p->down_delay = 3;
+	p->up_threshold = 200;
+	p->down_threshold = 600;
+	p->sample_us = 2000;
+	p->window = 50;
+}
+
+/* governor_tick(): Sample the CPU state, decide at the end of each window */
+static int governor_tick(void)
+{
+	samples++;
+	if(cpu_sleeping || marked_idle) idle_samples++;
+	if(samples < policy.window) return TIMER_CONTINUE;
+
+	int idle = (idle_samples * 1000) / samples;
+	samples = 0;
+	idle_samples = 0;
+
+	stats.windows++;
+	stats.last_idle = idle;
+	if(stats.speed >= CLOCK_SPEED_F1 && stats.speed <= CLOCK_SPEED_F5)
+		stats.windows_at[stats.speed - CLOCK_SPEED_F1]++;
+
+	int previous = state.level;
+	int next = clock_governor_decide(&policy, &state, idle);
+	if(next != previous) {
+		stats.decisions++;
+		target = policy.levels[next];
+	}
+
+	return TIMER_CONTINUE;
+}
+
+int clock_governor_start(clock_governor_policy_t const *p)
+{
+	clock_governor_policy_t def;
+	if(!p) {
+		clock_governor_default_policy(&def);
+		p = &def;
+	}
+
+	if(p->level_count < 1 || p->level_count > CLOCK_GOVERNOR_LEVELS)
+		return -1;
+	if(!p->sample_us || !p->window)
+		return -1;
+	for(int i = 0; i < p->level_count; i++) {
+		if(p->levels[i] < CLOCK_SPEED_F1 || p->levels[i] > CLOCK_SPEED_F5)
+			return -1;
+	}
+
+	clock_governor_stop();
+	policy = *p;
+	memset(&state, 0, sizeof state);
+	memset(&stats, 0, sizeof stats);
+	samples = 0;
+	idle_samples = 0;
+	target = -1;
+
+	/* Start from the current level if it's in the policy, otherwise go to
+	   the lowest one at the next update */
+	int speed = clock_get_speed();
+	stats.speed = speed;
+	state.level = -1;
+	for(int i = 0; i < policy.level_count; i++) {
+		if(policy.levels[i] == speed) state.level = i;
+	}
+	if(state.level < 0) {
+		state.level = 0;
+		target = policy.levels[0];
+	}
+
+	timer = timer_configure(TIMER_ANY, policy.sample_us,
+		GINT_CALL(governor_tick));
+	if(timer < 0)
+		return -1;
+
+	timer_start(timer);
+	return 0;
+}
+
+void clock_governor_stop(void)
+{
+	if(timer >= 0) timer_stop(timer);
+	timer = -1;
+	target = -1;
+}
+
+bool clock_governor_update(void)
+{
+	cpu_atomic_start();
+	int speed = target;
+	target = -1;
+	cpu_atomic_end();
+
+	if(speed < 0 || clock_get_speed() == speed)
+		return false;
+
+	clock_set_speed(speed);
+
+	cpu_atomic_start();
+	stats.switches++;
+	stats.speed = speed;
+	cpu_atomic_end();
+	return true;
+}
+
+void clock_governor_idle(bool idle)
+{
+	marked_idle = idle;
+}
+
+void clock_governor_stats(clock_governor_stats_t *s)
+{
+	cpu_atomic_start();
+	*s = stats;
+	cpu_atomic_end();
+}
@@ -0,0 +1,43 @@
+//---
+// gint:cpg:governor_decide - Clock governor decision logic
+//
+// This file does not access the hardware so that policies can be studied and
+// tested outside of the calculator.
+//---
+
+#include <gint/clock.h>
+
+int clock_governor_decide(clock_governor_policy_t const *p,
+	clock_governor_state_t *s, int idle)
+{
+	int top = p->level_count - 1;
+	int level = s->level;
+
+	if(level < 0) level = 0;
+	if(level > top) level = top;
+
+	/* Busy: move up immediately, either to the next level or the top */
+	if(idle <= p->up_threshold)
+	{
+		s->down_streak = 0;
+		if(level < top) level = p->jump_up ? top : level + 1;
+	}
+	/* Idle: move down one level after enough consecutive windows */
+	else if(idle >= p->down_threshold)
+	{
+		if(s->down_streak < 255) s->down_streak++;
+		if(level > 0 && s->down_streak >= p->down_delay)
+		{
+			level--;
+			s->down_streak = 0;
+		}
+	}
+	/* In-between: stay, but restart the idle streak */
+	else
+	{
+		s->down_streak = 0;
+	}
+
+	s->level = level;
+	return level;
+}
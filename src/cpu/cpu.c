@@ -33,6 +33,12 @@ static void configure(void)
 	}
 }
 
+/* unbind(): Save the DSP registers before leaving gint's world */
+static void unbind(void)
+{
+	cpu_dsp_flush();
+}
+
 //---
 // Device state and driver metadata
 //---
@@ -78,6 +84,7 @@ static void hrestore(cpu_state_t const *s)
 gint_driver_t drv_cpu = {
 	.name        = "CPU",
 	.configure   = configure,
+	.unbind      = unbind,
 	.hsave       = (void *)hsave,
 	.hrestore    = (void *)hrestore,
 	.state_size  = sizeof(cpu_state_t),
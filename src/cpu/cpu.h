@@ -0,0 +1,19 @@
+//---
+//	gint:cpu - Internal sleep functions
+//---
+
+#ifndef GINT_CPU_CPU
+#define GINT_CPU_CPU
+
+/* Whether the CPU is currently in sleep(), used by the clock governor */
+extern int volatile cpu_sleeping;
+
+/* cpu_idle_cancel_standby(): Fall back to sleep if sleep() chose standby
+
+   The idle state is chosen with interrupts masked, but an interrupt can still
+   occur between the end of the atomic section and the sleep instruction. If
+   its handler starts a TMU or a DMA transfer, which would be frozen in
+   standby, it must call this function so that the CPU only sleeps. */
+void cpu_idle_cancel_standby(void);
+
+#endif /* GINT_CPU_CPU */
@@ -0,0 +1,130 @@
+//---
+// gint:cpu:dsp - Lazy DSP context switching
+//---
+
+#include <gint/cpu.h>
+#include <gint/hardware.h>
+
+/* Context that runs (NULL when lazy switching is inactive) and context whose
+   values are in the DSP registers */
+static cpu_dsp_state_t *dsp_current = NULL;
+static cpu_dsp_state_t *dsp_owner = NULL;
+/* Statistics */
+static uint32_t dsp_traps = 0;
+static uint32_t dsp_switches = 0;
+
+/* SR.DSP */
+#define SR_DSP (1 << 12)
+
+extern void cpu_dsp_save(cpu_dsp_state_t *state);
+extern void cpu_dsp_load(cpu_dsp_state_t const *state);
+
+/* transfer(): Save or load the registers with the DSP temporarily enabled */
+static void transfer(cpu_dsp_state_t *state, bool save)
+{
+	cpu_sr_t SR = cpu_getSR();
+	cpu_sr_t SR2 = SR;
+	SR2.DSP = 1;
+	cpu_setSR(SR2);
+
+	if(save) cpu_dsp_save(state);
+	else cpu_dsp_load(state);
+
+	cpu_setSR(SR);
+}
+
+void cpu_dsp_switch(cpu_dsp_state_t *state)
+{
+	if(isSH3()) return;
+	cpu_atomic_start();
+
+	dsp_current = state;
+	if(!state) dsp_owner = NULL;
+
+	cpu_sr_t SR = cpu_getSR();
+	SR.DSP = (!state || state == dsp_owner);
+	cpu_setSR(SR);
+
+	cpu_atomic_end();
+}
+
+cpu_dsp_state_t *cpu_dsp_owner(void)
+{
+	return dsp_owner;
+}
+
+void cpu_dsp_read(cpu_dsp_state_t *state)
+{
+	if(isSH3()) return;
+	cpu_atomic_start();
+
+	if(dsp_current && dsp_current != dsp_owner)
+		*state = *dsp_current;
+	else
+		transfer(state, true);
+
+	cpu_atomic_end();
+}
+
+void cpu_dsp_write(cpu_dsp_state_t const *state)
+{
+	if(isSH3()) return;
+	cpu_atomic_start();
+
+	if(dsp_current && dsp_current != dsp_owner)
+		*dsp_current = *state;
+	else
+		transfer((cpu_dsp_state_t *)state, false);
+
+	cpu_atomic_end();
+}
+
+void cpu_dsp_flush(void)
+{
+	if(isSH3() || !dsp_current) return;
+	cpu_atomic_start();
+
+	if(dsp_owner) transfer(dsp_owner, true);
+	dsp_owner = NULL;
+
+	cpu_sr_t SR = cpu_getSR();
+	SR.DSP = 0;
+	cpu_setSR(SR);
+
+	cpu_atomic_end();
+}
+
+void cpu_dsp_stats(uint32_t *traps, uint32_t *switches)
+{
+	if(traps) *traps = dsp_traps;
+	if(switches) *switches = dsp_switches;
+}
+
+/* cpu_dsp_trap(): Handle an illegal instruction caused by a disabled DSP
+   This is called by the exception handler before the user's catcher, with
+   BL=0 and IMASK=15. Returns 0 if the exception was handled, in which case the
+   faulting instruction is executed again with the DSP enabled. */
+int cpu_dsp_trap(uint32_t code)
+{
+	if(code != 0x180 && code != 0x1a0) return 1;
+	if(isSH3() || !dsp_current) return 1;
+
+	/* If the DSP was enabled, the instruction is genuinely illegal */
+	uint32_t SSR;
+	__asm__ volatile("stc ssr, %0" : "=r"(SSR));
+	if(SSR & SR_DSP) return 1;
+
+	dsp_traps++;
+	if(dsp_owner != dsp_current)
+	{
+		if(dsp_owner) transfer(dsp_owner, true);
+		transfer(dsp_current, false);
+		dsp_owner = dsp_current;
+		dsp_switches++;
+	}
+
+	__asm__ volatile("stc ssr, %0" : "=r"(SSR));
+	SSR |= SR_DSP;
+	__asm__ volatile("ldc %0, ssr" :: "r"(SSR));
+	return 0;
+}
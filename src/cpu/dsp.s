@@ -0,0 +1,65 @@
+.global _cpu_dsp_save
+.global _cpu_dsp_load
+.text
+
+/* Both functions require SR.DSP=1. The offsets follow cpu_dsp_state_t:
+     0 dsr   4 a0g   8 a0   12 a1g  16 a1   20 m0   24 m1
+    28 x0   32 x1   36 y0   40 y1   44 mod  48 rs   52 re */
+
+/* cpu_dsp_save(): Save the DSP registers to a cpu_dsp_state_t */
+_cpu_dsp_save:
+	sts	dsr, r0
+	mov.l	r0, @r4
+	add	#4, r4
+
+	movs.l	a0g, @r4+
+	movs.l	a0, @r4+
+	movs.l	a1g, @r4+
+	movs.l	a1, @r4+
+	movs.l	m0, @r4+
+	movs.l	m1, @r4+
+	movs.l	x0, @r4+
+	movs.l	x1, @r4+
+	movs.l	y0, @r4+
+	movs.l	y1, @r4+
+
+	stc	mod, r0
+	mov.l	r0, @r4
+	stc	rs, r0
+	mov.l	r0, @(4, r4)
+	stc	re, r0
+	rts
+	mov.l	r0, @(8, r4)
+
+/* cpu_dsp_load(): Load the DSP registers from a cpu_dsp_state_t */
+_cpu_dsp_load:
+	mov.l	@r4+, r0
+	lds	r0, dsr
+
+	/* Loading a0 and a1 sign-extends into the guard bits, so load each
+	   accumulator before its guard register */
+	add	#4, r4
+	movs.l	@r4, a0
+	add	#-4, r4
+	movs.l	@r4+, a0g
+	add	#8, r4
+	movs.l	@r4, a1
+	add	#-4, r4
+	movs.l	@r4+, a1g
+	add	#4, r4
+
+	movs.l	@r4+, m0
+	movs.l	@r4+, m1
+	movs.l	@r4+, x0
+	movs.l	@r4+, x1
+	movs.l	@r4+, y0
+	movs.l	@r4+, y1
+
+	mov.l	@r4+, r0
+	ldc	r0, mod
+	mov.l	@r4+, r0
+	ldc	r0, rs
+	mov.l	@r4, r0
+	ldc	r0, re
+	rts
+	nop
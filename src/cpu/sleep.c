@@ -1,10 +1,127 @@
 #include <gint/cpu.h>
+#include <gint/defer.h>
+#include <gint/timer.h>
+#include <gint/hardware.h>
+#include <gint/mpu/power.h>
+#include <gint/mpu/dma.h>
+#include <string.h>
+#include "cpu.h"
+#include "../tmu/tmu.h"
 
 volatile int cpu_sleep_block_counter = 0;
+volatile int cpu_sleeping = 0;
+
+/* Idle policy and statistics */
+static cpu_idle_policy_t policy = {
+	.standby = false,
+	.standby_min_us = 20000,
+};
+static cpu_idle_stats_t stats;
+
+/* ETMU used as reference clock, or -1 when accounting is disabled, and its
+   value when accounting was started or reset */
+static int clock_id = -1;
+static uint32_t clock_start;
+
+/* ticks_to_us(): Convert TCLK ticks to microseconds */
+static uint64_t ticks_to_us(uint32_t ticks)
+{
+	return ((uint64_t)ticks * 1000000) >> 15;
+}
+
+/* dma_running(): Whether any DMA channel has a transfer in progress */
+static bool dma_running(void)
+{
+	/* Don't access the registers if the module is stopped */
+	if(SH7305_POWER.MSTPCR0.DMAC0)
+		return false;
+
+	sh7305_dma_channel_t *channels[6] = {
+		&SH7305_DMA.DMA0, &SH7305_DMA.DMA1, &SH7305_DMA.DMA2,
+		&SH7305_DMA.DMA3, &SH7305_DMA.DMA4, &SH7305_DMA.DMA5,
+	};
+	for(int i = 0; i < 6; i++) {
+		if(channels[i]->CHCR.DE && !channels[i]->CHCR.TE)
+			return true;
+	}
+	return false;
+}
+
+/* idle_select(): Choose the deepest state allowed right now */
+static cpu_idle_state_t idle_select(uint32_t deadline)
+{
+	if(!policy.standby || !isSH4() || deadline < policy.standby_min_us)
+		return CPU_IDLE_SLEEP;
+
+	/* The TMU stop in standby, so their interrupts would be lost */
+	if(timer_next_deadline(TIMER_TMU) != UINT32_MAX)
+		return CPU_IDLE_SLEEP;
+	/* Transfers and the USB link would be frozen */
+	if(dma_running() || !SH7305_POWER.MSTPCR2.USB0)
+		return CPU_IDLE_SLEEP;
+
+	return CPU_IDLE_STANDBY;
+}
 
 void sleep(void)
 {
-	if(cpu_sleep_block_counter <= 0) __asm__("sleep");
+	/* Run deferred interrupt work first; if there was any, return so that
+	   the caller can check whether the event it waits for has occurred */
+	if(gint_defer_run() || cpu_sleep_block_counter > 0)
+	{
+		stats.skipped++;
+		return;
+	}
+
+	uint32_t start = (clock_id >= 0) ? tmu_clock_read(clock_id) : 0;
+
+	/* The deadline is only needed to choose standby and to measure latency;
+	   computing it costs a few 64-bit divisions with interrupts masked */
+	bool need_deadline = policy.standby || clock_id >= 0;
+
+	/* Choose the state with interrupts masked, so that no handler can start
+	   a timer or a transfer between the checks and the STBY write. Handlers
+	   that run between cpu_atomic_end() and the sleep instruction see
+	   cpu_sleeping and clear STBY with cpu_idle_cancel_standby(). */
+	cpu_atomic_start();
+	uint32_t deadline = need_deadline ? timer_next_deadline(TIMER_ANY)
+		: UINT32_MAX;
+	cpu_idle_state_t state = idle_select(deadline);
+	if(state == CPU_IDLE_STANDBY)
+		SH7305_POWER.STBCR.STBY = 1;
+	cpu_sleeping = 1;
+	cpu_atomic_end();
+
+	__asm__("sleep");
+	cpu_sleeping = 0;
+	if(state == CPU_IDLE_STANDBY) {
+		/* Standby was cancelled by an interrupt: the CPU only slept */
+		if(!SH7305_POWER.STBCR.STBY)
+			state = CPU_IDLE_SLEEP;
+		SH7305_POWER.STBCR.STBY = 0;
+	}
+
+	cpu_idle_state_stats_t *s = &stats.states[state];
+	s->entries++;
+	if(clock_id < 0) return;
+
+	uint64_t us = ticks_to_us(tmu_clock_read(clock_id) - start);
+	s->residency_us += us;
+
+	/* Woken up after the deadline: count the extra delay as latency */
+	if(deadline != UINT32_MAX && us > deadline)
+	{
+		uint32_t latency = us - deadline;
+		s->late_wakes++;
+		s->total_latency_us += latency;
+		if(latency > s->max_latency_us) s->max_latency_us = latency;
+	}
+}
+
+void cpu_idle_cancel_standby(void)
+{
+	if(cpu_sleeping && isSH4())
+		SH7305_POWER.STBCR.STBY = 0;
 }
 
 void sleep_block(void)
@@ -20,3 +137,46 @@ void sleep_unblock(void)
 	cpu_sleep_block_counter--;
 	cpu_atomic_end();
 }
+
+//---
+// Idle states
+//---
+
+void cpu_idle_policy(cpu_idle_policy_t const *p)
+{
+	if(p) {
+		policy = *p;
+	}
+	else {
+		policy.standby = false;
+		policy.standby_min_us = 20000;
+	}
+}
+
+bool cpu_idle_accounting(bool enable)
+{
+	if(enable && clock_id < 0) {
+		clock_id = tmu_clock_start();
+		if(clock_id < 0) return false;
+		cpu_idle_reset();
+	}
+	else if(!enable && clock_id >= 0) {
+		tmu_clock_stop(clock_id);
+		clock_id = -1;
+	}
+	return true;
+}
+
+void cpu_idle_stats(cpu_idle_stats_t *s)
+{
+	*s = stats;
+	if(clock_id >= 0)
+		s->elapsed_us = ticks_to_us(tmu_clock_read(clock_id)-clock_start);
+}
+
+void cpu_idle_reset(void)
+{
+	memset(&stats, 0, sizeof stats);
+	if(clock_id >= 0)
+		clock_start = tmu_clock_read(clock_id);
+}
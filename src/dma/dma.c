@@ -9,6 +9,8 @@
 #include <gint/clock.h>
 #include <gint/exc.h>
 #include <gint/cpu.h>
+#include <gint/defer.h>
+#include "../cpu/cpu.h"
 
 #define DMA SH7305_DMA
 #define POWER SH7305_POWER
@@ -17,6 +19,8 @@ typedef volatile sh7305_dma_channel_t channel_t;
 
 /* Callbacks for all channels */
 static gint_call_t dma_callbacks[6] = { 0 };
+/* Whether each callback is deferred or called from the interrupt handler */
+static bool dma_callbacks_deferred[6] = { 0 };
 /* Sleep blocking flags for all channels */
 static bool dma_sleep_blocking[6] = { 0 };
 /* ICS for dma_channel_wait() for all channels */
@@ -124,24 +128,42 @@ static int dma_setup(int channel, dma_size_t size, uint blocks,
 	return 0;
 }
 
-bool dma_transfer_async(int channel, dma_size_t size, uint blocks,
+static bool transfer_async(int channel, dma_size_t size, uint blocks,
 	void const *src, dma_address_t src_mode, void *dst,
-	dma_address_t dst_mode, gint_call_t callback)
+	dma_address_t dst_mode, gint_call_t callback, bool defer)
 {
 	if(dma_setup(channel, size, blocks, src, src_mode, dst, dst_mode, 1))
 		return false;
 
 	dma_callbacks[channel] = callback;
+	dma_callbacks_deferred[channel] = defer;
 
 	if(dma_sleep_blocking[channel])
 		sleep_block();
 
 	/* Enable channel, starting the DMA transfer. */
+	cpu_idle_cancel_standby();
 	channel_t *ch = dma_channel(channel);
 	ch->CHCR.DE = 1;
 	return true;
 }
 
+bool dma_transfer_async(int channel, dma_size_t size, uint blocks,
+	void const *src, dma_address_t src_mode, void *dst,
+	dma_address_t dst_mode, gint_call_t callback)
+{
+	return transfer_async(channel, size, blocks, src, src_mode, dst,
+		dst_mode, callback, true);
+}
+
+bool dma_transfer_async_direct(int channel, dma_size_t size, uint blocks,
+	void const *src, dma_address_t src_mode, void *dst,
+	dma_address_t dst_mode, gint_call_t callback)
+{
+	return transfer_async(channel, size, blocks, src, src_mode, dst,
+		dst_mode, callback, false);
+}
+
 /* Interrupt handler for all finished DMA transfers */
 static void dma_interrupt_transfer_ended(int channel)
 {
@@ -160,8 +182,13 @@ static void dma_interrupt_transfer_ended(int channel)
 	if(dma_wait_ics[channel])
 		cpu_csleep_cancel(dma_wait_ics[channel]);
 
-	gint_call(dma_callbacks[channel]);
+	/* Leave user callbacks to the main program */
+	gint_call_t callback = dma_callbacks[channel];
 	dma_callbacks[channel] = GINT_CALL_NULL;
+	if(dma_callbacks_deferred[channel])
+		gint_defer(callback);
+	else
+		gint_call(callback);
 }
 
 /* dma_channel_wait(): Wait for a particular channel's transfer to finish
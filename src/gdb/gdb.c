@@ -321,11 +321,35 @@ static void gdb_handle_read_general_registers(gdb_cpu_state_t* cpu_state)
 	gdb_send_packet(reply_buffer, sizeof(reply_buffer));
 }
 
+/* DSP registers of the stopped context, read when entering gdb_main() since
+   the stub itself may use the DSP (eg. in USB FIFO accesses) */
+static cpu_dsp_state_t gdb_dsp_state;
+
+/* Address of a DSP register in gdb_dsp_state from its GDB number */
+static uint32_t* gdb_dsp_register(uint32_t register_id)
+{
+	if (!isSH4())
+		return NULL;
+	if (register_id >= 24 && register_id <= 34)
+		return &((uint32_t*)&gdb_dsp_state)[register_id - 24];
+	if (register_id == 40)
+		return &gdb_dsp_state.mod;
+	if (register_id == 43)
+		return &gdb_dsp_state.rs;
+	if (register_id == 44)
+		return &gdb_dsp_state.re;
+	return NULL;
+}
+
 static void gdb_handle_read_register(gdb_cpu_state_t* cpu_state, const char* packet)
 {
 	uint8_t register_id = gdb_unhexlify(&packet[1]);
+	uint32_t* dsp_register = gdb_dsp_register(register_id);
 	char reply_buffer[8];
-	if (!cpu_state || register_id >= sizeof(cpu_state->regs)/sizeof(uint32_t)) {
+	if (cpu_state && dsp_register) {
+		gdb_hexlify(reply_buffer, (uint8_t*)dsp_register,
+			    sizeof(*dsp_register));
+	} else if (!cpu_state || register_id >= sizeof(cpu_state->regs)/sizeof(uint32_t)) {
 		memset(reply_buffer, 'x', sizeof(reply_buffer));
 	} else {
 		gdb_hexlify(reply_buffer, (uint8_t*)&cpu_state->regs[register_id],
@@ -336,8 +360,9 @@ static void gdb_handle_read_register(gdb_cpu_state_t* cpu_state, const char* pac
 
 static void gdb_handle_write_general_registers(gdb_cpu_state_t* cpu_state, const char* packet)
 {
+	// Without a stopped context, there is nowhere to write registers to
 	if (!cpu_state) {
-		gdb_send_packet(NULL, 0);
+		gdb_send_packet("E03", 3); // ESRCH
 		return;
 	}
 
@@ -358,8 +383,9 @@ static void gdb_handle_write_general_registers(gdb_cpu_state_t* cpu_state, const
 
 static void gdb_handle_write_register(gdb_cpu_state_t* cpu_state, const char* packet)
 {
+	// Without a stopped context, DSP registers are not restored either
 	if (!cpu_state) {
-		gdb_send_packet(NULL, 0);
+		gdb_send_packet("E03", 3); // ESRCH
 		return;
 	}
 
@@ -378,8 +404,12 @@ static void gdb_handle_write_register(gdb_cpu_state_t* cpu_state, const char* pa
 
 	uint32_t register_id = gdb_unhexlify(register_id_hex);
 	uint32_t value = gdb_unhexlify(value_hex);
+	uint32_t* dsp_register = gdb_dsp_register(register_id);
 
-	if (register_id >= sizeof(cpu_state->regs)/sizeof(uint32_t)) {
+	if (dsp_register) {
+		*dsp_register = value;
+		gdb_send_packet("OK", 2);
+	} else if (register_id >= sizeof(cpu_state->regs)/sizeof(uint32_t)) {
 		gdb_send_packet(NULL, 0);
 	} else {
 		cpu_state->regs[register_id] = value;
@@ -665,6 +695,8 @@ void gdb_main(gdb_cpu_state_t* cpu_state)
 	}
 
 	if (cpu_state != NULL) {
+		cpu_dsp_read(&gdb_dsp_state);
+
 		/* Ajust PC after a software breakpoint */
 		if (gdb_trap_number == TRA_SWBREAK)
 			cpu_state->reg.pc -= 2;
@@ -748,6 +780,9 @@ ret:
 	// We're started after the first round of exchanges
 	gdb_started = true;
 
+	if (cpu_state != NULL)
+		cpu_dsp_write(&gdb_dsp_state);
+
 	gdb_signal_number = 0;
 	gdb_trap_number = 0;
 }
@@ -7,8 +7,10 @@
 #include <gint/gray.h>
 #include <gint/display.h>
 #include <gint/timer.h>
+#include <gint/cpu.h>
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "../render-fx/render-fx.h"
 #include "../render/render.h"
@@ -46,6 +48,14 @@ static int runs = 0;
 /* Delays of the light and dark frames for the above setting */
 GBSS static int delays[2];
 
+/* Rows where the light and dark VRAMs differ, for each pair; these rows must
+   be sent at every frame */
+GBSS static uint8_t flicker[2][DHEIGHT];
+/* Rows that must be sent once at the next frame, after a swap */
+GBSS static uint8_t volatile pending[DHEIGHT];
+/* Rows modified in the previous drawing period (for the other pair) */
+GBSS static uint8_t last_dirty[DHEIGHT];
+
 static int gray_int(void);
 
 #endif
@@ -150,9 +160,34 @@ GDESTRUCTOR static void gray_quit(void)
 }
 
 #if GINT_HW_FX
+/* gray_flicker(): Find the rows of a VRAM pair that differ between VRAMs
+   @pair  Index of the pair's light VRAM (0 or 2)
+   @rows  Rows to check (NULL for all rows) */
+static void gray_flicker(int pair, uint8_t const *rows)
+{
+	uint32_t const *light = vrams[pair];
+	uint32_t const *dark = vrams[pair | 1];
+	uint8_t *f = flicker[pair >> 1];
+
+	for(int y = 0; y < DHEIGHT; y++, light += 4, dark += 4)
+	{
+		if(rows && !rows[y]) continue;
+		f[y] = (light[0] != dark[0]) || (light[1] != dark[1])
+		    || (light[2] != dark[2]) || (light[3] != dark[3]);
+	}
+}
+
 /* gray_start(): Start the gray engine */
 static void gray_start(void)
 {
+	/* The screen contents and the other pair are unknown, so the next two
+	   frames are sent in full */
+	gray_flicker(0, NULL);
+	gray_flicker(2, NULL);
+	memset((void *)pending, 1, DHEIGHT);
+	memset(last_dirty, 1, DHEIGHT);
+	memset(dupdate_dirty, 0, DHEIGHT);
+
 	st = 2;
 	timer_reload(GRAY_TIMER, delays[0]);
 	timer_start(GRAY_TIMER);
@@ -224,7 +259,20 @@ int dgray(int mode)
 /* gray_int(): Interrupt handler */
 int gray_int(void)
 {
-	t6k11_display(vrams[st ^ 2], 0, 64, 16);
+	uint8_t const *f = flicker[(st ^ 2) >> 1];
+	uint8_t rows[DHEIGHT];
+
+	if(t6k11_contents_lost())
+		memset((void *)pending, 1, DHEIGHT);
+
+	/* Send rows that flicker or have changed since the last swap */
+	for(int y = 0; y < DHEIGHT; y++)
+	{
+		rows[y] = f[y] | pending[y];
+		pending[y] = 0;
+	}
+
+	t6k11_display_rows(vrams[st ^ 2], rows, 16);
 	timer_reload(GRAY_TIMER, delays[(st ^ 3) & 1]);
 	st ^= 1;
 
@@ -245,11 +293,27 @@ int gupdate(void)
 	{
 		gray_stop();
 		dmode = NULL;
+		/* The screen holds gray frames, send the full VRAM */
+		memset(dupdate_dirty, 1, DHEIGHT);
 		return 1;
 	}
 
+	/* The new pair differs from the displayed one only on rows that were
+	   modified in either pair during their last drawing period */
+	int pair = st & 2;
+	gray_flicker(pair, dupdate_dirty);
+
 	/* When the engine is running, swap frames */
+	cpu_atomic_start();
+	for(int y = 0; y < DHEIGHT; y++)
+	{
+		pending[y] |= dupdate_dirty[y] | last_dirty[y];
+		last_dirty[y] = dupdate_dirty[y];
+	}
 	st ^= 2;
+	cpu_atomic_end();
+
+	memset(dupdate_dirty, 0, DHEIGHT);
 	return 0;
 }
 #elif GINT_HW_CG
@@ -262,6 +326,7 @@ int gupdate(void)
 	}
 
 	r61524_display_gray_128x64(vrams[0], vrams[1]);
+	memset(dupdate_dirty, 0, DHEIGHT);
 	return 0;
 }
 #endif
@@ -97,6 +97,7 @@ static const uint16_t sh3_vbr_map[] = {
 	1,      /* ETMU logic #2 */
 	1,      /* ETMU logic #3 */
 	0xaa0,  /* RTC Periodic Interrupt */
+	0xa80,  /* RTC Alarm Interrupt */
 	0
 };
 
@@ -0,0 +1,200 @@
+//---
+//	gint:intc:trace - Interrupt latency instrumentation
+//---
+
+#include <gint/intc.h>
+#include <gint/cpu.h>
+#include <gint/clock.h>
+#include <gint/hardware.h>
+#include <gint/usb.h>
+#include <gint/usb-ff-bulk.h>
+#include <gint/defs/attributes.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../tmu/tmu.h"
+
+/* Number of interrupt sources, indexed by (event_code - 0x400) / 0x20 */
+#define SOURCES 96
+/* Maximum nesting depth that is tracked */
+#define DEPTH 8
+
+/* Statistics for all sources, in TMU2 ticks */
+static intc_trace_stat_t stats[SOURCES];
+
+/* Stack of running handlers */
+static struct frame {
+	int source;
+	/* Counter value at entry (TMU2 counts down) */
+	uint32_t start;
+	/* Time spent in handlers nested within this one */
+	uint32_t nested_time;
+} frames[DEPTH];
+static int depth = 0;
+
+/* Address of the TMU2 counter */
+static uint32_t volatile *counter = NULL;
+
+/* intc_trace_dispatch(): Time and run an interrupt handler block
+
+   This is called by the instrumented entry gate with the event code. It runs
+   with SR.BL=1, so it must be permanently mapped, and may not call any other
+   function than the handler block. It is compiled for SH3 on fx-9860G, so
+   variable shifts (which call into libgcc) are also avoided. */
+GSECTION(".gint.mapped") GVISIBLE
+void intc_trace_dispatch(uint32_t event)
+{
+	uint32_t vbr;
+	__asm__("stc vbr, %0" : "=r"(vbr));
+	void (*block)(void) = (void *)(vbr + 0x640 + (event - 0x400));
+
+	int source = (event - 0x400) >> 5;
+	intc_trace_stat_t *s = &stats[source];
+
+	/* Handlers nested more than DEPTH levels deep are not timed, and only
+	   the handlers that have a frame record being preempted */
+	struct frame *parent = (depth > 0 && depth <= DEPTH) ? &frames[depth-1]
+		: NULL;
+	struct frame *f = (depth < DEPTH) ? &frames[depth] : NULL;
+
+	if(depth > 0) s->nested++;
+	if(parent) {
+		stats[parent->source].preempted++;
+		stats[parent->source].last_preemptor = event;
+	}
+
+	if(f) {
+		f->source = source;
+		f->nested_time = 0;
+		f->start = *counter;
+	}
+	depth++;
+
+	block();
+
+	depth--;
+	if(!f) return;
+
+	uint32_t elapsed = f->start - *counter;
+	s->count++;
+	s->total_time += elapsed;
+	if(elapsed > s->max_time) s->max_time = elapsed;
+	s->self_time += elapsed - f->nested_time;
+	s->delay_time += f->nested_time;
+	if(f->nested_time > s->max_delay) s->max_delay = f->nested_time;
+
+	if(parent) parent->nested_time += elapsed;
+}
+
+//---
+// Control
+//---
+
+static bool enabled = false;
+
+void intc_trace_reset(void)
+{
+	cpu_atomic_start();
+	memset(stats, 0, sizeof stats);
+	cpu_atomic_end();
+}
+
+bool intc_trace_start(void)
+{
+	extern void gint_inth_7305_trace(void);
+	if(isSH3()) return false;
+	if(enabled) return true;
+	if(!tmu_trace_start()) return false;
+
+	counter = tmu_trace_counter();
+	intc_trace_reset();
+
+	cpu_atomic_start();
+	depth = 0;
+	memcpy((void *)cpu_getVBR() + 0x600, gint_inth_7305_trace, 64);
+	enabled = true;
+	cpu_atomic_end();
+	return true;
+}
+
+void intc_trace_stop(void)
+{
+	extern void gint_inth_7305(void);
+	if(!enabled) return;
+
+	cpu_atomic_start();
+	memcpy((void *)cpu_getVBR() + 0x600, gint_inth_7305, 64);
+	enabled = false;
+	cpu_atomic_end();
+
+	tmu_trace_stop();
+}
+
+//---
+// Reporting
+//---
+
+/* Convert TMU2 ticks (Pphi/4) to microseconds */
+static uint32_t us(uint32_t ticks)
+{
+	uint32_t Pphi = clock_freq()->Pphi_f;
+	return ((uint64_t)ticks * 4000000) / Pphi;
+}
+
+bool intc_trace_get(int event_code, intc_trace_stat_t *stat)
+{
+	if(event_code < 0x400 || event_code >= 0x400 + 0x20 * SOURCES)
+		return false;
+
+	cpu_atomic_start();
+	intc_trace_stat_t s = stats[(event_code - 0x400) >> 5];
+	cpu_atomic_end();
+
+	if(!s.count) return false;
+
+	s.event = event_code & ~0x1f;
+	s.total_time = us(s.total_time);
+	s.max_time = us(s.max_time);
+	s.self_time = us(s.self_time);
+	s.delay_time = us(s.delay_time);
+	s.max_delay = us(s.max_delay);
+	*stat = s;
+	return true;
+}
+
+int intc_trace_table(char *buf, size_t size)
+{
+	int len = snprintf(buf, size, "Event  Count     Avg us   Max us  "
+		"Self us   Delay us  Max delay  Nested  Preempted  Last by\n");
+
+	for(int i = 0; i < SOURCES; i++) {
+		intc_trace_stat_t s;
+		if(!intc_trace_get(0x400 + 0x20 * i, &s))
+			continue;
+
+		len += snprintf(buf + len, (size_t)len < size ? size - len : 0,
+			"0x%03x  %8u  %7u  %7u  %9u  %9u  %9u  %6u  %9u  0x%03x\n",
+			s.event, (uint)s.count, (uint)(s.total_time / s.count),
+			(uint)s.max_time, (uint)s.self_time,
+			(uint)s.delay_time, (uint)s.max_delay, (uint)s.nested,
+			(uint)s.preempted, s.last_preemptor);
+	}
+
+	return len;
+}
+
+void intc_trace_send(void)
+{
+	if(!usb_is_open())
+		return;
+
+	int len = intc_trace_table(NULL, 0);
+	char *buf = malloc(len + 1);
+	if(!buf)
+		return;
+
+	intc_trace_table(buf, len + 1);
+	usb_fxlink_text(buf, len);
+	free(buf);
+}
@@ -0,0 +1,58 @@
+//---
+//	gint:core:boottime - Report of the driver boot times
+//---
+
+#include <gint/drivers.h>
+#include <gint/usb.h>
+#include <gint/usb-ff-bulk.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+int gint_driver_boot_time_ms(int i, int *frac)
+{
+	if(!gint_driver_boot_time || i < 0 || i >= gint_driver_count())
+		return -1;
+
+	int32_t us = gint_driver_boot_time[i];
+	if(us < 0)
+		return -1;
+	if(frac)
+		*frac = us % 1000;
+	return us / 1000;
+}
+
+int gint_driver_boot_table(char *buf, size_t size)
+{
+	int len = snprintf(buf, size, "Driver      Boot ms\n");
+
+	for(int i = 0; i < gint_driver_count(); i++) {
+		char const *name = gint_drivers[i].name;
+		size_t left = (size_t)len < size ? size - len : 0;
+		int frac, ms = gint_driver_boot_time_ms(i, &frac);
+
+		if(ms < 0)
+			len += snprintf(buf + len, left, "%-10s        -\n",
+				name ? name : "?");
+		else
+			len += snprintf(buf + len, left, "%-10s %4d.%03d\n",
+				name ? name : "?", ms, frac);
+	}
+
+	return len;
+}
+
+void gint_driver_boot_send(void)
+{
+	if(!usb_is_open())
+		return;
+
+	int len = gint_driver_boot_table(NULL, 0);
+	char *buf = malloc(len + 1);
+	if(!buf)
+		return;
+
+	gint_driver_boot_table(buf, len + 1);
+	usb_fxlink_text(buf, len);
+	free(buf);
+}
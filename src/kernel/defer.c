@@ -0,0 +1,48 @@
+//---
+//	gint:core:defer - Deferred interrupt work
+//---
+
+#include <gint/defer.h>
+#include <gint/cpu.h>
+
+/* Kernel queue, filled by interrupt handlers */
+static gint_defer_queue_t queue;
+
+void gint_defer(gint_call_t call)
+{
+	if(!call.function) return;
+
+	/* Nested interrupts may post at the same time, so serialize the
+	   reservation; the copy of the call is done with interrupts enabled */
+	cpu_atomic_start();
+	int slot = gint_defer_queue_reserve(&queue);
+	if(slot < 0) queue.overflows++;
+	cpu_atomic_end();
+
+	if(slot < 0)
+		gint_call(call);
+	else
+		gint_defer_queue_publish(&queue, slot, call);
+}
+
+int gint_defer_run(void)
+{
+	gint_call_t call;
+	int count = 0;
+
+	while(gint_defer_queue_pop(&queue, &call)) {
+		gint_call(call);
+		count++;
+	}
+	return count;
+}
+
+int gint_defer_pending(void)
+{
+	return gint_ring_count(&queue.ring);
+}
+
+gint_defer_queue_t const *gint_defer_queue(void)
+{
+	return &queue;
+}
@@ -64,6 +64,7 @@ GNORETURN static void gint_default_panic(GUNUSED uint32_t code)
 	memset(gint_vram, 0, 1024);
 	dtext(1, 0, "Exception! (SysERROR)");
 	for(int i = 0; i < 32; i++) gint_vram[i] = ~gint_vram[i];
+	dupdate_invalidate(0, DHEIGHT - 1);
 
 	char const *name = "";
 	if(code == 0x040) name = "TLB miss read";
@@ -20,12 +20,6 @@ _gint_exch:
 	mov.l	.expevt_sh3, r8
 
 catch:
-	/* Panic if the catcher is NULL */
-	mov.l	.catcher, r0
-	mov.l	@r0, r0
-	tst	r0, r0
-	bt	panic
-
 	/* Set BL=0, IMASK=15 */
 	stc	sr, r9
 	mov.l	.SR_set_IMASK, r1
@@ -34,11 +28,25 @@ catch:
 	and	r2, r1
 	ldc	r1, sr
 
-	/* Call the catcher and leave if it returns zero (exception handled) */
+	/* Let the lazy DSP switch handle its traps first */
+	mov.l	.dsp_trap, r0
 	jsr	@r0
 	mov.l	@r8, r4
+	tst	r0, r0
+	bt	1f
+
+	/* Panic if the catcher is NULL */
+	mov.l	.catcher, r1
+	mov.l	@r1, r1
+	tst	r1, r1
+	bt/s	1f
+	mov	#1, r0
+
+	/* Call the catcher and leave if it returns zero (exception handled) */
+	jsr	@r1
+	mov.l	@r8, r4
 
-	ldc	r9, sr
+1:	ldc	r9, sr
 	tst	r0, r0
 	bt	end
 
@@ -83,6 +91,8 @@ end:
 	.long	0xffffffd4
 .catcher:
 	.long	_gint_exc_catcher
+.dsp_trap:
+	.long	_cpu_dsp_trap
 .panic:
 	.long	_gint_exc_panic
 .SR_set_IMASK:
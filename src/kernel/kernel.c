@@ -29,10 +29,63 @@ gint_world_t gint_world_addin = NULL;
 
 /* Dynamic flags for all drivers */
 uint8_t *gint_driver_flags = NULL;
+/* Boot time of all drivers */
+int32_t *gint_driver_boot_time = NULL;
 
 /* Top of the stack */
 void *gint_stack_top = NULL;
 
+/* Arenas over the unused parts of ILRAM and XYRAM */
+static kmalloc_arena_t onchip_arenas[2] = { 0 };
+/* On-chip arena created by a driver, if any (PRAM0 for the SPU) */
+static kmalloc_arena_t *driver_onchip_arena = NULL;
+
+/* init_onchip_arenas(): (Re)initialize the on-chip arenas */
+static void init_onchip_arenas(void)
+{
+	extern uint32_t rilram, silram, rxyram, sxyram;
+	kmalloc_arena_t *il = &onchip_arenas[0], *xy = &onchip_arenas[1];
+
+	il->name = "_ilram";
+	il->flags = KMALLOC_FAST | KMALLOC_ONCHIP;
+	il->start = (void *)(((uint32_t)&rilram + (uint32_t)&silram + 3) & ~3);
+	il->end = (void *)0xe5201000;
+	kmalloc_init_arena(il, true);
+
+	xy->name = "_xyram";
+	xy->flags = KMALLOC_FAST | KMALLOC_ONCHIP;
+	xy->start = (void *)(((uint32_t)&rxyram + (uint32_t)&sxyram + 3) & ~3);
+	xy->end = (void *)0xe5012000;
+	kmalloc_init_arena(xy, true);
+}
+
+/* reset_arena(): Free all blocks of an arena that has been created */
+static void reset_arena(kmalloc_arena_t *a)
+{
+	/* Arenas that were too small to be created are left out */
+	if(!a || !a->malloc) return;
+
+	kmalloc_init_arena(a, true);
+	a->stats.live_blocks = 0;
+}
+
+/* gint_add_onchip_arena(): Register the on-chip arena of a driver */
+void gint_add_onchip_arena(kmalloc_arena_t *arena)
+{
+	driver_onchip_arena = arena;
+}
+
+/* gint_reset_onchip_arenas(): Reset on-chip arenas after their loss */
+void gint_reset_onchip_arenas(bool all)
+{
+	if(all)
+	{
+		reset_arena(&onchip_arenas[0]);
+		reset_arena(&onchip_arenas[1]);
+	}
+	reset_arena(driver_onchip_arena);
+}
+
 //---
 //	Initialization and unloading
 //---
@@ -114,10 +167,22 @@ void kinit(void)
 	kmalloc_add_arena(&os_stack);
 	#endif
 
+	/* Create arenas in the unused parts of on-chip memory */
+	if(!isSH3())
+	{
+		init_onchip_arenas();
+		for(int i = 0; i < 2; i++)
+		{
+			if(onchip_arenas[i].malloc)
+				kmalloc_add_arena(&onchip_arenas[i]);
+		}
+	}
+
 	/* Allocate world buffers for the OS and for gint */
 	gint_world_os = gint_world_alloc();
 	gint_world_addin = gint_world_alloc();
 	gint_driver_flags = malloc(gint_driver_count());
+	gint_driver_boot_time = malloc(gint_driver_count() * sizeof(int32_t));
 
 	/* Allocate VRAMs, which is important for panic screens */
 	extern bool dvram_init(void);
@@ -125,7 +190,8 @@ void kinit(void)
 	if(!dvram_init())
 		abort();
 
-	if(!gint_world_os || !gint_world_addin || !gint_driver_flags)
+	if(!gint_world_os || !gint_world_addin || !gint_driver_flags
+		|| !gint_driver_boot_time)
 		gint_panic(0x1060);
 
 	/* Initialize drivers */
@@ -136,6 +202,7 @@ void kinit(void)
 
 		uint8_t *f = &gint_driver_flags[i];
 		*f = (d->flags & GINT_DRV_INIT_) | GINT_DRV_CLEAN;
+		gint_driver_boot_time[i] = -1;
 	}
 
 	/* Select the VBR address for this world before configuring */
@@ -157,8 +224,10 @@ void kquit(void)
 	gint_world_free(gint_world_os);
 	gint_world_free(gint_world_addin);
 	free(gint_driver_flags);
+	free(gint_driver_boot_time);
 
 	gint_world_os = NULL;
 	gint_world_addin = NULL;
 	gint_driver_flags = NULL;
+	gint_driver_boot_time = NULL;
 }
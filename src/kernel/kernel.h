@@ -5,9 +5,24 @@
 #ifndef GINT_CORE_KERNEL
 #define GINT_CORE_KERNEL
 
+#include <gint/kmalloc.h>
+
 /* gint_load_onchip_sections(): Initialize on-chip memory sections */
 void gint_load_onchip_sections(void);
 
+/* gint_add_onchip_arena(): Register the on-chip arena of a driver
+   This is used for "_pram0" when the SPU driver is activated. PRAM0 does not
+   fit in the buffer of the backup mode, so this arena is reset after world
+   switches in both the reinitialization and backup modes. */
+void gint_add_onchip_arena(kmalloc_arena_t *arena);
+
+/* gint_reset_onchip_arenas(): Reset on-chip arenas after their loss
+   With (all=true), resets the "_ilram" and "_xyram" arenas after on-chip
+   memory has been reinitialized, along with the driver arenas. With
+   (all=false), resets only the driver arenas, which are not backed up. This
+   frees all of the blocks of the arenas. */
+void gint_reset_onchip_arenas(bool all);
+
 /* gint_copy_vram(): Copy gint's VRAM to the OS to avoid flickering during
    certain world switches. */
 void gint_copy_vram(void);
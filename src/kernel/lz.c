@@ -0,0 +1,86 @@
+//---
+//	gint:core:lz - LZ4 block decoder for compressed data sections
+//---
+
+#include <gint/lz.h>
+#include <string.h>
+
+/* read_length(): Read the extension bytes of a literal or match length */
+static inline int read_length(uint8_t const **src, uint8_t const *src_end,
+	size_t *length)
+{
+	uint8_t const *s = *src;
+	int byte;
+
+	do {
+		if(s >= src_end) return -1;
+		byte = *s++;
+		*length += byte;
+	}
+	while(byte == 255);
+
+	*src = s;
+	return 0;
+}
+
+int gint_lz_decompress(void const *src_0, size_t src_size, void *dst_0,
+	size_t dst_size)
+{
+	uint8_t const *src = src_0, *src_end = src + src_size;
+	uint8_t *dst = dst_0, *dst_end = dst + dst_size;
+
+	while(src < src_end)
+	{
+		int token = *src++;
+
+		/* Literal run, copied in one go */
+		size_t length = token >> 4;
+		if(length == 15 && read_length(&src, src_end, &length))
+			return -1;
+		if(length > (size_t)(src_end - src))
+			return -1;
+		if(length > (size_t)(dst_end - dst))
+			return -1;
+
+		memcpy(dst, src, length);
+		src += length;
+		dst += length;
+
+		/* The last sequence of a block has no match */
+		if(src >= src_end)
+			break;
+		if(src_end - src < 2)
+			return -1;
+
+		size_t offset = src[0] | (src[1] << 8);
+		src += 2;
+		if(offset == 0 || offset > (size_t)(dst - (uint8_t *)dst_0))
+			return -1;
+
+		length = (token & 15) + 4;
+		if((token & 15) == 15 && read_length(&src, src_end, &length))
+			return -1;
+		if(length > (size_t)(dst_end - dst))
+			return -1;
+
+		/* Matches that don't overlap with their output can use an
+		   optimized copy; otherwise the copy has to go byte by byte
+		   since it repeats its own output */
+		uint8_t const *match = dst - offset;
+		if(offset >= length) {
+			memcpy(dst, match, length);
+			dst += length;
+		}
+		else while(length--) {
+			*dst++ = *match++;
+		}
+	}
+
+	return dst - (uint8_t *)dst_0;
+}
+
+bool gint_lz_load(gint_lz_section_t const *s)
+{
+	int rc = gint_lz_decompress(s->src, s->src_size, s->dst, s->dst_size);
+	return rc >= 0 && (uint32_t)rc == s->dst_size;
+}
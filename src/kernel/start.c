@@ -9,6 +9,7 @@
 #include <gint/gint.h>
 #include <gint/hardware.h>
 #include <gint/exc.h>
+#include <gint/lz.h>
 #include <setjmp.h>
 #include <stdlib.h>
 #include <string.h>
@@ -29,6 +30,9 @@ extern uint32_t
 	lgmapped, sgmapped,		/* Permanently mapped functions */
 	lreloc, sreloc;			/* Relocatable references */
 
+/* Descriptors of compressed data sections, provided by the linker script */
+extern gint_lz_section_t blzdata, elzdata;
+
 /* Constructor and destructor arrays */
 extern void (*bctors)(void), (*ectors)(void);
 extern void (*bdtors)(void), (*edtors)(void);
@@ -157,6 +161,14 @@ static int start2(int isappli, int optnum)
 	#endif
 	regclr(&rbss, &sbss);
 
+	/* Decompress data that was packed at build time. It is decoded into
+	   BSS buffers, so this must happen after the BSS is cleared. There is
+	   no way to report an error yet; the host tool checks the streams. */
+	for(gint_lz_section_t const *s = &blzdata; s < &elzdata; s++)
+	{
+		if(!(s->flags & GINT_LZ_LAZY)) gint_lz_load(s);
+	}
+
 	gint_load_onchip_sections();
 
 	#if !GINT_OS_CP
@@ -5,7 +5,9 @@
 #include <gint/defs/call.h>
 #include <gint/hardware.h>
 #include <gint/display.h>
+#include <gint/clock.h>
 #include "kernel.h"
+#include "../tmu/tmu.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -52,6 +54,7 @@ void gint_world_sync(void)
 	for(int i = gint_driver_count() - 1; i >= 0; i--)
 	{
 		gint_driver_t *d = &gint_drivers[i];
+		if(gint_driver_flags[i] & GINT_DRV_LAZY) continue;
 		if(d->unbind) d->unbind();
 	}
 }
@@ -63,52 +66,78 @@ void gint_world_sync(void)
 static int onchip_save_mode = GINT_ONCHIP_REINITIALIZE;
 static void *onchip_save_buffer = NULL;
 
+/* switch_in_driver(): Switch a single driver to the gint world */
+static void switch_in_driver(int i, gint_world_t world_os,
+	gint_world_t world_addin)
+{
+	gint_driver_t *d = &gint_drivers[i];
+	uint8_t *f = &gint_driver_flags[i];
+
+	bool foreign_powered = (!d->hpowered || d->hpowered());
+	if(foreign_powered)
+		*f |= GINT_DRV_FOREIGN_POWERED;
+	else
+		*f &= ~GINT_DRV_FOREIGN_POWERED;
+
+	/* Power the device if it was unpowered previously */
+	if(!foreign_powered && d->hpoweron) d->hpoweron();
+
+	/* For non-shared devices, save previous device state and consider
+	   restoring the preserved one */
+	if(!(*f & GINT_DRV_SHARED))
+	{
+		if(d->hsave)
+			d->hsave(world_os[i]);
+		if(!(*f & GINT_DRV_CLEAN) && d->hrestore)
+			d->hrestore(world_addin[i]);
+	}
+
+	/* Bind the driver, configure if needed. Note that we either configure
+	   or restore the new world's state, not both */
+	if(d->bind) d->bind();
+
+	if(*f & GINT_DRV_CLEAN)
+	{
+		if(d->configure) d->configure();
+		*f &= ~GINT_DRV_CLEAN;
+	}
+}
+
 void gint_world_switch_in(gint_world_t world_os, gint_world_t world_addin)
 {
 	/* Unbind from the OS driver and complete foreign asynchronous tasks */
 	for(int i = gint_driver_count() - 1; i >= 0; i--)
 	{
 		gint_driver_t *d = &gint_drivers[i];
+		if(gint_driver_flags[i] & GINT_DRV_LAZY) continue;
 		if(d->funbind) d->funbind();
 	}
 
 	cpu_atomic_start();
 
+	/* On the first switch, time drivers once the TMU is available */
+	bool tracing = false;
+	uint32_t Pphi = 0;
+
 	for(int i = 0; i < gint_driver_count(); i++)
 	{
-		gint_driver_t *d = &gint_drivers[i];
-		uint8_t *f = &gint_driver_flags[i];
+		uint8_t f = gint_driver_flags[i];
+		if(f & GINT_DRV_LAZY) continue;
 
-		bool foreign_powered = (!d->hpowered || d->hpowered());
-		if(foreign_powered)
-			*f |= GINT_DRV_FOREIGN_POWERED;
-		else
-			*f &= ~GINT_DRV_FOREIGN_POWERED;
+		uint32_t start = tracing ? tmu_trace_read() : 0;
+		switch_in_driver(i, world_os, world_addin);
 
-		/* Power the device if it was unpowered previously */
-		if(!foreign_powered && d->hpoweron) d->hpoweron();
-
-		/* For non-shared devices, save previous device state and
-		   consider restoring the preserved one */
-		if(!(*f & GINT_DRV_SHARED))
-		{
-			if(d->hsave)
-				d->hsave(world_os[i]);
-			if(!(*f & GINT_DRV_CLEAN) && d->hrestore)
-				d->hrestore(world_addin[i]);
+		if(tracing && (f & GINT_DRV_CLEAN)) {
+			uint64_t ticks = tmu_trace_read() - start;
+			gint_driver_boot_time[i] = (ticks * 4000000) / Pphi;
 		}
-
-		/* Bind the driver, configure if needed. Note that we either
-		   configure or restore the new world's state, not both */
-		if(d->bind) d->bind();
-
-		if(*f & GINT_DRV_CLEAN)
-		{
-			if(d->configure) d->configure();
-			*f &= ~GINT_DRV_CLEAN;
+		if(&gint_drivers[i] == &drv_tmu && (f & GINT_DRV_CLEAN)) {
+			Pphi = clock_freq()->Pphi_f;
+			tracing = tmu_trace_start();
 		}
 	}
 
+	if(tracing) tmu_trace_stop();
 	cpu_atomic_end();
 }
 
@@ -117,6 +146,7 @@ void gint_world_switch_out(gint_world_t world_addin, gint_world_t world_os)
 	for(int i = gint_driver_count() - 1; i >= 0; i--)
 	{
 		gint_driver_t *d = &gint_drivers[i];
+		if(gint_driver_flags[i] & GINT_DRV_LAZY) continue;
 		if(d->unbind) d->unbind();
 	}
 
@@ -126,6 +156,7 @@ void gint_world_switch_out(gint_world_t world_addin, gint_world_t world_os)
 	{
 		gint_driver_t *d = &gint_drivers[i];
 		uint8_t *f = &gint_driver_flags[i];
+		if(*f & GINT_DRV_LAZY) continue;
 
 		/* Power the device if it was unpowered previously */
 		if(d->hpowered && !d->hpowered() && d->hpoweron) d->hpoweron();
@@ -146,6 +177,32 @@ void gint_world_switch_out(gint_world_t world_addin, gint_world_t world_os)
 	cpu_atomic_end();
 }
 
+void gint_driver_activate(gint_driver_t *d)
+{
+	int i = d - gint_drivers;
+	if(!gint_driver_flags || !(gint_driver_flags[i] & GINT_DRV_LAZY))
+		return;
+
+	/* The device has been left to the OS until now */
+	if(d->funbind) d->funbind();
+
+	cpu_atomic_start();
+
+	/* Check again in case an interrupt activated the driver meanwhile */
+	if(gint_driver_flags[i] & GINT_DRV_LAZY) {
+		switch_in_driver(i, gint_world_os, gint_world_addin);
+		gint_driver_flags[i] &= ~GINT_DRV_LAZY;
+	}
+
+	cpu_atomic_end();
+}
+
+bool gint_driver_is_active(gint_driver_t const *d)
+{
+	int i = d - gint_drivers;
+	return gint_driver_flags && !(gint_driver_flags[i] & GINT_DRV_LAZY);
+}
+
 int gint_world_switch(gint_call_t call)
 {
 	extern void *gint_stack_top;
@@ -182,9 +239,12 @@ int gint_world_switch(gint_call_t call)
 		ptr += 8192;
 		memcpy(YRAM, ptr, 8192);
 		ptr += 8192;
+		gint_reset_onchip_arenas(false);
 	}
-	else if(!isSH3() && onchip_save_mode == GINT_ONCHIP_REINITIALIZE)
+	else if(!isSH3() && onchip_save_mode == GINT_ONCHIP_REINITIALIZE) {
 		gint_load_onchip_sections();
+		gint_reset_onchip_arenas(true);
+	}
 
 	/* The canary check needs to occur before switching in the gint world;
 	   otherwise we just crash due to the overflow. gint_panic() isn't
@@ -79,15 +79,15 @@ bool keydev_queue_push(keydev_t *d, key_event_t ev)
 	if(d->async_filter && !d->async_filter(ev))
 		return true;
 
-	int next = (d->queue_end + 1) % KEYBOARD_QUEUE_SIZE;
-	if(next == d->queue_next)
+	int slot = gint_ring_push_slot(&d->queue_ring, KEYBOARD_QUEUE_SIZE);
+	if(slot < 0)
 	{
 		d->events_lost++;
 		return false;
 	}
 
-	d->queue[d->queue_end] = ev;
-	d->queue_end = next;
+	d->queue[slot] = ev;
+	gint_ring_push_commit(&d->queue_ring);
 	return true;
 }
 
@@ -95,10 +95,11 @@ bool keydev_queue_push(keydev_t *d, key_event_t ev)
    Sets (*e) and returns true on success, otherwise false. */
 static bool queue_poll(keydev_t *d, key_event_t *ev)
 {
-	if(d->queue_next == d->queue_end) return false;
+	int slot = gint_ring_pop_slot(&d->queue_ring, KEYBOARD_QUEUE_SIZE);
+	if(slot < 0) return false;
 
-	*ev = d->queue[d->queue_next];
-	d->queue_next = (d->queue_next + 1) % KEYBOARD_QUEUE_SIZE;
+	*ev = d->queue[slot];
+	gint_ring_pop_commit(&d->queue_ring);
 	return true;
 }
 
@@ -8,6 +8,7 @@
 #include <gint/clock.h>
 #include <gint/keyboard.h>
 #include <gint/drivers/keydev.h>
+#include <gint/defer.h>
 
 #include <gint/defs/attributes.h>
 #include <gint/defs/types.h>
@@ -77,6 +78,8 @@ int keysc_tick(void)
 /* pollevent() - poll the next keyboard event */
 key_event_t pollevent(void)
 {
+	/* Event loops that never sleep still need to run deferred work */
+	gint_defer_run();
 	return keydev_unqueue_event(&keysc_dev);
 }
 
@@ -7,8 +7,6 @@
 #include <gint/defs/util.h>
 #include <gint/config.h>
 
-#include <string.h>
-
 /* block_t: A memory block managed by the heap.
 
    The heap is a sequence of blocks made of a block_t header (4 bytes) and raw
@@ -378,8 +376,11 @@ static void *gint_realloc(void *ptr, size_t size, void *data)
 		return NULL;
 	}
 
-	/* Move the data and free the original block */
-	memcpy(new_ptr, ptr, b->size);
+	/* Move the data and free the original block. Sizes are multiples of 4,
+	   and copying by longwords allows arenas in SPU memory */
+	uint32_t *dst = new_ptr, *src = ptr;
+	for(uint i = 0; i < b->size / 4; i++)
+		dst[i] = src[i];
 	gint_free(ptr, data);
 
 	if(s) s->relocating_reallocs++;
@@ -9,7 +9,7 @@
 #include <string.h>
 
 /* Maximum number of arenas */
-#define KMALLOC_ARENA_MAX 8
+#define KMALLOC_ARENA_MAX 12
 
 /* List of arenas in order of consideration */
 static kmalloc_arena_t *arenas[KMALLOC_ARENA_MAX] = { 0 };
@@ -116,7 +116,9 @@ void *krealloc(void *ptr, size_t size)
 		/* If reallocation within the original arena fails, try another
 		   one. The memory copy behavior is sub-optimal (we copy the
 		   new size which might be more than the original size) but
-		   it's all we can do with this arena interface. */
+		   it's all we can do with this arena interface. This is not
+		   possible for arenas with restricted access. */
+		if(a->flags & KMALLOC_WORD_ACCESS) return NULL;
 		rc = kmalloc(size, NULL);
 		if(rc)
 		{
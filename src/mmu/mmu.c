@@ -6,6 +6,7 @@
 #include <gint/drivers.h>
 #include <gint/drivers/states.h>
 #include <gint/hardware.h>
+#include <string.h>
 
 //---
 //	Unified interface
@@ -101,6 +102,27 @@ void tlb_mapped_memory(uint32_t *p_rom, uint32_t *p_ram)
 	gint[HWURAM] = ram;
 }
 
+/* Cache of PTEL values loaded by the OS for 4k ROM pages (0 when unknown),
+   and statistics. Both are accessed by the TLB miss handler in tlbh.S, with
+   the layout of the stats structure hardcoded there. Only SH3 uses them. */
+GBSS3 uint32_t tlb_cache[TLB_CACHE_SIZE];
+GBSS3 tlb_cache_stats_t tlb_cache_statistics;
+
+void tlb_cache_stats(tlb_cache_stats_t *stats)
+{
+	*stats = tlb_cache_statistics;
+}
+
+void tlb_cache_flush(void)
+{
+	memset(tlb_cache, 0, sizeof tlb_cache);
+}
+
+void tlb_cache_stats_reset(void)
+{
+	memset(&tlb_cache_statistics, 0, sizeof tlb_cache_statistics);
+}
+
 /* tlb_translate(): Get the physical address for a virtual page */
 uint32_t tlb_translate(uint32_t page, uint32_t *size)
 {
@@ -199,6 +221,24 @@ itlb_data_t const *itlb_data(uint E)
 	return (void *)addr;
 }
 
+/* constructor(): Start the TLB cache statistics at zero
+   They live in the uninitialized .gint.bss section, like the cache itself,
+   which is cleared by funbind() before the first switch to gint. */
+static void constructor(void)
+{
+#if GINT_HW_FX
+	if(isSH3()) tlb_cache_stats_reset();
+#endif
+}
+
+/* funbind(): Clear the TLB cache before gint takes control back */
+static void funbind(void)
+{
+#if GINT_HW_FX
+	if(isSH3()) tlb_cache_flush();
+#endif
+}
+
 static void configure(void)
 {
 	/* Make writes to the control register area synchronous; this is needed
@@ -226,6 +266,8 @@ static void hrestore(mmu_state_t const *s)
 
 gint_driver_t drv_mmu = {
 	.name         = "MMU",
+	.constructor  = constructor,
+	.funbind      = funbind,
 	.configure    = configure,
 	.hsave        = (void *)hsave,
 	.hrestore     = (void *)hrestore,
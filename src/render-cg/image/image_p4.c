@@ -3,6 +3,43 @@
 #include <gint/config.h>
 #if GINT_RENDER_RGB
 
+#include <string.h>
+
+/* Pair table for the last palette used with gint_image_p4_normal_pairs */
+static uint32_t pairs[256];
+/* Palette from which the table was built, and a copy of its contents */
+static uint16_t const *pairs_palette = NULL;
+static uint16_t pairs_colors[16];
+
+uint32_t const *gint_image_p4_pairs(uint16_t const *palette)
+{
+	if(palette == pairs_palette && !memcmp(palette, pairs_colors, 32))
+		return pairs;
+
+	for(int i = 0; i < 256; i++)
+		pairs[i] = ((uint32_t)palette[i >> 4] << 16) | palette[i & 15];
+
+	memcpy(pairs_colors, palette, 32);
+	pairs_palette = palette;
+	return pairs;
+}
+
+/* Whether to use the paired loop for this command. The pair table costs 256
+   iterations to build, so it is only worth it for large enough images unless
+   it is already up-to-date. */
+static bool use_pairs(struct gint_image_cmd const *cmd, image_t const *img)
+{
+	if((cmd->effect & 2) || cmd->edge_1 || cmd->columns < 2)
+		return false;
+	if((uint32_t)cmd->output & 3)
+		return false;
+
+	if(img->palette == pairs_palette
+		&& !memcmp(img->palette, pairs_colors, 32))
+		return true;
+	return cmd->columns * cmd->lines >= 1024;
+}
+
 void dimage_p4(int x, int y, image_t const *img, int eff)
 {
 	dsubimage_p4(x, y, img, 0, 0, img->width, img->height, eff);
@@ -20,7 +57,12 @@ void dsubimage_p4(int x, int y, image_t const *img,
 
 	if(!gint_image_mkcmd(&box, img, eff, false, false, &cmd, &dwindow))
 		return;
-	cmd.loop = gint_image_p4_normal;
+
+	if(use_pairs(&cmd, img)) {
+		cmd.palette = (void *)gint_image_p4_pairs(img->palette);
+		cmd.loop = gint_image_p4_normal_pairs;
+	}
+	else cmd.loop = gint_image_p4_normal;
 	gint_image_p4_loop(DWIDTH, &cmd);
 }
 
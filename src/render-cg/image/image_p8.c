@@ -20,7 +20,13 @@ void dsubimage_p8(int x, int y, image_t const *img,
 
 	if(!gint_image_mkcmd(&box, img, eff, false, false, &cmd, &dwindow))
 		return;
-	cmd.loop = gint_image_p8_normal;
+
+	/* Write pixels in pairs when the output is 4-aligned */
+	bool aligned = !((uint32_t)cmd.output & 3);
+	if(!(cmd.effect & 2) && cmd.columns >= 2 && aligned)
+		cmd.loop = gint_image_p8_normal_pairs;
+	else
+		cmd.loop = gint_image_p8_normal;
 	gint_image_p8_loop(DWIDTH, &cmd);
 }
 
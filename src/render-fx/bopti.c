@@ -156,6 +156,8 @@ void bopti_grid(void **layer, int rows, struct command *c)
 void bopti_render(bopti_image_t const *img, struct rbox *rbox, uint32_t *v1,
 	uint32_t *v2)
 {
+	dirty_rows(rbox->y, rbox->y + rbox->height - 1);
+
 	/* Rendering function */
 	bopti_asm_t f;
 	if(v2) f.asm_gray = asm_gray[img->profile];
@@ -218,6 +220,8 @@ void bopti_render(bopti_image_t const *img, struct rbox *rbox, uint32_t *v1,
 void bopti_render_scsp(bopti_image_t const *img, struct rbox *rbox,
 	uint32_t *v1, uint32_t *v2)
 {
+	dirty_rows(rbox->y, rbox->y + rbox->height - 1);
+
 	/* Compute the only rendering mask */
 	uint32_t mask =
 		(0xffffffff << (32 - rbox->width)) >> (rbox->visual_x & 31);
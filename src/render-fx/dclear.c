@@ -1,5 +1,6 @@
 #include <gint/display.h>
 #include "../render/render.h"
+#include "render-fx.h"
 
 #include <gint/config.h>
 #if GINT_RENDER_MONO
@@ -13,6 +14,7 @@ void dclear(color_t color)
 		return;
 	}
 
+	dirty_rows(dwindow.top, dwindow.bottom - 1);
 	DMODE_OVERRIDE(dclear, color);
 
 	/* SuperH only supports a single write-move addressing mode, which is
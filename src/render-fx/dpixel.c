@@ -1,6 +1,7 @@
 #include <gint/display.h>
 #include <gint/defs/types.h>
 #include "../render/render.h"
+#include "render-fx.h"
 
 #include <gint/config.h>
 #if GINT_RENDER_MONO
@@ -9,6 +10,7 @@ void dpixel(int x, int y, int color)
 {
 	if(x < dwindow.left || x >= dwindow.right) return;
 	if(y < dwindow.top || y >= dwindow.bottom) return;
+	dupdate_dirty[y] = 1;
 
 	DMODE_OVERRIDE(dpixel, x, y, color);
 
@@ -19,6 +19,7 @@ void drect(int x1, int y1, int x2, int y2, int color)
 	x2 = min(x2, dwindow.right - 1);
 	y1 = max(y1, dwindow.top);
 	y2 = min(y2, dwindow.bottom - 1);
+	dirty_rows(y1, y2);
 
 	DMODE_OVERRIDE(drect, x1, y1, x2, y2, color);
 
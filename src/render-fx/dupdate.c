@@ -1,5 +1,6 @@
 #include <gint/display.h>
 #include "../render/render.h"
+#include "render-fx.h"
 
 #include <gint/config.h>
 #if GINT_RENDER_MONO
@@ -12,6 +13,8 @@
 # error Platform unknown for mono video mode update
 #endif
 
+#include <string.h>
+
 /* Standard video RAM for fx9860g is 1 bit per pixel */
 GSECTION(".bss") GALIGNED(32) static uint32_t fx_vram[256];
 
@@ -45,10 +48,18 @@ void dupdate(void)
 	if(run_default)
 	{
 #if GINT_HW_FX
-		t6k11_display(gint_vram, 0, 64, 16);
+		/* Send the full VRAM if it has changed or the OS has drawn on
+		   the screen, otherwise only the modified rows */
+		static uint32_t const *last_vram = NULL;
+		if(gint_vram != last_vram || t6k11_contents_lost())
+			memset(dupdate_dirty, 1, DHEIGHT);
+		last_vram = gint_vram;
+
+		t6k11_display_rows(gint_vram, dupdate_dirty, 16);
 #elif GINT_HW_CG
 		r61524_display_mono_128x64(gint_vram);
 #endif
+		memset(dupdate_dirty, 0, DHEIGHT);
 	}
 
 	gint_call(dupdate_get_hook());
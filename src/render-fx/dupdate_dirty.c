@@ -0,0 +1,21 @@
+#include <gint/display.h>
+#include "render-fx.h"
+
+#include <gint/config.h>
+#if GINT_RENDER_MONO
+
+#include <string.h>
+
+/* Everything needs to be sent at the first dupdate() */
+uint8_t dupdate_dirty[DHEIGHT] = {
+	[0 ... DHEIGHT-1] = 1,
+};
+
+/* dupdate_invalidate(): Force rows to be sent at the next dupdate() */
+void dupdate_invalidate(int y1, int y2)
+{
+	if(y1 > y2) return;
+	dirty_rows(y1, y2);
+}
+
+#endif /* GINT_RENDER_MONO */
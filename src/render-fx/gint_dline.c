@@ -11,6 +11,7 @@ void gint_dhline(int x1, int x2, int y, int color)
 	if(y < dwindow.top || y >= dwindow.bottom) return;
 	if(x1 > x2) swap(x1, x2);
 	if(x1 >= dwindow.right || x2 < dwindow.left) return;
+	dupdate_dirty[y] = 1;
 
 	/* Get the masks for the [x1, x2] range */
 	uint32_t m[4];
@@ -49,6 +50,7 @@ void gint_dvline(int y1, int y2, int x, int color)
 	if(y1 >= dwindow.bottom || y2 < dwindow.top) return;
 	y1 = max(y1, dwindow.top);
 	y2 = min(y2, dwindow.bottom - 1);
+	dirty_rows(y1, y2);
 
 	uint32_t *base = gint_vram + (y1 << 2) + (x >> 5);
 	uint32_t *lword = base + ((y2 - y1 + 1) << 2);
@@ -54,6 +54,23 @@ void bopti_render(bopti_image_t const *img, struct rbox *rbox, uint32_t *v1,
 void bopti_render_scsp(bopti_image_t const *img, struct rbox *rbox,
     uint32_t *v1, uint32_t *v2);
 
+//---
+// Modified rows
+//---
+
+/* Rows drawn to since the last dupdate(), one byte per row (non-zero if the
+   row has been modified). This applies to gint_vram in monochrome mode, and to
+   the current VRAM pair when the gray engine is running. */
+extern uint8_t dupdate_dirty[DHEIGHT];
+
+/* dirty_rows(): Mark rows y1 to y2 (both included) as modified */
+GINLINE static void dirty_rows(int y1, int y2)
+{
+	if(y1 < 0) y1 = 0;
+	if(y2 >= DHEIGHT) y2 = DHEIGHT - 1;
+	for(int y = y1; y <= y2; y++) dupdate_dirty[y] = 1;
+}
+
 //---
 // Image rendering
 //---
@@ -112,6 +112,7 @@ void topti_render(int x, int y, char const *str_char, font_t const *f,
 		y = dwindow.top;
 	}
 	if(vdisp >= height) return;
+	dirty_rows(y, y + height - vdisp - 1);
 
 	uint32_t bg_mask[4];
 	masks(dwindow.left, dwindow.right, bg_mask);
@@ -6,12 +6,14 @@
 #include <gint/drivers.h>
 #include <gint/drivers/states.h>
 #include <gint/intc.h>
+#include <gint/cpu.h>
 
 #include <gint/defs/types.h>
 #include <gint/hardware.h>
 #include <gint/mpu/rtc.h>
 
 #include <stdarg.h>
+#include "rtc.h"
 
 /* RTC address on SH7305, adjusted at startup on SH7337 and SH7355 */
 static rtc_t *RTC = &SH7305_RTC;
@@ -84,49 +86,224 @@ void rtc_set_time(rtc_time_t const *time)
 }
 
 //---
-//	RTC periodic interrupt
+//	RTC periodic interrupt and alarms
 //---
 
+/* Interval of the periodic interrupt for each setting, in microseconds */
+static uint32_t const intervals[8] = {
+	0, 3906, 15625, 62500, 250000, 500000, 1000000, 2000000,
+};
+/* Same intervals in 128-Hz ticks, for settings slower than 256 Hz */
+static uint16_t const interval_ticks[8] = {
+	0, 0, 2, 8, 32, 64, 128, 256,
+};
+
+/* Callback and frequency of rtc_periodic_enable() */
 static gint_call_t rtc_periodic_callback;
+static int rtc_periodic_frequency = RTC_NONE;
+/* Value of rtc_ticks() when the callback was last called */
+static uint32_t rtc_periodic_last;
+
+typedef struct {
+	/* Next deadline, in rtc_clock_us() units */
+	uint64_t deadline;
+	/* Interval between calls, 0 for one-shot alarms */
+	uint32_t period;
+	gint_call_t callback;
+	bool active;
+
+} alarm_t;
+
+static alarm_t alarms[RTC_ALARM_COUNT];
+
+/* now(): Current time at the resolution of the RTC
+   The interrupt handler uses this rather than rtc_clock_us() so that it never
+   has to wait for the ETMU to be aligned. */
+static uint64_t now(void)
+{
+	rtc_time_t t;
+	rtc_get_time(&t);
+	return rtc_time_to_us(&t);
+}
 
-bool rtc_periodic_enable(int frequency, gint_call_t callback)
+/* schedule(): Program the interrupts for the next alarm and the periodic
+   callback. Must be called with interrupts disabled. */
+static void schedule(uint64_t time)
 {
-	/* Refuse to override an existing interrupt */
-	if(RTC->RCR2.PES != RTC_NONE) return false;
-	if(frequency == RTC_NONE)
+	uint64_t next = UINT64_MAX;
+	for(int i = 0; i < RTC_ALARM_COUNT; i++)
 	{
-		rtc_periodic_disable();
-		return true;
+		if(alarms[i].active && alarms[i].deadline < next)
+			next = alarms[i].deadline;
 	}
 
-	/* Temporarily disable the interrupt and set up the callback */
-	RTC->RCR2.PES = RTC_NONE;
-	rtc_periodic_callback = callback;
+	int pes = rtc_periodic_frequency;
+	bool use_alarm = false;
 
-	/* Clear the interrupt flag */
-	do RTC->RCR2.PEF = 0;
-	while(RTC->RCR2.PEF);
+	if(next != UINT64_MAX)
+	{
+		uint64_t remaining = (next > time) ? next - time : 0;
+
+		if(remaining > 3000000) use_alarm = true;
+		else
+		{
+			/* Slowest frequency that can't overshoot the deadline */
+			int f = RTC_256Hz;
+			while(f < RTC_500mHz && intervals[f+1] <= remaining) f++;
+			if(pes == RTC_NONE || f < pes) pes = f;
+		}
+	}
+
+	/* Wake up 2 seconds before the deadline, then finish with the periodic
+	   interrupt. The RTC only compares the time of day, so alarms further
+	   than a day away are rescheduled every day */
+	if(use_alarm)
+	{
+		uint32_t s = (uint32_t)(next / 1000000 - 2) % 86400;
+
+		RTC->RCR1.AIE = 0;
+		RTC->RSECAR = 0x80 | bcd8(s % 60);
+		RTC->RMINAR = 0x80 | bcd8(s / 60 % 60);
+		RTC->RHRAR  = 0x80 | bcd8(s / 3600);
+		RTC->RCR1.AF = 0;
+		RTC->RCR1.AIE = 1;
+	}
+	else RTC->RCR1.AIE = 0;
+
+	if(RTC->RCR2.PES == pes) return;
 
-	/* Enable the interrupt */
-	RTC->RCR2.PES = frequency;
+	/* Don't take a stale interrupt flag when starting the interrupt */
+	if(RTC->RCR2.PES == RTC_NONE)
+	{
+		do RTC->RCR2.PEF = 0;
+		while(RTC->RCR2.PEF);
+	}
+	RTC->RCR2.PES = pes;
+}
+
+/* periodic_due(): Whether the periodic callback must be called now
+   The periodic interrupt may run faster than requested to serve alarms, in
+   which case the callback is only called on multiples of its interval. */
+static bool periodic_due(int pes)
+{
+	int f = rtc_periodic_frequency;
+	if(f == RTC_NONE) return false;
+	if(pes == f) return true;
+
+	uint32_t ticks = rtc_ticks();
+	if(ticks == rtc_periodic_last || ticks % interval_ticks[f]) return false;
+
+	rtc_periodic_last = ticks;
 	return true;
 }
 
-void rtc_periodic_interrupt(void)
+static void rtc_interrupt(void)
 {
-	int rc = gint_call(rtc_periodic_callback);
+	int pes = RTC->RCR2.PES;
+	bool periodic = RTC->RCR2.PEF;
 
-	/* Clear the interrupt flag */
+	/* Clear the interrupt flags */
+	if(RTC->RCR1.AF) RTC->RCR1.AF = 0;
 	do RTC->RCR2.PEF = 0;
 	while(RTC->RCR2.PEF);
 
-	/* Stop the interrupt if the callback returns non-zero */
-	if(rc) rtc_periodic_disable();
+	/* Stop the periodic callback if it returns non-zero */
+	if(periodic && periodic_due(pes) && gint_call(rtc_periodic_callback))
+		rtc_periodic_frequency = RTC_NONE;
+
+	uint64_t time = now();
+	for(int i = 0; i < RTC_ALARM_COUNT; i++)
+	{
+		alarm_t *a = &alarms[i];
+		if(!a->active || a->deadline > time) continue;
+
+		/* Free one-shot alarms first so the callback can reuse them */
+		uint32_t period = a->period;
+		if(!period) a->active = false;
+
+		int rc = gint_call(a->callback);
+		if(!period || !a->active) continue;
+
+		if(rc != TIMER_CONTINUE)
+		{
+			a->active = false;
+			continue;
+		}
+
+		/* Skip the deadlines missed while interrupts were masked */
+		do a->deadline += period;
+		while(a->deadline <= time);
+	}
+
+	schedule(time);
+}
+
+bool rtc_periodic_enable(int frequency, gint_call_t callback)
+{
+	/* Refuse to override an existing callback */
+	if(rtc_periodic_frequency != RTC_NONE) return false;
+	if(frequency == RTC_NONE) return true;
+
+	cpu_atomic_start();
+	rtc_periodic_callback = callback;
+	rtc_periodic_frequency = frequency;
+	rtc_periodic_last = UINT32_MAX;
+	schedule(now());
+	cpu_atomic_end();
+
+	return true;
 }
 
 void rtc_periodic_disable(void)
 {
-	RTC->RCR2.PES = RTC_NONE;
+	cpu_atomic_start();
+	rtc_periodic_frequency = RTC_NONE;
+	schedule(now());
+	cpu_atomic_end();
+}
+
+int rtc_alarm_set(uint64_t time_us, uint32_t period_us, gint_call_t callback)
+{
+	int id = -1;
+	cpu_atomic_start();
+
+	for(int i = 0; i < RTC_ALARM_COUNT && id < 0; i++)
+	{
+		if(!alarms[i].active) id = i;
+	}
+	if(id >= 0)
+	{
+		alarm_t *a = &alarms[id];
+		a->deadline = time_us;
+		a->period = period_us;
+		a->callback = callback;
+		a->active = true;
+		schedule(now());
+	}
+
+	cpu_atomic_end();
+	return id;
+}
+
+int rtc_alarm_delay(uint32_t delay_us, uint32_t period_us,
+	gint_call_t callback)
+{
+	return rtc_alarm_set(rtc_clock_us() + delay_us, period_us, callback);
+}
+
+void rtc_alarm_cancel(int id)
+{
+	if(id < 0 || id >= RTC_ALARM_COUNT) return;
+
+	cpu_atomic_start();
+	alarms[id].active = false;
+	schedule(now());
+	cpu_atomic_end();
+}
+
+bool rtc_alarm_pending(int id)
+{
+	return id >= 0 && id < RTC_ALARM_COUNT && alarms[id].active;
 }
 
 /* Deprecated versions */
@@ -158,21 +335,38 @@ static void constructor(void)
 static void configure(void)
 {
 	/* Disable the carry and alarm interrupts (they share their IPR bits
-	   with the periodic interrupt, which we want to enable) */
+	   with the periodic interrupt, which we want to enable). The alarm
+	   interrupt is enabled when an alarm is far away */
 	RTC->RCR1.byte = 0;
 	/* Clear the periodic interrupt flag */
 	RTC->RCR2.PEF = 0;
 
-	/* Install the RTC interrupt handler */
-	intc_handler_function(0xaa0, GINT_CALL(rtc_periodic_interrupt));
+	/* Disable all alarm comparisons */
+	RTC->RSECAR = 0;
+	RTC->RMINAR = 0;
+	RTC->RHRAR  = 0;
+	RTC->RWKAR  = 0;
+	RTC->RDAYAR = 0;
+	RTC->RMONAR = 0;
+
+	/* Install the same handler for the alarm and periodic interrupts */
+	intc_handler_function(0xa80, GINT_CALL(rtc_interrupt));
+	intc_handler_function(0xaa0, GINT_CALL(rtc_interrupt));
 
 	/* Disable the RTC interrupts for now. Give them priority 1; higher
 	   priorities cause freezes when going back to the system on SH3
 	   (TODO: Find out about the RTC interrupt problem on SH3) */
 	RTC->RCR2.PES = RTC_NONE;
+	intc_priority(INTC_RTC_ATI, 1);
 	intc_priority(INTC_RTC_PRI, 1);
 }
 
+/* bind(): Realign the wall clock, as the ETMU stopped while the OS ran */
+static void bind(void)
+{
+	rtc_clock_synced = false;
+}
+
 //---
 // State and driver metadata
 //---
@@ -181,10 +375,22 @@ static void hsave(rtc_state_t *s)
 {
 	s->RCR1 = RTC->RCR1.byte;
 	s->RCR2 = RTC->RCR2.byte;
+	s->RSECAR = RTC->RSECAR;
+	s->RMINAR = RTC->RMINAR;
+	s->RHRAR  = RTC->RHRAR;
+	s->RWKAR  = RTC->RWKAR;
+	s->RDAYAR = RTC->RDAYAR;
+	s->RMONAR = RTC->RMONAR;
 }
 
 static void hrestore(rtc_state_t const *s)
 {
+	RTC->RSECAR = s->RSECAR;
+	RTC->RMINAR = s->RMINAR;
+	RTC->RHRAR  = s->RHRAR;
+	RTC->RWKAR  = s->RWKAR;
+	RTC->RDAYAR = s->RDAYAR;
+	RTC->RMONAR = s->RMONAR;
 	RTC->RCR1.byte = s->RCR1 & 0x18;
 	RTC->RCR2.byte = s->RCR2 & 0x7f;
 }
@@ -193,6 +399,7 @@ gint_driver_t drv_rtc = {
 	.name         = "RTC",
 	.constructor  = constructor,
 	.configure    = configure,
+	.bind         = bind,
 	.hsave        = (void *)hsave,
 	.hrestore     = (void *)hrestore,
 	.state_size   = sizeof(rtc_state_t),
@@ -0,0 +1,15 @@
+//---
+//	gint:rtc - Internal RTC definitions
+//---
+
+#ifndef GINT_RTC_RTC
+#define GINT_RTC_RTC
+
+#include <gint/defs/types.h>
+
+/* Whether the wall clock of rtc_clock.c is aligned with the RTC seconds. The
+   RTC driver clears it when switching in, since the ETMU stopped while the OS
+   ran. */
+extern bool rtc_clock_synced;
+
+#endif /* GINT_RTC_RTC */
@@ -0,0 +1,108 @@
+//---
+//	gint:rtc:rtc_clock - Wall clock with ETMU sub-second resolution
+//---
+
+#include <gint/rtc.h>
+#include <gint/cpu.h>
+#include "../tmu/tmu.h"
+#include "rtc.h"
+
+/* ETMU used to refine the clock, or -1 if there is none */
+static int clock_id = -1;
+/* Offset to add to the ETMU count to get the number of TCLK cycles elapsed in
+   the current RTC second (modulo 32768) */
+static uint32_t clock_phase;
+/* Whether clock_phase is valid. The RTC driver clears this when gint takes
+   control back, since the ETMU does not count while the OS runs. */
+bool rtc_clock_synced = false;
+
+/* days(): Number of days between 1970-01-01 and the specified date */
+static int32_t days(int year, int month, int day)
+{
+	/* Count years from March so that February 29th is the last day */
+	year -= (month <= 2);
+	int era = year / 400;
+	int yoe = year - era * 400;
+	int doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+	int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+	return era * 146097 + doe - 719468;
+}
+
+uint64_t rtc_time_to_us(rtc_time_t const *t)
+{
+	/* rtc_get_time() returns the month as stored in RMONCNT (1..12) */
+	int64_t s = days(t->year, t->month, t->month_day);
+	s = 24 * s + t->hours;
+	s = 60 * s + t->minutes;
+	s = 60 * s + t->seconds;
+
+	return s * 1000000 + ((uint32_t)t->ticks * 15625) / 2;
+}
+
+/* sync(): Align the ETMU with the RTC's sub-second counter */
+static void sync(void)
+{
+	rtc_time_t t;
+	rtc_get_time(&t);
+	int ticks = t.ticks;
+	uint32_t count;
+
+	/* Wait for R64CNT to change; at that instant, exactly 256 * t.ticks TCLK
+	   cycles of the current second have elapsed */
+	do {
+		cpu_atomic_start();
+		rtc_get_time(&t);
+		count = tmu_clock_read(clock_id);
+		cpu_atomic_end();
+	}
+	while(t.ticks == ticks);
+
+	clock_phase = 256 * t.ticks - count;
+	rtc_clock_synced = true;
+}
+
+bool rtc_clock_start(void)
+{
+	if(clock_id >= 0) return true;
+
+	clock_id = tmu_clock_start();
+	if(clock_id < 0) return false;
+
+	sync();
+	return true;
+}
+
+void rtc_clock_stop(void)
+{
+	if(clock_id < 0) return;
+	tmu_clock_stop(clock_id);
+	clock_id = -1;
+}
+
+uint64_t rtc_clock_us(void)
+{
+	if(clock_id >= 0 && !rtc_clock_synced) sync();
+
+	rtc_time_t t;
+	uint32_t count = 0;
+
+	cpu_atomic_start();
+	rtc_get_time(&t);
+	if(clock_id >= 0) count = tmu_clock_read(clock_id);
+	cpu_atomic_end();
+
+	if(clock_id < 0) return rtc_time_to_us(&t);
+
+	int coarse = 256 * t.ticks;
+	int fine = (count + clock_phase) & 0x7fff;
+	t.ticks = 0;
+	uint64_t us = rtc_time_to_us(&t);
+
+	/* The ETMU is read after the RTC, so it may already be in the next
+	   second; the opposite can happen by one cycle of alignment error */
+	if(fine + 16384 < coarse) us += 1000000;
+	else if(fine > coarse + 16384) us -= 1000000;
+
+	return us + (((uint64_t)fine * 1000000) >> 15);
+}
@@ -5,6 +5,8 @@
 #include <gint/drivers/states.h>
 #include <gint/clock.h>
 #include <gint/intc.h>
+#include <gint/kmalloc.h>
+#include "../kernel/kernel.h"
 
 #define SPU   SH7305_SPU
 #define DSP0  SH7305_DSP0
@@ -46,10 +48,26 @@ static void configure(void)
 	DSP0.DSPRST = 0;
 	DSP1.DSPRST = 0;
 	sleep_us_spin(1000);
+
+	/* Now that all of PRAM0 is mapped, provide it as an arena. Its contents
+	   are not preserved by world switches, so the kernel resets it. */
+	static kmalloc_arena_t pram0 = { 0 };
+	pram0.name = "_pram0";
+	pram0.flags = KMALLOC_WORD_ACCESS | KMALLOC_ONCHIP;
+	pram0.start = (void *)0xfe200000;
+	pram0.end = (void *)0xfe228000; /* 160 kB */
+	kmalloc_init_arena(&pram0, true);
+	kmalloc_add_arena(&pram0);
+	gint_add_onchip_arena(&pram0);
 }
 
+/* spu_zero(): Link in and activate the SPU driver
+   The SPU reset sequence takes a few milliseconds, so the driver is lazy and
+   only configured once this function is called. */
 int spu_zero(void)
 {
+	extern gint_driver_t drv_spu;
+	gint_driver_activate(&drv_spu);
 	return 0;
 }
 
@@ -79,5 +97,6 @@ gint_driver_t drv_spu = {
 	.hsave        = (void *)hsave,
 	.hrestore     = (void *)hrestore,
 	.state_size   = sizeof(spu_state_t),
+	.flags        = GINT_DRV_LAZY,
 };
 GINT_DECLARE_DRIVER(16, drv_spu);
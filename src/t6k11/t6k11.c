@@ -105,21 +105,39 @@ GINLINE static void write_row(const uint8_t *buf)
 //	Driver functions
 //---
 
+/* Whether the LCD contents might have been overwritten by the OS since the
+   last call to t6k11_contents_lost() */
+static bool contents_lost = true;
+
+/* display_row_v1() - send a single row of vram data to the LCD device */
+GINLINE static void display_row_v1(const void *vram, int y)
+{
+	/* Set the X-address register for this row */
+	command(reg_xaddr, y | 0xc0);
+	/* Use Y-Up mode */
+	command(reg_counter, cnt_yup);
+	/* Start counting Y from 0 */
+	command(reg_yaddr, 0);
+
+	/* Send the row's data to the device */
+	*sel = reg_data;
+	write_row(vram);
+}
+GINLINE static void display_row_v2(const void *vram, int y)
+{
+	command(8, y | 0x80);
+	command(8, 4);
+
+	*sel = 10;
+	write_row(vram);
+}
+
 /* t6k11_display() - send vram data to the LCD device */
 void t6k11_display_v1(const void *vram, int y1, int y2, size_t stride)
 {
 	for(int y = y1; y < y2; y++)
 	{
-		/* Set the X-address register for this row */
-		command(reg_xaddr, y | 0xc0);
-		/* Use Y-Up mode */
-		command(reg_counter, cnt_yup);
-		/* Start counting Y from 0 */
-		command(reg_yaddr, 0);
-
-		/* Send the row's data to the device */
-		*sel = reg_data;
-		write_row(vram);
+		display_row_v1(vram, y);
 		vram += stride;
 	}
 }
@@ -127,11 +145,7 @@ void t6k11_display_v2(const void *vram, int y1, int y2, size_t stride)
 {
 	for(int y = y1; y < y2; y++)
 	{
-		command(8, y | 0x80);
-		command(8, 4);
-
-		*sel = 10;
-		write_row(vram);
+		display_row_v2(vram, y);
 		vram += stride;
 	}
 }
@@ -141,6 +155,29 @@ void t6k11_display(const void *vram, int y1, int y2, size_t stride)
 	if(t6k11_version == 2) t6k11_display_v2(vram, y1, y2, stride);
 }
 
+/* t6k11_display_rows() - send selected rows of vram data to the LCD device */
+void t6k11_display_rows(const void *vram, uint8_t const *rows, size_t stride)
+{
+	if(t6k11_version == 1)
+	{
+		for(int y = 0; y < 64; y++, vram += stride)
+			if(rows[y]) display_row_v1(vram, y);
+	}
+	if(t6k11_version == 2)
+	{
+		for(int y = 0; y < 64; y++, vram += stride)
+			if(rows[y]) display_row_v2(vram, y);
+	}
+}
+
+/* t6k11_contents_lost() - check whether the LCD contents were overwritten */
+bool t6k11_contents_lost(void)
+{
+	bool lost = contents_lost;
+	contents_lost = false;
+	return lost;
+}
+
 /* t6k11_contrast() - change the contrast setting */
 void t6k11_contrast(int contrast)
 {
@@ -221,9 +258,16 @@ static void hrestore(t6k11_state_t const *s)
 	command(reg_counter, cnt);
 }
 
+static void bind(void)
+{
+	/* The OS may have drawn anything while it had control of the screen */
+	contents_lost = true;
+}
+
 gint_driver_t drv_t6k11 = {
 	.name         = "T6K11",
 	.constructor  = constructor,
+	.bind         = bind,
 	.hsave        = (void *)hsave,
 	.hrestore     = (void *)hrestore,
 	.state_size   = sizeof(t6k11_state_t),
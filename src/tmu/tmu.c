@@ -10,6 +10,8 @@
 #include <gint/cpu.h>
 #include <gint/mpu/tmu.h>
 #include <stdarg.h>
+#include "../cpu/cpu.h"
+#include "tmu.h"
 
 /* Callbacks for all timers */
 gint_call_t tmu_callbacks[9];
@@ -184,6 +186,8 @@ static void timer_control(int id, int state)
 /* timer_start() - start a configured timer */
 void timer_start(int id)
 {
+	/* The TMU stop in standby, unlike the ETMU */
+	if(id < 3) cpu_idle_cancel_standby();
 	timer_control(id, 0);
 }
 
@@ -260,6 +264,38 @@ void timer_spinwait(int id)
 	}
 }
 
+/* timer_next_deadline(): Time until the next timer interrupt */
+uint32_t timer_next_deadline(int spec)
+{
+	uint64_t next = UINT32_MAX;
+
+	for(int id = 0; id < timer_count(); id++)
+	{
+		if(spec == TIMER_TMU && id >= 3) continue;
+		if(spec == TIMER_ETMU && id < 3) continue;
+
+		uint64_t us;
+		if(id < 3)
+		{
+			tmu_t *T = &TMU[id];
+			if(!T->TCR.UNIE || !(*TSTR & (1 << id))) continue;
+
+			/* TPSC 0..3 divide Pphi by 4, 16, 64 and 256 */
+			uint64_t freq = clock_freq()->Pphi_f >> (2*T->TCR.TPSC+2);
+			us = ((uint64_t)T->TCNT * 1000000) / freq;
+		}
+		else
+		{
+			etmu_t *T = &ETMU[id-3];
+			if(!T->TCR.UNIE || !T->TSTR) continue;
+			us = ((uint64_t)T->TCNT * 1000000) >> 15;
+		}
+		if(us < next) next = us;
+	}
+
+	return next;
+}
+
 //---
 // Overclock adjustment
 //---
@@ -283,6 +319,90 @@ void timer_rescale(uint32_t old_Pphi, uint32_t new_Pphi_0)
 	}
 }
 
+//---
+// Driver boot trace
+//---
+
+/* tmu_trace_start(): Run TMU2 as a free-running counter at Pphi/4
+   This is used by the world switch to time driver initialization, and by the
+   interrupt instrumentation. Returns false if TMU2 is already in use. The
+   counter is reserved until tmu_trace_stop(). */
+bool tmu_trace_start(void)
+{
+	if(!available(2)) return false;
+
+	tmu_t *T = &TMU[2];
+	T->TCOR = 0xffffffff;
+	T->TCNT = 0xffffffff;
+	set(T->TCR.word, TIMER_Pphi_4);
+	*TSTR |= (1 << 2);
+	return true;
+}
+
+/* tmu_trace_counter(): Address of the counter, which counts down */
+uint32_t volatile *tmu_trace_counter(void)
+{
+	return &TMU[2].TCNT;
+}
+
+/* tmu_trace_read(): Number of Pphi/4 ticks since tmu_trace_start() */
+uint32_t tmu_trace_read(void)
+{
+	return 0xffffffff - TMU[2].TCNT;
+}
+
+/* tmu_trace_stop(): Stop the counter and leave TMU2 free */
+void tmu_trace_stop(void)
+{
+	*TSTR &= ~(1 << 2);
+	TMU[2].TCOR = 0xffffffff;
+	TMU[2].TCNT = 0xffffffff;
+}
+
+//---
+// Idle accounting clock
+//---
+
+/* Callback that keeps the clock running when it wraps around */
+static int clock_callback(void)
+{
+	return TIMER_CONTINUE;
+}
+
+/* tmu_clock_start(): Run an ETMU as a free-running counter at 32768 Hz
+   The ETMU are clocked by TCLK, which keeps running in standby modes where the
+   TMU are stopped, so the idle subsystem can use this clock to measure time
+   spent in all states. Returns the timer ID, or -1 if no ETMU is available.
+   The timer is reserved until tmu_clock_stop(). */
+int tmu_clock_start(void)
+{
+	for(int id = timer_count() - 1; id >= 3; id--)
+	{
+		if(!available(id)) continue;
+		conf(id, 0xffffffff, 0, GINT_CALL(clock_callback));
+		timer_start(id);
+		return id;
+	}
+	return -1;
+}
+
+/* tmu_clock_read(): Number of TCLK ticks since tmu_clock_start() */
+uint32_t tmu_clock_read(int id)
+{
+	etmu_t *T = &ETMU[id-3];
+	uint32_t TCNT;
+
+	/* TCNT is updated asynchronously, read until the value is stable */
+	do TCNT = T->TCNT; while(TCNT != T->TCNT);
+	return 0xffffffff - TCNT;
+}
+
+/* tmu_clock_stop(): Stop the counter and free the ETMU */
+void tmu_clock_stop(int id)
+{
+	timer_stop(id);
+}
+
 //---
 // Deprecated API
 //---
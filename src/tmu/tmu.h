@@ -0,0 +1,28 @@
+//---
+//	gint:tmu - Internal timer functions
+//---
+
+#ifndef GINT_TMU_TMU
+#define GINT_TMU_TMU
+
+#include <gint/defs/types.h>
+#include <gint/drivers.h>
+
+/* TMU driver, which the world switch identifies to time the other drivers */
+extern gint_driver_t drv_tmu;
+
+/* Boot trace and interrupt instrumentation: TMU2 as a free-running counter at
+   Pphi/4, counting down. tmu_trace_start() returns false if TMU2 is in use. */
+bool tmu_trace_start(void);
+uint32_t volatile *tmu_trace_counter(void);
+uint32_t tmu_trace_read(void);
+void tmu_trace_stop(void);
+
+/* Idle accounting and wall clock: an ETMU as a free-running counter at
+   32768 Hz, which keeps running in standby. tmu_clock_start() returns the
+   timer ID, or -1 if no ETMU is available. */
+int tmu_clock_start(void);
+uint32_t tmu_clock_read(int id);
+void tmu_clock_stop(int id);
+
+#endif /* GINT_TMU_TMU */
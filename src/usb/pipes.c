@@ -2,6 +2,7 @@
 #include <gint/mpu/usb.h>
 #include <gint/clock.h>
 #include <gint/dma.h>
+#include <gint/defer.h>
 #include <gint/defs/util.h>
 
 #include <string.h>
@@ -250,6 +251,9 @@ void usb_pipe_reset_fifos(void)
    Most functions can execute either in the main thread or within an interrupt
    handler. */
 GBSS static asyncio_op_t pipe_transfers[10];
+/* Whether the callback of each pipe's operation was supplied by the user, in
+   which case it is deferred; internal continuations run immediately */
+GBSS static bool pipe_defer_callback[10];
 
 void usb_pipe_init_transfers(void)
 {
@@ -296,10 +300,19 @@ static void finish_write_call(asyncio_op_t *t, int pipe)
 	if(pipe != 0)
 		USB.BEMPENB &= ~(1 << pipe);
 
+	/* Take user callbacks out of the op so that they run deferred instead
+	   of from within the BEMP or DMA interrupt */
+	gint_call_t cb = GINT_CALL_NULL;
+	if(pipe_defer_callback[pipe]) {
+		cb = t->callback;
+		t->callback = GINT_CALL_NULL;
+	}
+
 	if(t->type == ASYNCIO_WRITE)
 		asyncio_op_finish_write(t);
 	else if(t->type == ASYNCIO_SYNC)
 		asyncio_op_finish_sync(t);
+	gint_defer(cb);
 	USB_TRACE("finish_write_call()");
 }
 
@@ -358,7 +371,7 @@ static void write_round(asyncio_op_t *t, int pipe)
 		int channel = (ct == D0F) ? 3 : 4;
 
 		/* TODO: USB: Can we use 32-byte DMA transfers? */
-		bool ok = dma_transfer_async(channel, DMA_4B, size >> 2,
+		bool ok = dma_transfer_async_direct(channel, DMA_4B, size >> 2,
 			t->data_w, DMA_INC, (void *)FIFO, DMA_FIXED, callback);
 		if(!ok) USB_LOG("DMA async failed on channel %d!\n", channel);
 	}
@@ -372,8 +385,8 @@ static void write_round(asyncio_op_t *t, int pipe)
 	USB_TRACE("write_round()");
 }
 
-int usb_write_async(int pipe, void const *data, int size, bool use_dma,
-	gint_call_t callback)
+static int write_async(int pipe, void const *data, int size, bool use_dma,
+	gint_call_t callback, bool defer)
 {
 	asyncio_op_t *t = &pipe_transfers[pipe];
 	if(asyncio_op_busy(t))
@@ -390,6 +403,7 @@ int usb_write_async(int pipe, void const *data, int size, bool use_dma,
 	}
 
 	asyncio_op_start_write(t, data, size, use_dma, &callback);
+	pipe_defer_callback[pipe] = defer;
 
 	/* Set up the Buffer Empty interrupt to refill the buffer when it gets
 	   empty, and be notified when the transfer completes. */
@@ -399,6 +413,12 @@ int usb_write_async(int pipe, void const *data, int size, bool use_dma,
 	return 0;
 }
 
+int usb_write_async(int pipe, void const *data, int size, bool use_dma,
+	gint_call_t callback)
+{
+	return write_async(pipe, data, size, use_dma, callback, true);
+}
+
 int usb_write_sync_timeout(int pipe, void const *data, int size, bool use_dma,
 	timeout_t const *timeout)
 {
@@ -406,8 +426,8 @@ int usb_write_sync_timeout(int pipe, void const *data, int size, bool use_dma,
 
 	while(1)
 	{
-		int rc = usb_write_async(pipe, data, size, use_dma,
-			GINT_CALL_SET(&flag));
+		int rc = write_async(pipe, data, size, use_dma,
+			GINT_CALL_SET(&flag), false);
 		if(rc == 0)
 			break;
 		if(rc == USB_WRITE_NOFIFO)
@@ -433,7 +453,7 @@ int usb_write_sync(int pipe, void const *data, int size, bool dma)
 	return usb_write_sync_timeout(pipe, data, size, dma, NULL);
 }
 
-int usb_commit_async(int pipe, gint_call_t callback)
+static int commit_async(int pipe, gint_call_t callback, bool defer)
 {
 	asyncio_op_t *t = &pipe_transfers[pipe];
 	if(asyncio_op_busy(t))
@@ -455,6 +475,7 @@ int usb_commit_async(int pipe, gint_call_t callback)
 	/* Switch from WRITE to SYNC type; this influences the BEMP handler and
 	   the final finish_write_call() */
 	asyncio_op_start_sync(t, &callback);
+	pipe_defer_callback[pipe] = defer;
 
 	/* TODO: Figure out why previous attempts to use BEMP to finish commit
 	   TODO| calls on the DCP failed with a freeze */
@@ -474,6 +495,11 @@ int usb_commit_async(int pipe, gint_call_t callback)
 	return 0;
 }
 
+int usb_commit_async(int pipe, gint_call_t callback)
+{
+	return commit_async(pipe, callback, true);
+}
+
 int usb_commit_sync_timeout(int pipe, timeout_t const *timeout)
 {
 	int volatile flag = 0;
@@ -481,7 +507,7 @@ int usb_commit_sync_timeout(int pipe, timeout_t const *timeout)
 	/* Wait until the pipe is free, then commit */
 	while(1)
 	{
-		int rc = usb_commit_async(pipe, GINT_CALL_SET(&flag));
+		int rc = commit_async(pipe, GINT_CALL_SET(&flag), false);
 		if(rc == 0)
 			break;
 		if(rc != USB_BUSY)
@@ -611,7 +637,8 @@ static void finish_read_round(asyncio_op_t *t, int pipe)
 		USB.PIPECTR[pipe-1].PID = PID_BUF;
 	}
 	if(status & ASYNCIO_REQUEST_FINISHED) {
-		gint_call(cb);
+		if(pipe_defer_callback[pipe]) gint_defer(cb);
+		else gint_call(cb);
 	}
 }
 
@@ -710,6 +737,7 @@ static int read_once(int pipe, void *data, int size, int flags, int *rc_ptr,
 	bool IGNORE_ZEROS = (flags & USB_READ_IGNORE_ZEROS) != 0;
 
 	asyncio_op_start_read(t, data, size, USE_DMA, rc_ptr, AUTOCLOSE, cb);
+	pipe_defer_callback[pipe] = !(flags & USB_READ_WAIT);
 
 	/* Start the first round; others will follow from BRDY interrupts. When
 	   dealing with a 0-byte read due to an exhausted transaction, this
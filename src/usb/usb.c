@@ -8,6 +8,7 @@
 #include <gint/clock.h>
 #include <gint/intc.h>
 #include <gint/cpu.h>
+#include <gint/defer.h>
 #include "usb_private.h"
 
 #define USB SH7305_USB
@@ -134,6 +135,11 @@ int usb_open(usb_interface_t const **interfaces, gint_call_t callback)
 	if(usb_open_status)
 		return USB_OPEN_ALREADY_OPEN;
 
+	/* The driver is lazy, so that add-ins that never open the link don't
+	   pay for powering the module at every world switch */
+	extern gint_driver_t drv_usb;
+	gint_driver_activate(&drv_usb);
+
 	/* TODO: Check whether the calculator can host devices (probably no) */
 	bool host = false;
 
@@ -249,6 +255,15 @@ void usb_open_wait(void)
 
 void usb_close(void)
 {
+	/* If the driver was never activated, the module still belongs to the
+	   OS; leave its power and interrupt settings alone */
+	extern gint_driver_t drv_usb;
+	if(!gint_driver_is_active(&drv_usb)) {
+		usb_open_callback = GINT_CALL_NULL;
+		usb_open_status = false;
+		return;
+	}
+
 	usb_wait_all_transfers(false);
 	usb_pipe_init_transfers();
 
@@ -301,7 +316,7 @@ static void usb_interrupt_handler(gint_inth_callback_context_t* interrupt_contex
 			usb_configure();
 
 			usb_open_status = true;
-			gint_call(usb_open_callback);
+			gint_defer(usb_open_callback);
 			usb_open_callback = GINT_CALL_NULL;
 		}
 	}
@@ -449,5 +464,6 @@ gint_driver_t drv_usb = {
 	.hsave        = (void *)hsave,
 	.hrestore     = (void *)hrestore,
 	.state_size   = sizeof(usb_state_t),
+	.flags        = GINT_DRV_LAZY,
 };
 GINT_DECLARE_DRIVER(16, drv_usb);
@@ -0,0 +1,233 @@
+/*
+ * driver-order.c - Host test for the driver order of world switches
+ *
+ * Runs the world switch functions of src/kernel/world.c on a set of logging
+ * drivers, some of them lazy, and checks the order of their callbacks: all
+ * foreign unbinds happen before the first bind, drivers are switched in by
+ * increasing level and out by decreasing level, lazy drivers are skipped
+ * until gint_driver_activate() and then take part in switches, and configure
+ * only runs once. It also checks the boot time table of src/kernel/boottime.c.
+ * It is not part of the library; build it on the host with (the gint build
+ * directory provides the generated <gint/config.h>, and the linker provides
+ * the bounds of the driver array):
+ *
+ *   cc -O2 -I../build-cg/include -I../include -DFXCG50 \
+ *      -Dgint_drivers=__start_gint_drivers \
+ *      -Dgint_drivers_end=__stop_gint_drivers \
+ *      -o driver-order driver-order.c ../src/kernel/world.c \
+ *      ../src/kernel/boottime.c
+ *
+ * Usage: driver-order
+ */
+
+#include <gint/drivers.h>
+#include <gint/gint.h>
+#include <gint/clock.h>
+#include <gint/defs/call.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int errors;
+
+#define CHECK(cond, ...) do {                                       \
+    if(!(cond)) {                                                   \
+        printf("  FAIL: " __VA_ARGS__);                             \
+        printf("\n");                                               \
+        errors++;                                                   \
+    }                                                               \
+} while(0)
+
+/* ===== Event Log ===== */
+
+static char events[1024];
+
+static void event(char const *driver, char const *callback)
+{
+    size_t len = strlen(events);
+    snprintf(events + len, sizeof events - len, "%s%s.%s", len ? " " : "",
+        driver, callback);
+}
+
+/* Check the events since the last call, then clear the log */
+static void expect(char const *step, char const *expected)
+{
+    CHECK(!strcmp(events, expected), "%s:\n    got      \"%s\"\n"
+        "    expected \"%s\"", step, events, expected);
+    events[0] = 0;
+}
+
+/* ===== Logging Drivers ===== */
+
+#define LOGGING_DRIVER(X)                                           \
+    static void X##_funbind(void) { event(#X, "funbind"); }         \
+    static void X##_unbind(void) { event(#X, "unbind"); }           \
+    static void X##_bind(void) { event(#X, "bind"); }               \
+    static void X##_configure(void) { event(#X, "configure"); }     \
+    static void X##_hsave(void *s) { (void)s; event(#X, "hsave"); } \
+    static void X##_hrestore(void const *s)                         \
+        { (void)s; event(#X, "hrestore"); }
+
+#define DRIVER(X, f) {                                              \
+    .name = #X, .funbind = X##_funbind, .unbind = X##_unbind,       \
+    .bind = X##_bind, .configure = X##_configure,                   \
+    .hsave = X##_hsave, .hrestore = X##_hrestore,                   \
+    .state_size = 4, .flags = (f),                                  \
+}
+
+LOGGING_DRIVER(A)
+LOGGING_DRIVER(B)
+LOGGING_DRIVER(C)
+LOGGING_DRIVER(D)
+
+/* Drivers in order of increasing level, like the .gint.drivers.* sections */
+__attribute__((section("gint_drivers"), used))
+static gint_driver_t drivers[] = {
+    DRIVER(A, 0),
+    DRIVER(B, GINT_DRV_LAZY),
+    DRIVER(C, 0),
+    DRIVER(D, GINT_DRV_LAZY),
+};
+#define B (&drivers[1])
+#define D (&drivers[3])
+
+/* ===== Kernel Stubs ===== */
+
+/* The TMU is not one of the drivers, so the boot trace never starts */
+gint_driver_t drv_tmu;
+bool tmu_trace_start(void) { return false; }
+uint32_t tmu_trace_read(void) { return 0; }
+void tmu_trace_stop(void) {}
+
+gint_world_t gint_world_os, gint_world_addin;
+uint8_t *gint_driver_flags;
+int32_t *gint_driver_boot_time;
+void *gint_stack_top;
+uint16_t *gint_vram;
+
+void cpu_atomic_start(void) {}
+void cpu_atomic_end(void) {}
+const clock_frequency_t *clock_freq(void) { return NULL; }
+void gint_panic(uint32_t code) { printf("panic %08x\n", code); exit(2); }
+void gint_load_onchip_sections(void) {}
+void gint_reset_onchip_arenas(bool all) { (void)all; }
+void dgetvram(uint16_t **main, uint16_t **secondary)
+{
+    *main = *secondary = gint_vram;
+}
+void *__GetVRAMAddress(void) { return gint_vram; }
+void __PowerOff(int show_logo) { (void)show_logo; }
+
+bool usb_is_open(void) { return false; }
+void usb_fxlink_text(char const *text, int size) { (void)text; (void)size; }
+
+/* Same driver setup as kinit() */
+static void init(void)
+{
+    gint_world_os = gint_world_alloc();
+    gint_world_addin = gint_world_alloc();
+    gint_driver_flags = malloc(gint_driver_count());
+    gint_driver_boot_time = malloc(gint_driver_count() * sizeof(int32_t));
+
+    for(int i = 0; i < gint_driver_count(); i++) {
+        uint8_t *f = &gint_driver_flags[i];
+        *f = (gint_drivers[i].flags & GINT_DRV_INIT_) | GINT_DRV_CLEAN;
+        gint_driver_boot_time[i] = -1;
+    }
+}
+
+/* ===== Tests ===== */
+
+static void test_switches(void)
+{
+    /* Before kinit(), activation does nothing */
+    gint_driver_activate(B);
+    expect("activation before kinit()", "");
+    CHECK(!gint_driver_is_active(B), "B active before kinit()");
+
+    init();
+    CHECK(gint_driver_count() == 4, "%d drivers", (int)gint_driver_count());
+
+    gint_world_switch_in(gint_world_os, gint_world_addin);
+    expect("first switch in",
+        "C.funbind A.funbind "
+        "A.hsave A.bind A.configure C.hsave C.bind C.configure");
+    CHECK(!gint_driver_is_active(B), "B active before activation");
+    CHECK(!gint_driver_is_active(D), "D active before activation");
+
+    gint_driver_activate(B);
+    expect("activation of B", "B.funbind B.hsave B.bind B.configure");
+    CHECK(gint_driver_is_active(B), "B inactive after activation");
+
+    gint_driver_activate(B);
+    expect("second activation of B", "");
+
+    gint_world_sync();
+    expect("sync", "C.unbind B.unbind A.unbind");
+
+    gint_world_switch_out(gint_world_addin, gint_world_os);
+    expect("switch out",
+        "C.unbind B.unbind A.unbind "
+        "C.hsave C.hrestore B.hsave B.hrestore A.hsave A.hrestore");
+
+    gint_world_switch_in(gint_world_os, gint_world_addin);
+    expect("second switch in",
+        "C.funbind B.funbind A.funbind "
+        "A.hsave A.hrestore A.bind B.hsave B.hrestore B.bind "
+        "C.hsave C.hrestore C.bind");
+
+    gint_driver_activate(D);
+    expect("activation of D", "D.funbind D.hsave D.bind D.configure");
+
+    int rc = gint_world_switch(GINT_CALL(NULL));
+    expect("world switch",
+        "D.unbind C.unbind B.unbind A.unbind "
+        "D.hsave D.hrestore C.hsave C.hrestore B.hsave B.hrestore "
+        "A.hsave A.hrestore "
+        "D.funbind C.funbind B.funbind A.funbind "
+        "A.hsave A.hrestore A.bind B.hsave B.hrestore B.bind "
+        "C.hsave C.hrestore C.bind D.hsave D.hrestore D.bind");
+    CHECK(rc == -1, "world switch returned %d", rc);
+}
+
+static void test_boot_table(void)
+{
+    gint_driver_boot_time[0] = 1234;
+    gint_driver_boot_time[2] = 56;
+
+    int frac, ms = gint_driver_boot_time_ms(0, &frac);
+    CHECK(ms == 1 && frac == 234, "A: %d ms + %d us", ms, frac);
+    CHECK(gint_driver_boot_time_ms(1, NULL) == -1, "B was timed");
+    CHECK(gint_driver_boot_time_ms(4, NULL) == -1, "driver 4 exists");
+
+    char const *expected =
+        "Driver      Boot ms\n"
+        "A             1.234\n"
+        "B                 -\n"
+        "C             0.056\n"
+        "D                 -\n";
+    char buf[256], small[16];
+    int len = gint_driver_boot_table(buf, sizeof buf);
+    CHECK(!strcmp(buf, expected), "boot table:\n%s", buf);
+    CHECK(len == (int)strlen(expected), "boot table length %d", len);
+
+    /* Truncated output still returns the full length */
+    CHECK(gint_driver_boot_table(small, sizeof small) == len,
+        "truncated boot table length");
+    CHECK(strlen(small) == sizeof small - 1, "truncated boot table");
+}
+
+/* ===== Main ===== */
+
+int main(void)
+{
+    test_switches();
+    test_boot_table();
+
+    if(errors) {
+        printf("%d error(s)\n", errors);
+        return 1;
+    }
+    printf("Drivers are switched in the expected order\n");
+    return 0;
+}
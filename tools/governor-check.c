@@ -0,0 +1,145 @@
+/*
+ * governor-check.c - Host test for the clock governor's decision logic
+ *
+ * Feeds idle ratios to clock_governor_decide() from src/cpg/governor_decide.c
+ * and checks the level it chooses: busy windows move up at once (to the top
+ * with jump_up, otherwise one level), idle windows move down one level after
+ * down_delay consecutive windows, windows in-between restart the idle
+ * streak, and out-of-range levels are brought back into the policy. It is
+ * not part of the library; build it on the host with:
+ *
+ *   cc -O2 -I../build-cg/include -I../include -DFXCG50 \
+ *      -o governor-check governor-check.c ../src/cpg/governor_decide.c
+ *
+ * Usage: governor-check
+ */
+
+#include <gint/clock.h>
+#include <stdio.h>
+#include <string.h>
+
+static int errors;
+
+#define CHECK(cond, ...) do {                                       \
+    if(!(cond)) {                                                   \
+        printf("  FAIL: " __VA_ARGS__);                             \
+        printf("\n");                                               \
+        errors++;                                                   \
+    }                                                               \
+} while(0)
+
+/* ===== Helpers ===== */
+
+/* Three levels with the default thresholds */
+static clock_governor_policy_t policy(bool jump_up, int down_delay)
+{
+    clock_governor_policy_t p;
+    memset(&p, 0, sizeof p);
+    p.levels[0] = CLOCK_SPEED_F1;
+    p.levels[1] = CLOCK_SPEED_F3;
+    p.levels[2] = CLOCK_SPEED_F5;
+    p.level_count = 3;
+    p.jump_up = jump_up;
+    p.down_delay = down_delay;
+    p.up_threshold = 200;
+    p.down_threshold = 600;
+    p.sample_us = 2000;
+    p.window = 50;
+    return p;
+}
+
+/* Run a list of idle ratios, ending with -1, and compare the levels */
+static void run(char const *name, clock_governor_policy_t const *p,
+    int start, int const *idle, int const *expected)
+{
+    clock_governor_state_t s = { .level = start, .down_streak = 0 };
+
+    for(int i = 0; idle[i] >= 0; i++) {
+        int level = clock_governor_decide(p, &s, idle[i]);
+        CHECK(level == expected[i], "%s: window %d (idle %d) at level %d, "
+            "expected %d", name, i, idle[i], level, expected[i]);
+        CHECK(s.level == level, "%s: window %d: state at level %d, "
+            "returned %d", name, i, s.level, level);
+    }
+}
+
+/* ===== Tests ===== */
+
+static void test_up(void)
+{
+    clock_governor_policy_t jump = policy(true, 3);
+    clock_governor_policy_t step = policy(false, 3);
+
+    /* At or below the threshold is busy; just above is in-between */
+    run("jump up", &jump, 0,
+        (int[]){ 201, 200, -1 },
+        (int[]){ 0, 2 });
+    run("step up", &step, 0,
+        (int[]){ 0, 150, 0, 0, -1 },
+        (int[]){ 1, 2, 2, 2 });
+}
+
+static void test_down(void)
+{
+    clock_governor_policy_t p = policy(true, 3);
+
+    /* One level per down_delay idle windows, and no lower than level 0 */
+    run("down", &p, 2,
+        (int[]){ 600, 1000, 1000, 900, 700, 600, 1000, 1000, 1000, -1 },
+        (int[]){ 2, 2, 1, 1, 1, 0, 0, 0, 0 });
+
+    /* Busy and in-between windows restart the streak */
+    run("streak", &p, 2,
+        (int[]){ 1000, 1000, 599, 1000, 1000, 0, 1000, 1000, 1000, -1 },
+        (int[]){ 2, 2, 2, 2, 2, 2, 2, 2, 1 });
+
+    /* A delay of 1 or 0 moves down on every idle window */
+    clock_governor_policy_t fast = policy(true, 1);
+    run("delay 1", &fast, 2,
+        (int[]){ 1000, 1000, 1000, -1 },
+        (int[]){ 1, 0, 0 });
+    clock_governor_policy_t zero = policy(true, 0);
+    run("delay 0", &zero, 2,
+        (int[]){ 1000, 1000, -1 },
+        (int[]){ 1, 0 });
+}
+
+static void test_limits(void)
+{
+    clock_governor_policy_t p = policy(false, 3);
+
+    /* Levels outside of the policy are clamped before deciding */
+    run("below", &p, -1, (int[]){ 400, -1 }, (int[]){ 0 });
+    run("above", &p, 7, (int[]){ 400, -1 }, (int[]){ 2 });
+
+    /* A single level never moves */
+    clock_governor_policy_t one = policy(true, 1);
+    one.level_count = 1;
+    run("single", &one, 0,
+        (int[]){ 0, 1000, 1000, 0, -1 },
+        (int[]){ 0, 0, 0, 0 });
+
+    /* At the lowest level, the idle streak saturates instead of wrapping
+       around to 0 */
+    clock_governor_state_t s = { .level = 0, .down_streak = 0 };
+    for(int i = 0; i < 300; i++)
+        clock_governor_decide(&p, &s, 1000);
+    CHECK(s.level == 0 && s.down_streak == 255, "300 idle windows at level "
+        "0: level %d, streak %d", s.level, s.down_streak);
+}
+
+/* ===== Main ===== */
+
+int main(void)
+{
+    test_up();
+    test_down();
+    test_limits();
+
+    if(errors) {
+        printf("%d error(s)\n", errors);
+        return 1;
+    }
+    printf("The governor chooses the expected levels\n");
+    return 0;
+}
@@ -0,0 +1,338 @@
+/*
+ * image-pairs-check.c - Host test for the paired P8 and P4 image loops
+ *
+ * Runs dsubimage_p8() and dsubimage_p4() from src/render-cg/image on random
+ * palettes, images and sub-images, with models of the per-pixel loops and of
+ * the paired loops (image_p8_normal_pairs.S, image_p4_normal_pairs.S) in
+ * place of the assembler, and compares the VRAM with a pixel-by-pixel
+ * palette lookup. It checks that the paired loops are only selected when
+ * they apply (no HFLIP, 4-aligned output, even left side for P4), that the
+ * pixels around the destination are not touched, and that the P4 pair table
+ * of gint_image_p4_pairs() matches the palette, including when the palette
+ * contents change behind the same pointer. When the loops change, these
+ * models must be updated with them. It is not part of the library; build it
+ * on the host with (the gint build directory provides the generated
+ * <gint/config.h>):
+ *
+ *   cc -O2 -I../build-cg/include -I../include -DFXCG50 \
+ *      -o image-pairs-check image-pairs-check.c \
+ *      ../src/render-cg/image/image.c ../src/render-cg/image/image_p8.c \
+ *      ../src/render-cg/image/image_p4.c
+ *
+ * Usage: image-pairs-check [images]
+ */
+
+#include <gint/display.h>
+#include <gint/image.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GUARD 0xa5a5
+
+static int errors;
+
+#define CHECK(cond, ...) do {                                       \
+    if(!(cond)) {                                                   \
+        if(errors < 10) {                                           \
+            printf("  FAIL: " __VA_ARGS__);                         \
+            printf("\n");                                           \
+        }                                                           \
+        errors++;                                                   \
+    }                                                               \
+} while(0)
+
+/* ===== Renderer Stubs ===== */
+
+static uint16_t vram[DWIDTH * DHEIGHT] __attribute__((aligned(4)));
+uint16_t *gint_vram = vram;
+struct dwindow dwindow = { 0, 0, DWIDTH, DHEIGHT };
+
+int image_alpha(int format)
+{
+    (void)format;
+    return 0x0001;
+}
+
+/* Loop labels; only their addresses are used */
+void gint_image_p8_normal(void) {}
+void gint_image_p8_normal_pairs(void) {}
+void gint_image_p8_clearbg(void) {}
+void gint_image_p4_normal(void) {}
+void gint_image_p4_normal_pairs(void) {}
+void gint_image_p4_clearbg(void) {}
+
+/* Loop selected by the last call */
+static void const *last_loop;
+
+/* ===== Loop Models ===== */
+
+/* Registers set up by the entry points, see image_p8.S and image_p4.S */
+static int r1, r2, r4, r6;
+static uint8_t const *r3;
+static uint16_t *r5;
+static uint16_t const *r9;
+
+/* mov.l to the VRAM: big-endian, so the top half is the first pixel */
+static void write_l(uint16_t *p, uint32_t v)
+{
+    CHECK(!((uintptr_t)p & 3), "misaligned longword write at VRAM+%d",
+        (int)((uint8_t *)p - (uint8_t *)vram));
+    p[0] = v >> 16;
+    p[1] = v;
+}
+
+static void end(void)
+{
+    r3 += r4;
+    r5 += r6 / 2;
+}
+
+/* P8 pixels are signed bytes, and cmd.palette points 128 colors in */
+static uint16_t p8_color(uint8_t byte)
+{
+    return r9[(int8_t)byte];
+}
+
+static void p8_normal(bool hflip)
+{
+    for(; r1 > 0; r1--, end()) {
+        for(int i = 0; i < r2; i++) {
+            uint16_t c = p8_color(*r3++);
+            r5[hflip ? r2 - 1 - i : i] = c;
+        }
+        r5 += r2;
+    }
+}
+
+static void p8_normal_pairs(void)
+{
+    for(; r1 > 0; r1--, end()) {
+        for(int i = 0; i < r2 / 2; i++) {
+            uint32_t a = p8_color(*r3++);
+            uint32_t b = p8_color(*r3++);
+            write_l(r5, (a << 16) | b);
+            r5 += 2;
+        }
+        if(r2 & 1) *r5++ = p8_color(*r3++);
+    }
+}
+
+/* In the normal P4 loop, edge_1 selects the nibble of the first pixel; the
+   input pointer only moves by the stride */
+static void p4_normal(bool hflip, int edge_1)
+{
+    for(; r1 > 0; r1--, end()) {
+        for(int i = 0; i < r2; i++) {
+            int n = edge_1 + i;
+            int byte = r3[n >> 1];
+            int c = r9[(n & 1) ? (byte & 15) : (byte >> 4)];
+            r5[hflip ? r2 - 1 - i : i] = c;
+        }
+        r5 += r2;
+    }
+}
+
+static void p4_normal_pairs(void)
+{
+    uint32_t const *pairs = (void const *)r9;
+
+    for(; r1 > 0; r1--, end()) {
+        for(int i = 0; i < r2 / 2; i++) {
+            write_l(r5, pairs[*r3++]);
+            r5 += 2;
+        }
+        if(r2 & 1) *r5++ = pairs[*r3++] >> 16;
+    }
+}
+
+static void setup(int output_width, struct gint_image_cmd const *cmd)
+{
+    r1 = cmd->lines;
+    r2 = cmd->columns;
+    r3 = cmd->input;
+    r4 = (cmd->effect & 1) ? -cmd->input_stride : cmd->input_stride;
+    r5 = (void *)cmd->output;
+    r6 = 2 * (output_width - r2);
+    r9 = cmd->palette;
+    last_loop = cmd->loop;
+}
+
+void *gint_image_p8_loop(int output_width, struct gint_image_cmd *cmd)
+{
+    setup(output_width, cmd);
+    r4 -= r2;
+
+    if(cmd->loop == gint_image_p8_normal_pairs)
+        p8_normal_pairs();
+    else if(cmd->loop == gint_image_p8_normal)
+        p8_normal(cmd->effect & 2);
+    else
+        CHECK(false, "unexpected P8 loop");
+    return NULL;
+}
+
+void *gint_image_p4_loop(int output_width, struct gint_image_cmd *cmd)
+{
+    setup(output_width, cmd);
+
+    /* The paired loop reads (columns + 1) / 2 bytes per line, which the
+       entry point subtracts from the stride */
+    if(cmd->loop == gint_image_p4_normal_pairs) {
+        r4 -= (r2 + 1) >> 1;
+        p4_normal_pairs();
+    }
+    else if(cmd->loop == gint_image_p4_normal)
+        p4_normal(cmd->effect & 2, cmd->edge_1);
+    else
+        CHECK(false, "unexpected P4 loop");
+    return NULL;
+}
+
+/* ===== Reference ===== */
+
+static uint16_t palette[256];
+static uint8_t data[68 * 64];
+
+static void random_palette(void)
+{
+    for(int i = 0; i < 256; i++) palette[i] = rand();
+}
+
+/* Color of pixel (x,y) of the full image */
+static uint16_t ref_pixel(image_t const *img, int x, int y)
+{
+    uint8_t const *row = (uint8_t const *)img->data + y * img->stride;
+    if(img->format == IMAGE_P8_RGB565)
+        return img->palette[row[x] ^ 0x80];
+    int byte = row[x >> 1];
+    return img->palette[(x & 1) ? (byte & 15) : (byte >> 4)];
+}
+
+/* P4 palette whose pair table was last built, as in image_p4.c */
+static uint16_t const *built_palette;
+static uint16_t built_colors[16];
+
+/* Draw a random sub-image at a random position and check the VRAM */
+static void check_image(int format)
+{
+    bool p8 = (format == IMAGE_P8_RGB565);
+    int width = 1 + rand() % 64;
+    int height = 1 + rand() % 64;
+    int stride = (p8 ? width : (width + 1) >> 1) + rand() % 4;
+
+    for(int i = 0; i < stride * height; i++) data[i] = rand();
+    /* Sometimes change the P4 palette in place, sometimes a new one */
+    if(!p8 && rand() % 4 == 0) palette[rand() % 16] = rand();
+
+    image_t img = {
+        .format = format, .color_count = p8 ? 256 : 16,
+        .width = width, .height = height, .stride = stride,
+        .data = data, .palette = palette + ((!p8 && rand() % 2) ? 16 : 0),
+    };
+
+    int left = rand() % width, top = rand() % height;
+    int w = 1 + rand() % (width - left), h = 1 + rand() % (height - top);
+    int x = rand() % (DWIDTH - w), y = rand() % (DHEIGHT - h);
+    int eff = ((rand() & 1) ? IMAGE_HFLIP : 0)
+        | ((rand() & 1) ? IMAGE_VFLIP : 0);
+    bool hflip = eff & IMAGE_HFLIP, vflip = eff & IMAGE_VFLIP;
+
+    /* Expected loop, before the pair table is updated */
+    bool pairs = !hflip && w >= 2 && !(x & 1);
+    if(!p8) {
+        bool cached = img.palette == built_palette
+            && !memcmp(img.palette, built_colors, 32);
+        pairs = pairs && !(left & 1) && (cached || w * h >= 1024);
+    }
+
+    for(int i = 0; i < DWIDTH * DHEIGHT; i++) vram[i] = GUARD;
+    last_loop = NULL;
+
+    if(p8) dsubimage_p8(x, y, &img, left, top, w, h, eff);
+    else dsubimage_p4(x, y, &img, left, top, w, h, eff);
+
+    void const *expected = p8
+        ? (pairs ? gint_image_p8_normal_pairs : gint_image_p8_normal)
+        : (pairs ? gint_image_p4_normal_pairs : gint_image_p4_normal);
+    CHECK(last_loop == expected, "P%d %dx%d at (%d,%d) left %d h%d v%d: "
+        "%s loop", p8 ? 8 : 4, w, h, x, y, left, hflip, vflip,
+        pairs ? "per-pixel" : "paired");
+
+    if(!p8 && last_loop == gint_image_p4_normal_pairs) {
+        built_palette = img.palette;
+        memcpy(built_colors, img.palette, 32);
+    }
+
+    for(int dy = 0; dy < h; dy++)
+    for(int dx = 0; dx < w; dx++) {
+        int sx = left + (hflip ? w - 1 - dx : dx);
+        int sy = top + (vflip ? h - 1 - dy : dy);
+        uint16_t *p = &vram[(y + dy) * DWIDTH + x + dx];
+        uint16_t want = ref_pixel(&img, sx, sy);
+        CHECK(*p == want, "P%d %dx%d at (%d,%d) h%d v%d: (%d,%d) is %04x, "
+            "expected %04x", p8 ? 8 : 4, w, h, x, y, hflip, vflip, dx, dy,
+            *p, want);
+        *p = GUARD;
+    }
+    for(int i = 0; i < DWIDTH * DHEIGHT; i++)
+        CHECK(vram[i] == GUARD, "P%d %dx%d at (%d,%d): write outside at "
+            "(%d,%d)", p8 ? 8 : 4, w, h, x, y, i % DWIDTH, i / DWIDTH);
+}
+
+/* ===== Pair Table ===== */
+
+static void check_table(uint16_t const *pal, uint32_t const *table)
+{
+    for(int i = 0; i < 256; i++) {
+        uint32_t want = ((uint32_t)pal[i >> 4] << 16) | pal[i & 15];
+        CHECK(table[i] == want, "pairs[%02x] is %08x, expected %08x", i,
+            table[i], want);
+    }
+}
+
+static void test_pair_table(void)
+{
+    random_palette();
+    uint32_t const *table = gint_image_p4_pairs(palette);
+    check_table(palette, table);
+
+    /* Same pointer and contents: the table is reused */
+    CHECK(gint_image_p4_pairs(palette) == table, "table moved");
+    check_table(palette, table);
+
+    /* Same pointer, new contents: the table is rebuilt */
+    for(int i = 0; i < 16; i++) {
+        palette[i] ^= 0x1234;
+        check_table(palette, gint_image_p4_pairs(palette));
+    }
+
+    /* Another palette */
+    check_table(palette + 16, gint_image_p4_pairs(palette + 16));
+    check_table(palette, gint_image_p4_pairs(palette));
+
+    built_palette = palette;
+    memcpy(built_colors, palette, 32);
+}
+
+/* ===== Main ===== */
+
+int main(int argc, char **argv)
+{
+    long count = (argc > 1) ? atol(argv[1]) : 20000;
+    srand(1);
+
+    test_pair_table();
+    for(long i = 0; i < count; i++) {
+        if(i % 1000 == 0) random_palette();
+        check_image(IMAGE_P8_RGB565);
+        check_image(IMAGE_P4_RGB565);
+    }
+
+    if(errors) {
+        printf("%d error(s)\n", errors);
+        return 1;
+    }
+    printf("Paired loops match the palette lookup\n");
+    return 0;
+}
@@ -0,0 +1,301 @@
+/*
+ * image-rgb16-check.c - Host reference test for the RGB16 opaque image kernel
+ *
+ * Replays the instructions of src/render-cg/image/image_rgb16_normal.S on a
+ * model of the SH registers and of big-endian memory, for random image sizes,
+ * input and output alignments, strides and flips, and compares the output
+ * with a pixel-by-pixel reference copy. Every variant of the kernel (word
+ * copy, and longword copy for each width parity and output alignment, both
+ * forward and backward) is exercised. Pixels around the destination must not
+ * be touched.
+ *
+ * It also checks the PREF_ROW prefetch of image_macros.S: every cache line
+ * read in a row after the first must have been prefetched at the start of the
+ * previous row, and no prefetch may land more than 4 bytes before or 39 bytes
+ * after the input image. When the kernel changes, this model must be updated with
+ * it. It is not part of the library; build it on the host with:
+ *
+ *   cc -O2 -o image-rgb16-check image-rgb16-check.c
+ *
+ * Usage: image-rgb16-check [images]
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MEM_SIZE 0x40000
+#define IN_BASE  0x01000
+#define OUT_BASE 0x20000
+#define LINE 32
+
+static int errors;
+
+#define CHECK(cond, ...) do {                                       \
+    if(!(cond)) {                                                   \
+        if(errors < 10) {                                           \
+            printf("  FAIL: " __VA_ARGS__);                         \
+            printf("\n");                                           \
+        }                                                           \
+        errors++;                                                   \
+    }                                                               \
+} while(0)
+
+/* ===== Machine Model ===== */
+
+static uint8_t mem[MEM_SIZE];
+static uint32_t r0, r1, r2, r3, r4, r5, r6, r7;
+
+/* Row being drawn, and the set of rows that prefetched each cache line */
+static int row;
+static uint64_t prefetched_by[MEM_SIZE / LINE];
+/* Bounds of the input image, and of the prefetched addresses */
+static uint32_t in_lo, in_hi, pref_lo, pref_hi;
+static bool check_prefetch;
+
+static uint32_t read_w(uint32_t a)
+{
+    /* Rows after the first must have been prefetched by the previous one */
+    if(check_prefetch && row > 0)
+        CHECK(prefetched_by[a / LINE] >> (row - 1) & 1,
+            "row %d reads 0x%05x, not prefetched by row %d", row, a,
+            row - 1);
+    return (int16_t)((mem[a] << 8) | mem[a + 1]);
+}
+
+static void write_w(uint32_t a, uint32_t v)
+{
+    mem[a] = v >> 8;
+    mem[a + 1] = v;
+}
+
+static void write_l(uint32_t a, uint32_t v)
+{
+    CHECK(!(a & 3), "misaligned longword write at 0x%05x", a);
+    mem[a] = v >> 24;
+    mem[a + 1] = v >> 16;
+    mem[a + 2] = v >> 8;
+    mem[a + 3] = v;
+}
+
+static uint32_t xtrct(uint32_t rm, uint32_t rn)
+{
+    return (rm << 16) | (rn >> 16);
+}
+
+static void pref(uint32_t a)
+{
+    prefetched_by[a / LINE] |= (uint64_t)1 << row;
+    if(a < pref_lo) pref_lo = a;
+    if(a > pref_hi) pref_hi = a;
+}
+
+/* ===== Kernel Model ===== */
+
+/* PREF_ROW */
+static void pref_row(void)
+{
+    if(r1 == 1) return;
+    r7 = (r2 << 2) + r3 + r4;
+    r0 = (r2 << 2) + r7 + 39;
+    do {
+        pref(r7);
+        r7 += 32;
+    } while(r0 > r7);
+}
+
+/* END, as the loop condition of the outer loop */
+static bool end(void)
+{
+    r1--;
+    r3 += r4;
+    r5 += r6;
+    row++;
+    return r1 != 0;
+}
+
+/* Forward longword loop body: two input pixels to one longword */
+static void long_f(void)
+{
+    r0 = read_w(r3); r3 += 2;
+    r7 = read_w(r3); r3 += 2;
+    r7 <<= 16;
+    r7 = xtrct(r0, r7);
+    write_l(r5, r7);
+    r5 += 4;
+}
+
+/* Backward longword loop body */
+static void long_b(void)
+{
+    r0 = read_w(r3); r3 += 2;
+    r7 = read_w(r3); r3 += 2;
+    r0 <<= 16;
+    r0 = xtrct(r7, r0);
+    r5 -= 4;
+    write_l(r5, r0);
+}
+
+static void word_f(void)
+{
+    r0 = read_w(r3); r3 += 2;
+    write_w(r5, r0); r5 += 2;
+}
+
+static void word_b(void)
+{
+    r0 = read_w(r3); r3 += 2;
+    r5 -= 2; write_w(r5, r0);
+}
+
+/* The loop of START_PREF/END with an optional halfword before and after */
+static void rows(bool prefetch, void (*head)(void), void (*body)(void),
+    void (*tail)(void))
+{
+    do {
+        if(prefetch) pref_row();
+        if(head) head();
+        for(uint32_t i = 0; i < r2; i++) body();
+        if(tail) tail();
+    } while(end());
+}
+
+static void gint_image_rgb16_normal(void)
+{
+    bool hflip = r0 & 1;
+    bool small = (int32_t)r2 <= 8;
+
+    if(!hflip) {
+        if(small) return rows(false, NULL, word_f, NULL);
+
+        bool w1 = r2 & 1;
+        r2 >>= 1;
+        bool o2 = r5 & 2;
+        if(!w1 && !o2) return rows(true, NULL, long_f, NULL);
+        if(!w1 && o2) {
+            r2--;
+            return rows(true, word_f, long_f, word_f);
+        }
+        if(w1 && !o2) return rows(true, NULL, long_f, word_f);
+        return rows(true, word_f, long_f, NULL);
+    }
+
+    r0 = r2 * 2;
+    r5 += r0;
+    r0 += r0;
+    r6 += r0;
+    if(small) return rows(false, NULL, word_b, NULL);
+
+    bool w1 = r2 & 1;
+    r2 >>= 1;
+    bool o2 = r5 & 2;
+    if(!w1 && !o2) return rows(true, NULL, long_b, NULL);
+    if(!w1 && o2) {
+        r2--;
+        return rows(true, word_b, long_b, word_b);
+    }
+    if(w1 && !o2) return rows(true, NULL, long_b, word_b);
+    return rows(true, word_b, long_b, NULL);
+}
+
+/* ===== Reference ===== */
+
+static uint16_t in_pixel(uint32_t a)
+{
+    return (mem[a] << 8) | mem[a + 1];
+}
+
+/* Draw one image with random geometry and compare with the reference. The
+   output width must be even, like the VRAM's, so that all rows have the same
+   alignment. */
+static void check_image(int w, int h, int in_skip, int out_skip,
+    int out_width, bool hflip, bool vflip)
+{
+    int in_stride = 2 * (w + in_skip);
+    int in_size = in_stride * h;
+
+    /* Input rows, in memory order, and a guard pattern in the output */
+    for(int i = 0; i < in_size; i++)
+        mem[IN_BASE + i] = rand();
+    memset(mem + OUT_BASE, 0xa5, MEM_SIZE - OUT_BASE);
+    static uint8_t in_copy[MEM_SIZE];
+    memcpy(in_copy, mem, MEM_SIZE);
+
+    uint32_t first = IN_BASE + (vflip ? (h - 1) * in_stride : 0);
+    uint32_t out = OUT_BASE + 2 * out_skip;
+
+    /* Same register setup as _gint_image_rgb16_loop */
+    r0 = hflip;
+    r1 = h;
+    r2 = w;
+    r3 = first;
+    r4 = (vflip ? -(in_stride / 2) : in_stride / 2) - w;
+    r4 += r4;
+    r5 = out;
+    r6 = 2 * (out_width - w);
+
+    row = 0;
+    memset(prefetched_by, 0, sizeof prefetched_by);
+    in_lo = IN_BASE;
+    in_hi = IN_BASE + in_size - 1;
+    pref_lo = UINT32_MAX;
+    pref_hi = 0;
+    check_prefetch = (w > 8);
+
+    gint_image_rgb16_normal();
+
+    for(int y = 0; y < h; y++)
+    for(int x = 0; x < w; x++) {
+        int sy = vflip ? h - 1 - y : y;
+        int sx = hflip ? w - 1 - x : x;
+        uint16_t expected = in_pixel(IN_BASE + sy * in_stride + 2 * sx);
+        uint16_t got = in_pixel(out + 2 * (y * out_width + x));
+        CHECK(got == expected, "%dx%d h%d v%d: (%d,%d) is %04x, expected "
+            "%04x", w, h, hflip, vflip, x, y, got, expected);
+        /* Mark as checked for the guard test below */
+        write_w(out + 2 * (y * out_width + x), 0xa5a5);
+    }
+    for(int i = OUT_BASE; i < MEM_SIZE; i++)
+        CHECK(mem[i] == 0xa5, "%dx%d h%d v%d: write outside at 0x%05x", w,
+            h, hflip, vflip, i);
+    CHECK(!memcmp(mem, in_copy, OUT_BASE), "%dx%d: input modified", w, h);
+
+    if(pref_lo <= pref_hi) {
+        CHECK(pref_lo + 4 >= in_lo && pref_hi <= in_hi + 39, "%dx%d v%d: "
+            "prefetched 0x%05x..0x%05x for 0x%05x..0x%05x", w, h, vflip,
+            pref_lo, pref_hi, in_lo, in_hi);
+    }
+}
+
+/* ===== Main ===== */
+
+int main(int argc, char **argv)
+{
+    long count = (argc > 1) ? atol(argv[1]) : 20000;
+    srand(1);
+
+    /* All variants, with 1 and several rows */
+    for(int w = 1; w <= 24; w++)
+    for(int flips = 0; flips < 4; flips++)
+    for(int out_skip = 0; out_skip < 2; out_skip++) {
+        check_image(w, 1, 0, out_skip, 64, flips & 1, flips & 2);
+        check_image(w, 5, 3, out_skip, 66, flips & 1, flips & 2);
+    }
+
+    for(long i = 0; i < count; i++) {
+        int w = 1 + rand() % 200;
+        int h = 1 + rand() % 40;
+        int out_width = (w + 1 + rand() % 40) & ~1;
+        check_image(w, h, rand() % 20, rand() % 8, out_width, rand() & 1,
+            rand() & 1);
+    }
+
+    if(errors) {
+        printf("%d error(s)\n", errors);
+        return 1;
+    }
+    printf("All images match the reference\n");
+    return 0;
+}
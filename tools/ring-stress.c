@@ -0,0 +1,184 @@
+/*
+ * ring-stress.c - Host stress test for <gint/ring.h>
+ *
+ * Runs the SPSC functions with one producer and one consumer thread, then the
+ * MPSC functions with several producer threads serialized by
+ * gint_ring_trylock(), and checks that the consumer receives every item
+ * exactly once and in the order of each producer. The rings are small so the
+ * 16-bit indices wrap around many times. It is not part of the library; build
+ * it on the host with:
+ *
+ *   cc -O2 -pthread -I../include -o ring-stress ring-stress.c
+ *
+ * Usage: ring-stress [producers] [items per producer]
+ */
+
+#include <gint/ring.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CAPACITY 16
+#define MAX_PRODUCERS 64
+
+static int producers = 4;
+static long items = 1000000;
+static int errors;
+
+#define CHECK(cond, ...) do {                                       \
+    if(!(cond)) {                                                   \
+        printf("  FAIL: " __VA_ARGS__);                             \
+        printf("\n");                                               \
+        errors++;                                                   \
+    }                                                               \
+} while(0)
+
+/* ===== Single Producer, Single Consumer ===== */
+
+static gint_ring_t sp_ring = GINT_RING_INIT;
+static uint32_t sp_elements[CAPACITY];
+
+static void *sp_producer(void *arg)
+{
+    (void)arg;
+    for(long i = 0; i < items; i++) {
+        int s;
+        while((s = gint_ring_push_slot(&sp_ring, CAPACITY)) < 0)
+            sched_yield();
+        sp_elements[s] = i;
+        gint_ring_push_commit(&sp_ring);
+    }
+    return NULL;
+}
+
+static void test_spsc(void)
+{
+    printf("SPSC: 1 producer, %ld items\n", items);
+
+    pthread_t t;
+    pthread_create(&t, NULL, sp_producer, NULL);
+
+    long expected = 0;
+    while(expected < items) {
+        int s = gint_ring_pop_slot(&sp_ring, CAPACITY);
+        if(s < 0) {
+            sched_yield();
+            continue;
+        }
+        uint32_t x = sp_elements[s];
+        gint_ring_pop_commit(&sp_ring);
+
+        if(x != (uint32_t)expected) {
+            CHECK(0, "got %u, expected %ld", x, expected);
+            break;
+        }
+        expected++;
+    }
+
+    pthread_join(t, NULL);
+    CHECK(gint_ring_empty(&sp_ring), "%d items left over",
+        gint_ring_count(&sp_ring));
+}
+
+/* ===== Multiple Producers, Single Consumer ===== */
+
+static gint_ring_t mp_ring = GINT_RING_INIT;
+static uint32_t mp_elements[CAPACITY];
+static uint8_t volatile mp_ready[CAPACITY];
+static uint8_t volatile mp_lock;
+
+/* Items are tagged with their producer in the top 8 bits */
+static void *mp_producer(void *arg)
+{
+    uint32_t id = (uintptr_t)arg;
+    for(long i = 0; i < items; i++) {
+        int s = -1;
+        while(s < 0) {
+            if(gint_ring_trylock(&mp_lock)) {
+                s = gint_ring_mp_reserve(&mp_ring, CAPACITY);
+                gint_ring_unlock(&mp_lock);
+            }
+            if(s < 0) sched_yield();
+        }
+        mp_elements[s] = (id << 24) | i;
+        gint_ring_mp_publish(mp_ready, s);
+    }
+    return NULL;
+}
+
+static void test_mpsc(void)
+{
+    printf("MPSC: %d producers, %ld items each\n", producers, items);
+
+    pthread_t t[MAX_PRODUCERS];
+    long next[MAX_PRODUCERS] = { 0 };
+    for(int i = 0; i < producers; i++)
+        pthread_create(&t[i], NULL, mp_producer, (void *)(uintptr_t)i);
+
+    long total = 0;
+    while(total < producers * items && !errors) {
+        int s = gint_ring_mp_pop_slot(&mp_ring, mp_ready, CAPACITY);
+        if(s < 0) {
+            sched_yield();
+            continue;
+        }
+        uint32_t x = mp_elements[s];
+        gint_ring_mp_pop_commit(&mp_ring, mp_ready, CAPACITY);
+
+        /* Each producer reserves its slots in order, so its items must come
+           out consecutively; a gap is a lost item, a repeat a duplicate */
+        uint32_t id = x >> 24, i = x & 0xffffff;
+        if((int)id >= producers)
+            CHECK(0, "got item %08x from unknown producer", x);
+        else if(i != (uint32_t)next[id])
+            CHECK(0, "producer %u: got item %u, expected %ld", id, i,
+                next[id]);
+        else
+            next[id]++;
+        total++;
+    }
+
+    /* On error, let the producers finish so they can be joined */
+    while(errors && total < producers * items) {
+        int s = gint_ring_mp_pop_slot(&mp_ring, mp_ready, CAPACITY);
+        if(s < 0) {
+            sched_yield();
+            continue;
+        }
+        gint_ring_mp_pop_commit(&mp_ring, mp_ready, CAPACITY);
+        total++;
+    }
+
+    for(int i = 0; i < producers; i++)
+        pthread_join(t[i], NULL);
+    CHECK(gint_ring_empty(&mp_ring), "%d items left over",
+        gint_ring_count(&mp_ring));
+    for(int i = 0; i < CAPACITY; i++)
+        CHECK(!mp_ready[i], "slot %d still marked ready", i);
+}
+
+/* ===== Main ===== */
+
+int main(int argc, char **argv)
+{
+    if(argc > 1) producers = atoi(argv[1]);
+    if(argc > 2) items = atol(argv[2]);
+    if(producers < 1 || producers > MAX_PRODUCERS || items < 1
+        || items > 0xffffff) {
+        fprintf(stderr, "usage: %s [producers (1-%d)] [items (< 2^24)]\n",
+            argv[0], MAX_PRODUCERS);
+        return 2;
+    }
+
+    test_spsc();
+    if(!errors) test_mpsc();
+
+    if(errors) {
+        printf("%d error(s)\n", errors);
+        return 1;
+    }
+    printf("All items received exactly once\n");
+    return 0;
+}